@@ -13,7 +13,7 @@
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
-#include "brave/components/brave_shields/browser/ad_block_service_helper.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "chrome/browser/content_settings/host_content_settings_map_factory.h"
 #include "chrome/browser/profiles/profile.h"
@@ -36,30 +36,30 @@ std::unique_ptr<base::ListValue> GetUrlCosmeticResourcesOnTaskRunner(
     const std::string& url) {
   auto result_list = std::make_unique<base::ListValue>();
 
-  base::Optional<base::Value> resources = g_brave_browser_process->
-      ad_block_service()->UrlCosmeticResources(url);
+  base::Optional<::brave_shields::CosmeticResources> resources =
+      g_brave_browser_process->ad_block_service()->UrlCosmeticResources(url);
 
-  if (!resources || !resources->is_dict()) {
+  if (!resources) {
     return result_list;
   }
 
-  base::Optional<base::Value> regional_resources = g_brave_browser_process->
-      ad_block_regional_service_manager()->UrlCosmeticResources(url);
+  base::Optional<::brave_shields::CosmeticResources> regional_resources =
+      g_brave_browser_process->ad_block_regional_service_manager()->
+          UrlCosmeticResources(url);
 
-  if (regional_resources && regional_resources->is_dict()) {
-    ::brave_shields::MergeResourcesInto(
-        std::move(*regional_resources), &*resources, /*force_hide=*/false);
+  if (regional_resources) {
+    resources->MergeFrom(std::move(*regional_resources), /*force_hide=*/false);
   }
 
-  base::Optional<base::Value> custom_resources = g_brave_browser_process->
-      ad_block_custom_filters_service()->UrlCosmeticResources(url);
+  base::Optional<::brave_shields::CosmeticResources> custom_resources =
+      g_brave_browser_process->ad_block_custom_filters_service()->
+          UrlCosmeticResources(url);
 
-  if (custom_resources && custom_resources->is_dict()) {
-    ::brave_shields::MergeResourcesInto(
-        std::move(*custom_resources), &*resources, /*force_hide=*/true);
+  if (custom_resources) {
+    resources->MergeFrom(std::move(*custom_resources), /*force_hide=*/true);
   }
 
-  result_list->Append(std::move(*resources));
+  result_list->Append(std::move(*resources).ToValue());
 
   return result_list;
 }
@@ -26,6 +26,7 @@
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/https_everywhere_service.h"
+#include "brave/components/brave_shields/browser/query_filter_service.h"
 #include "brave/components/brave_shields/browser/tracking_protection_service.h"
 #include "brave/components/brave_sync/buildflags/buildflags.h"
 #include "brave/components/brave_sync/network_time_helper.h"
@@ -196,6 +197,7 @@ void BraveBrowserProcessImpl::StartBraveServices() {
   extension_whitelist_service();
 #endif
   tracking_protection_service();
+  query_filter_service();
 #if BUILDFLAG(ENABLE_GREASELION)
   greaselion_download_service();
 #endif
@@ -289,6 +291,15 @@ BraveBrowserProcessImpl::https_everywhere_service() {
   return https_everywhere_service_.get();
 }
 
+brave_shields::QueryFilterService*
+BraveBrowserProcessImpl::query_filter_service() {
+  if (!query_filter_service_) {
+    query_filter_service_ =
+        brave_shields::QueryFilterServiceFactory(local_data_files_service());
+  }
+  return query_filter_service_.get();
+}
+
 brave_component_updater::LocalDataFilesService*
 BraveBrowserProcessImpl::local_data_files_service() {
   if (!local_data_files_service_)
@@ -5,7 +5,13 @@
 
 #include "base/base64.h"
 #include "base/path_service.h"
+#include "base/pending_task.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/task/current_thread.h"
 #include "base/task/post_task.h"
+#include "base/task/task_observer.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/thread_test_helper.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/common/brave_paths.h"
@@ -15,6 +21,7 @@
 #include "brave/components/brave_shields/browser/ad_block_regional_service.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
+#include "brave/components/brave_shields/browser/blocked_events_buffer.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/tracking_protection_service.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
@@ -34,6 +41,7 @@
 #include "net/dns/mock_host_resolver.h"
 
 using brave_shields::features::kBraveAdblockCosmeticFiltering;
+using brave_shields::features::kBraveRequestsOffUIThread;
 using content::BrowserThread;
 using extensions::ExtensionBrowserTest;
 
@@ -81,6 +89,9 @@ class AdBlockServiceTest : public ExtensionBrowserTest {
   void SetUpOnMainThread() override {
     ExtensionBrowserTest::SetUpOnMainThread();
     host_resolver()->AddRule("*", "127.0.0.1");
+    // Count blocked resources as soon as they are reported.
+    brave_shields::BlockedEventsBuffer::GetInstance()->SetFlushDelayForTesting(
+        base::TimeDelta());
   }
 
   void SetUp() override {
@@ -282,6 +293,39 @@ IN_PROC_BROWSER_TEST_F(AdBlockServiceTest, AdsGetBlockedByDefaultBlocker) {
   EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 1ULL);
 }
 
+// Blocked resources are buffered and counted together when the buffer is
+// flushed, and a single UI task is posted for the whole batch.
+IN_PROC_BROWSER_TEST_F(AdBlockServiceTest, BlockedEventsAreBatched) {
+  brave_shields::BlockedEventsBuffer* buffer =
+      brave_shields::BlockedEventsBuffer::GetInstance();
+  buffer->SetFlushDelayForTesting(base::TimeDelta::FromHours(1));
+  ASSERT_TRUE(g_brave_browser_process->ad_block_custom_filters_service()
+                  ->UpdateCustomFilters("*ad_banner.png"));
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 0ULL);
+
+  GURL url = embedded_test_server()->GetURL(kAdBlockTestPage);
+  ui_test_utils::NavigateToURL(browser(), url);
+  content::WebContents* contents =
+      browser()->tab_strip_model()->GetActiveWebContents();
+
+  const size_t flush_task_count = buffer->GetFlushTaskCountForTesting();
+  bool as_expected = false;
+  ASSERT_TRUE(ExecuteScriptAndExtractBool(contents,
+                                          "setExpectations(0, 5, 0, 0, 0, 0);"
+                                          "addImage('ad_banner.png?1');"
+                                          "addImage('ad_banner.png?2');"
+                                          "addImage('ad_banner.png?3');"
+                                          "addImage('ad_banner.png?4');"
+                                          "addImage('ad_banner.png?5')",
+                                          &as_expected));
+  EXPECT_TRUE(as_expected);
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 0ULL);
+  EXPECT_LE(buffer->GetFlushTaskCountForTesting() - flush_task_count, 1u);
+
+  buffer->Flush();
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 5ULL);
+}
+
 // Load a page with an image which is not an ad, and make sure it is NOT
 // blocked by custom filters.
 IN_PROC_BROWSER_TEST_F(AdBlockServiceTest,
@@ -1176,3 +1220,79 @@ IN_PROC_BROWSER_TEST_F(AdBlockServiceTest,
               &as_expected));
   EXPECT_TRUE(as_expected);
 }
+
+// Counts the UI thread tasks posted from the Shields request handling code.
+class ShieldsUITaskCounter : public base::TaskObserver {
+ public:
+  ShieldsUITaskCounter() { base::CurrentThread::Get()->AddTaskObserver(this); }
+  ~ShieldsUITaskCounter() override {
+    base::CurrentThread::Get()->RemoveTaskObserver(this);
+  }
+
+  size_t count() const { return count_; }
+
+  // base::TaskObserver:
+  void WillProcessTask(const base::PendingTask& pending_task,
+                       bool was_blocked_or_low_priority) override {
+    const base::StringPiece file_name = pending_task.posted_from.file_name();
+    if (file_name.find("brave/browser/net/") != base::StringPiece::npos ||
+        file_name.find("brave/components/brave_shields/") !=
+            base::StringPiece::npos) {
+      count_++;
+    }
+  }
+  void DidProcessTask(const base::PendingTask& pending_task) override {}
+
+ private:
+  size_t count_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ShieldsUITaskCounter);
+};
+
+class AdBlockServiceOffUIThreadTest : public AdBlockServiceTest {
+ public:
+  AdBlockServiceOffUIThreadTest() {
+    feature_list_.InitAndEnableFeature(kBraveRequestsOffUIThread);
+  }
+
+ private:
+  base::test::ScopedFeatureList feature_list_;
+};
+
+// Requests handled off the UI thread are blocked and counted just the same,
+// without a UI thread task per subresource.
+IN_PROC_BROWSER_TEST_F(AdBlockServiceOffUIThreadTest,
+                       AdsGetBlockedByCustomBlocker) {
+  brave_shields::BlockedEventsBuffer* buffer =
+      brave_shields::BlockedEventsBuffer::GetInstance();
+  buffer->SetFlushDelayForTesting(base::TimeDelta::FromHours(1));
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 0ULL);
+  ASSERT_TRUE(g_brave_browser_process->ad_block_custom_filters_service()
+                  ->UpdateCustomFilters("*ad_banner.png"));
+
+  GURL url = embedded_test_server()->GetURL(kAdBlockTestPage);
+  ui_test_utils::NavigateToURL(browser(), url);
+  content::WebContents* contents =
+      browser()->tab_strip_model()->GetActiveWebContents();
+
+  constexpr int kBlockedImages = 10;
+  std::string script = "setExpectations(1, " +
+                       base::NumberToString(kBlockedImages) +
+                       ", 0, 0, 0, 0);"
+                       "addImage('logo.png');";
+  for (int i = 0; i < kBlockedImages; ++i) {
+    script += "addImage('ad_banner.png?" + base::NumberToString(i) + "');";
+  }
+
+  ShieldsUITaskCounter ui_task_counter;
+  bool as_expected = false;
+  ASSERT_TRUE(ExecuteScriptAndExtractBool(contents, script, &as_expected));
+  EXPECT_TRUE(as_expected);
+  // At most one task to flush the blocked events and one to start the
+  // background CNAME resolve for the page's host.
+  EXPECT_LE(ui_task_counter.count(), 2u);
+
+  buffer->Flush();
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked),
+            static_cast<uint64_t>(kBlockedImages));
+}
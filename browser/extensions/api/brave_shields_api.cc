@@ -13,10 +13,10 @@
 #include "brave/browser/webcompat_reporter/webcompat_reporter_dialog.h"
 #include "brave/common/extensions/api/brave_shields.h"
 #include "brave/components/brave_shields/browser/ad_block_base_service.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
-#include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "brave/components/brave_shields/browser/brave_shields_p3a.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
@@ -66,31 +66,31 @@ BraveShieldsUrlCosmeticResourcesFunction::Run() {
 
 std::unique_ptr<base::ListValue> BraveShieldsUrlCosmeticResourcesFunction::
     GetUrlCosmeticResourcesOnTaskRunner(const std::string& url) {
-  base::Optional<base::Value> resources = g_brave_browser_process->
-      ad_block_service()->UrlCosmeticResources(url);
+  base::Optional<::brave_shields::CosmeticResources> resources =
+      g_brave_browser_process->ad_block_service()->UrlCosmeticResources(url);
 
-  if (!resources || !resources->is_dict()) {
+  if (!resources) {
     return std::unique_ptr<base::ListValue>();
   }
 
-  base::Optional<base::Value> regional_resources = g_brave_browser_process->
-      ad_block_regional_service_manager()->UrlCosmeticResources(url);
+  base::Optional<::brave_shields::CosmeticResources> regional_resources =
+      g_brave_browser_process->ad_block_regional_service_manager()->
+          UrlCosmeticResources(url);
 
-  if (regional_resources && regional_resources->is_dict()) {
-    ::brave_shields::MergeResourcesInto(
-        std::move(*regional_resources), &*resources, /*force_hide=*/false);
+  if (regional_resources) {
+    resources->MergeFrom(std::move(*regional_resources), /*force_hide=*/false);
   }
 
-  base::Optional<base::Value> custom_resources = g_brave_browser_process->
-      ad_block_custom_filters_service()->UrlCosmeticResources(url);
+  base::Optional<::brave_shields::CosmeticResources> custom_resources =
+      g_brave_browser_process->ad_block_custom_filters_service()->
+          UrlCosmeticResources(url);
 
-  if (custom_resources && custom_resources->is_dict()) {
-    ::brave_shields::MergeResourcesInto(
-        std::move(*custom_resources), &*resources, /*force_hide=*/true);
+  if (custom_resources) {
+    resources->MergeFrom(std::move(*custom_resources), /*force_hide=*/true);
   }
 
   auto result_list = std::make_unique<base::ListValue>();
-  result_list->Append(std::move(*resources));
+  result_list->Append(std::move(*resources).ToValue());
   return result_list;
 }
 
@@ -126,36 +126,32 @@ std::unique_ptr<base::ListValue> BraveShieldsHiddenClassIdSelectorsFunction::
         const std::vector<std::string>& classes,
         const std::vector<std::string>& ids,
         const std::vector<std::string>& exceptions) {
-  base::Optional<base::Value> hide_selectors = g_brave_browser_process->
+  std::vector<std::string> hide_selectors = g_brave_browser_process->
       ad_block_service()->HiddenClassIdSelectors(classes, ids, exceptions);
 
-  base::Optional<base::Value> regional_selectors = g_brave_browser_process->
+  std::vector<std::string> regional_selectors = g_brave_browser_process->
       ad_block_regional_service_manager()->
           HiddenClassIdSelectors(classes, ids, exceptions);
 
-  base::Optional<base::Value> custom_selectors = g_brave_browser_process->
+  std::vector<std::string> custom_selectors = g_brave_browser_process->
       ad_block_custom_filters_service()->
           HiddenClassIdSelectors(classes, ids, exceptions);
 
-  if (hide_selectors && hide_selectors->is_list()) {
-    if (regional_selectors && regional_selectors->is_list()) {
-      for (auto i = regional_selectors->GetList().begin();
-              i < regional_selectors->GetList().end();
-              i++) {
-        hide_selectors->Append(std::move(*i));
-      }
-    }
-  } else {
-    hide_selectors = std::move(regional_selectors);
-  }
+  hide_selectors.insert(hide_selectors.end(),
+                        std::make_move_iterator(regional_selectors.begin()),
+                        std::make_move_iterator(regional_selectors.end()));
 
   auto result_list = std::make_unique<base::ListValue>();
-  if (hide_selectors && hide_selectors->is_list()) {
-    result_list->Append(std::move(*hide_selectors));
+  base::Value hide_selectors_list(base::Value::Type::LIST);
+  for (auto& selector : hide_selectors) {
+    hide_selectors_list.Append(std::move(selector));
   }
-  if (custom_selectors && custom_selectors->is_list()) {
-    result_list->Append(std::move(*custom_selectors));
+  result_list->Append(std::move(hide_selectors_list));
+  base::Value custom_selectors_list(base::Value::Type::LIST);
+  for (auto& selector : custom_selectors) {
+    custom_selectors_list.Append(std::move(selector));
   }
+  result_list->Append(std::move(custom_selectors_list));
 
   return result_list;
 }
@@ -0,0 +1,245 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/adblock_cname_cache.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/ptr_util.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/supports_user_data.h"
+#include "base/task/post_task.h"
+#include "base/time/default_tick_clock.h"
+#include "base/time/tick_clock.h"
+#include "base/time/time.h"
+#include "content/public/browser/browser_context.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/storage_partition.h"
+#include "mojo/public/cpp/bindings/receiver.h"
+#include "net/base/host_port_pair.h"
+#include "net/base/net_errors.h"
+#include "services/network/public/mojom/network_context.mojom.h"
+#include "url/gurl.h"
+
+namespace brave {
+
+namespace {
+
+const void* const kAdblockCnameCacheUserDataKey =
+    &kAdblockCnameCacheUserDataKey;
+
+// How long resolved and failed hosts are remembered.
+constexpr base::TimeDelta kEntryLifetime = base::TimeDelta::FromMinutes(1);
+constexpr base::TimeDelta kFailedEntryLifetime =
+    base::TimeDelta::FromSeconds(10);
+
+// Resolves a host and records its canonical name in the AdblockCnameCache.
+// Lives on the UI thread and deletes itself once the resolve completes.
+class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
+ private:
+  mojo::Receiver<network::mojom::ResolveHostClient> receiver_{this};
+  scoped_refptr<AdblockCnameCache> cache_;
+  std::string host_;
+  net::NetworkIsolationKey network_isolation_key_;
+  base::TimeTicks start_time_;
+
+ public:
+  AdblockCnameResolveHostClient(
+      content::BrowserContext* context,
+      scoped_refptr<AdblockCnameCache> cache,
+      const GURL& url,
+      const net::NetworkIsolationKey& network_isolation_key)
+      : cache_(std::move(cache)),
+        host_(url.host()),
+        network_isolation_key_(network_isolation_key) {
+    network::mojom::ResolveHostParametersPtr optional_parameters =
+        network::mojom::ResolveHostParameters::New();
+    optional_parameters->include_canonical_name = true;
+
+    network::mojom::NetworkContext* network_context =
+        content::BrowserContext::GetDefaultStoragePartition(context)
+            ->GetNetworkContext();
+
+    start_time_ = base::TimeTicks::Now();
+
+    network_context->ResolveHost(
+        net::HostPortPair::FromURL(url), network_isolation_key,
+        std::move(optional_parameters), receiver_.BindNewPipeAndPassRemote());
+
+    receiver_.set_disconnect_handler(
+        base::BindOnce(&AdblockCnameResolveHostClient::OnComplete,
+                       base::Unretained(this), net::ERR_NAME_NOT_RESOLVED,
+                       net::ResolveErrorInfo(net::ERR_FAILED), base::nullopt));
+  }
+
+  void OnComplete(
+      int32_t result,
+      const net::ResolveErrorInfo& resolve_error_info,
+      const base::Optional<net::AddressList>& resolved_addresses) override {
+    UMA_HISTOGRAM_TIMES("Brave.ShieldsCNAMEBlocking.TotalResolutionTime",
+                        base::TimeTicks::Now() - start_time_);
+    base::Optional<std::string> canonical_name;
+    if (result == net::OK && resolved_addresses) {
+      DCHECK(resolved_addresses.has_value() && !resolved_addresses->empty());
+      canonical_name = resolved_addresses->canonical_name();
+    }
+    cache_->FinishResolving(host_, network_isolation_key_, canonical_name);
+
+    delete this;
+  }
+
+  // Should not be called
+  void OnTextResults(const std::vector<std::string>& text_results) override {
+    NOTREACHED();
+  }
+
+  // Should not be called
+  void OnHostnameResults(const std::vector<net::HostPortPair>& hosts) override {
+    NOTREACHED();
+  }
+};
+
+}  // namespace
+
+// Ties the cache to its browser context, which only the UI thread may use.
+class AdblockCnameCache::Holder : public base::SupportsUserData::Data {
+ public:
+  explicit Holder(scoped_refptr<AdblockCnameCache> cache)
+      : cache_(std::move(cache)) {}
+  ~Holder() override {
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    cache_->context_ = nullptr;
+  }
+
+  AdblockCnameCache* cache() const { return cache_.get(); }
+
+ private:
+  scoped_refptr<AdblockCnameCache> cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(Holder);
+};
+
+AdblockCnameCache::AdblockCnameCache(content::BrowserContext* context)
+    : canonical_names_(kMaxEntries),
+      tick_clock_(base::DefaultTickClock::GetInstance()),
+      context_(context) {}
+
+AdblockCnameCache::~AdblockCnameCache() = default;
+
+// static
+scoped_refptr<AdblockCnameCache> AdblockCnameCache::FromBrowserContext(
+    content::BrowserContext* context) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  auto* holder =
+      static_cast<Holder*>(context->GetUserData(kAdblockCnameCacheUserDataKey));
+  if (!holder) {
+    holder = new Holder(base::WrapRefCounted(new AdblockCnameCache(context)));
+    context->SetUserData(kAdblockCnameCacheUserDataKey,
+                         base::WrapUnique(holder));
+  }
+  return holder->cache();
+}
+
+bool AdblockCnameCache::Get(
+    const std::string& host,
+    const net::NetworkIsolationKey& network_isolation_key,
+    std::string* canonical_name) {
+  base::AutoLock lock(lock_);
+  auto it = canonical_names_.Get({network_isolation_key, host});
+  if (it == canonical_names_.end())
+    return false;
+  if (it->second.expiry <= tick_clock_->NowTicks()) {
+    canonical_names_.Erase(it);
+    return false;
+  }
+  *canonical_name = it->second.canonical_name;
+  return true;
+}
+
+void AdblockCnameCache::Resolve(
+    const GURL& url,
+    const net::NetworkIsolationKey& network_isolation_key) {
+  const bool on_ui_thread =
+      content::BrowserThread::CurrentlyOn(content::BrowserThread::UI);
+  {
+    base::AutoLock lock(lock_);
+    if (!pending_resolves_.insert({network_isolation_key, url.host()}).second)
+      return;
+    queued_resolves_.push_back({url, network_isolation_key});
+    if (!on_ui_thread) {
+      if (is_resolve_task_posted_)
+        return;
+      is_resolve_task_posted_ = true;
+      base::PostTask(FROM_HERE, {content::BrowserThread::UI},
+                     base::BindOnce(&AdblockCnameCache::StartQueuedResolves,
+                                    base::WrapRefCounted(this)));
+      return;
+    }
+  }
+  StartQueuedResolves();
+}
+
+void AdblockCnameCache::StartQueuedResolves() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  std::vector<QueuedResolve> resolves;
+  {
+    base::AutoLock lock(lock_);
+    resolves.swap(queued_resolves_);
+    is_resolve_task_posted_ = false;
+  }
+  for (const auto& resolve : resolves)
+    StartResolving(resolve.url, resolve.network_isolation_key);
+}
+
+void AdblockCnameCache::StartResolving(
+    const GURL& url,
+    const net::NetworkIsolationKey& network_isolation_key) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  if (resolver_for_testing_) {
+    resolver_for_testing_.Run(url, network_isolation_key);
+    return;
+  }
+  if (!context_) {
+    FinishResolving(url.host(), network_isolation_key, base::nullopt);
+    return;
+  }
+  new AdblockCnameResolveHostClient(context_, base::WrapRefCounted(this), url,
+                                    network_isolation_key);
+}
+
+void AdblockCnameCache::FinishResolving(
+    const std::string& host,
+    const net::NetworkIsolationKey& network_isolation_key,
+    const base::Optional<std::string>& canonical_name) {
+  base::AutoLock lock(lock_);
+  const Key key(network_isolation_key, host);
+  pending_resolves_.erase(key);
+  Entry entry;
+  if (canonical_name) {
+    if (*canonical_name != host)
+      entry.canonical_name = *canonical_name;
+    entry.expiry = tick_clock_->NowTicks() + kEntryLifetime;
+  } else {
+    entry.expiry = tick_clock_->NowTicks() + kFailedEntryLifetime;
+  }
+  canonical_names_.Put(key, std::move(entry));
+}
+
+void AdblockCnameCache::SetResolverForTesting(Resolver resolver) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  resolver_for_testing_ = std::move(resolver);
+}
+
+void AdblockCnameCache::SetTickClockForTesting(
+    const base::TickClock* tick_clock) {
+  base::AutoLock lock(lock_);
+  tick_clock_ = tick_clock;
+}
+
+}  // namespace brave
@@ -0,0 +1,123 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_BROWSER_NET_ADBLOCK_CNAME_CACHE_H_
+#define BRAVE_BROWSER_NET_ADBLOCK_CNAME_CACHE_H_
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/optional.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/time/time.h"
+#include "net/base/network_isolation_key.h"
+#include "url/gurl.h"
+
+namespace base {
+class TickClock;
+}
+
+namespace content {
+class BrowserContext;
+}
+
+namespace brave {
+
+// Remembers the canonical names of recently resolved hosts for a browser
+// context, so that requests can be checked against their uncloaked host
+// without waiting on DNS. Lookups are safe from any sequence; resolves are
+// always started on the UI thread, with a single task for all the hosts
+// queued in the meantime.
+//
+// Entries are keyed by the network isolation key the host was resolved with,
+// since the answer may differ between keys, and expire after a while. Failed
+// resolves are remembered for a shorter time, so that an unresolvable host is
+// not looked up again on every request.
+class AdblockCnameCache
+    : public base::RefCountedThreadSafe<AdblockCnameCache> {
+ public:
+  static constexpr size_t kMaxEntries = 1000;
+
+  // Starts resolving |url| on the UI thread, reporting the result through
+  // FinishResolving().
+  using Resolver = base::RepeatingCallback<void(
+      const GURL& url,
+      const net::NetworkIsolationKey& network_isolation_key)>;
+
+  // Must be called on the UI thread.
+  static scoped_refptr<AdblockCnameCache> FromBrowserContext(
+      content::BrowserContext* context);
+
+  // Returns the canonical name recorded for |host|, which is empty when the
+  // host has no alias or could not be resolved.
+  bool Get(const std::string& host,
+           const net::NetworkIsolationKey& network_isolation_key,
+           std::string* canonical_name);
+
+  // Resolves the host of |url| in the background, unless a resolve for it is
+  // already in flight. The request that triggered the resolve does not wait
+  // for it.
+  void Resolve(const GURL& url,
+               const net::NetworkIsolationKey& network_isolation_key);
+
+  // |canonical_name| is null if the host could not be resolved.
+  void FinishResolving(const std::string& host,
+                       const net::NetworkIsolationKey& network_isolation_key,
+                       const base::Optional<std::string>& canonical_name);
+
+  void SetResolverForTesting(Resolver resolver);
+  void SetTickClockForTesting(const base::TickClock* tick_clock);
+
+ private:
+  friend class base::RefCountedThreadSafe<AdblockCnameCache>;
+  class Holder;
+
+  explicit AdblockCnameCache(content::BrowserContext* context);
+  ~AdblockCnameCache();
+
+  using Key = std::pair<net::NetworkIsolationKey, std::string>;
+
+  struct Entry {
+    std::string canonical_name;
+    base::TimeTicks expiry;
+  };
+
+  struct QueuedResolve {
+    GURL url;
+    net::NetworkIsolationKey network_isolation_key;
+  };
+
+  void StartQueuedResolves();
+  void StartResolving(const GURL& url,
+                      const net::NetworkIsolationKey& network_isolation_key);
+
+  base::Lock lock_;
+  base::MRUCache<Key, Entry> canonical_names_ GUARDED_BY(lock_);
+  std::set<Key> pending_resolves_ GUARDED_BY(lock_);
+  // Resolves waiting for the UI thread, and whether a task to start them is
+  // already posted.
+  std::vector<QueuedResolve> queued_resolves_ GUARDED_BY(lock_);
+  bool is_resolve_task_posted_ GUARDED_BY(lock_) = false;
+  const base::TickClock* tick_clock_ GUARDED_BY(lock_);
+
+  // Only used on the UI thread.
+  Resolver resolver_for_testing_;
+
+  // Only used on the UI thread; reset when the context goes away.
+  content::BrowserContext* context_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdblockCnameCache);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_NET_ADBLOCK_CNAME_CACHE_H_
@@ -0,0 +1,149 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/adblock_cname_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/task/thread_pool.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/time/time.h"
+#include "chrome/test/base/testing_profile.h"
+#include "content/public/test/browser_task_environment.h"
+#include "net/base/network_isolation_key.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+#include "url/origin.h"
+
+namespace brave {
+
+class AdblockCnameCacheTest : public testing::Test {
+ public:
+  AdblockCnameCacheTest()
+      : network_isolation_key_(
+            url::Origin::Create(GURL("https://a.com")),
+            url::Origin::Create(GURL("https://a.com"))) {}
+
+  void SetUp() override {
+    cache_ = AdblockCnameCache::FromBrowserContext(&profile_);
+    cache_->SetTickClockForTesting(&tick_clock_);
+    cache_->SetResolverForTesting(base::BindRepeating(
+        &AdblockCnameCacheTest::OnResolve, base::Unretained(this)));
+  }
+
+ protected:
+  // Records the resolve instead of starting it.
+  void OnResolve(const GURL& url,
+                 const net::NetworkIsolationKey& network_isolation_key) {
+    resolved_hosts_.push_back(url.host());
+  }
+
+  content::BrowserTaskEnvironment task_environment_;
+  TestingProfile profile_;
+  base::SimpleTestTickClock tick_clock_;
+  const net::NetworkIsolationKey network_isolation_key_;
+  scoped_refptr<AdblockCnameCache> cache_;
+  std::vector<std::string> resolved_hosts_;
+};
+
+TEST_F(AdblockCnameCacheTest, ResolvesEachHostOnce) {
+  const GURL url("https://tracker.a.com/pixel.png");
+  std::string canonical_name;
+  EXPECT_FALSE(cache_->Get(url.host(), network_isolation_key_,
+                           &canonical_name));
+
+  cache_->Resolve(url, network_isolation_key_);
+  cache_->Resolve(url, network_isolation_key_);
+  EXPECT_EQ(resolved_hosts_, std::vector<std::string>({"tracker.a.com"}));
+
+  cache_->FinishResolving(url.host(), network_isolation_key_,
+                          std::string("a.tracker.com"));
+  EXPECT_TRUE(cache_->Get(url.host(), network_isolation_key_,
+                          &canonical_name));
+  EXPECT_EQ(canonical_name, "a.tracker.com");
+}
+
+TEST_F(AdblockCnameCacheTest, HostWithoutAlias) {
+  const GURL url("https://a.com/logo.png");
+  cache_->Resolve(url, network_isolation_key_);
+  cache_->FinishResolving(url.host(), network_isolation_key_,
+                          std::string("a.com"));
+
+  std::string canonical_name = "unset";
+  EXPECT_TRUE(cache_->Get(url.host(), network_isolation_key_,
+                          &canonical_name));
+  EXPECT_EQ(canonical_name, "");
+}
+
+TEST_F(AdblockCnameCacheTest, CachesFailedResolves) {
+  const GURL url("https://unresolvable.a.com/ad.js");
+  cache_->Resolve(url, network_isolation_key_);
+  cache_->FinishResolving(url.host(), network_isolation_key_, base::nullopt);
+
+  // Later requests to the host don't resolve it again for a while.
+  std::string canonical_name = "unset";
+  EXPECT_TRUE(cache_->Get(url.host(), network_isolation_key_,
+                          &canonical_name));
+  EXPECT_EQ(canonical_name, "");
+  EXPECT_EQ(resolved_hosts_.size(), 1u);
+
+  tick_clock_.Advance(base::TimeDelta::FromSeconds(11));
+  EXPECT_FALSE(cache_->Get(url.host(), network_isolation_key_,
+                           &canonical_name));
+  cache_->Resolve(url, network_isolation_key_);
+  EXPECT_EQ(resolved_hosts_.size(), 2u);
+}
+
+TEST_F(AdblockCnameCacheTest, EntriesExpire) {
+  const GURL url("https://tracker.a.com/pixel.png");
+  cache_->Resolve(url, network_isolation_key_);
+  cache_->FinishResolving(url.host(), network_isolation_key_,
+                          std::string("a.tracker.com"));
+
+  std::string canonical_name;
+  tick_clock_.Advance(base::TimeDelta::FromSeconds(59));
+  EXPECT_TRUE(cache_->Get(url.host(), network_isolation_key_,
+                          &canonical_name));
+  tick_clock_.Advance(base::TimeDelta::FromSeconds(1));
+  EXPECT_FALSE(cache_->Get(url.host(), network_isolation_key_,
+                           &canonical_name));
+
+  cache_->Resolve(url, network_isolation_key_);
+  EXPECT_EQ(resolved_hosts_.size(), 2u);
+}
+
+TEST_F(AdblockCnameCacheTest, KeyedByNetworkIsolationKey) {
+  const GURL url("https://tracker.a.com/pixel.png");
+  const net::NetworkIsolationKey other_network_isolation_key(
+      url::Origin::Create(GURL("https://b.com")),
+      url::Origin::Create(GURL("https://b.com")));
+  cache_->Resolve(url, network_isolation_key_);
+  cache_->FinishResolving(url.host(), network_isolation_key_,
+                          std::string("a.tracker.com"));
+
+  std::string canonical_name;
+  EXPECT_FALSE(cache_->Get(url.host(), other_network_isolation_key,
+                           &canonical_name));
+  cache_->Resolve(url, other_network_isolation_key);
+  EXPECT_EQ(resolved_hosts_.size(), 2u);
+}
+
+TEST_F(AdblockCnameCacheTest, ResolvesFromOtherSequences) {
+  for (const char* spec :
+       {"https://one.a.com/1.png", "https://one.a.com/2.png",
+        "https://two.a.com/1.png"}) {
+    base::ThreadPool::PostTask(
+        FROM_HERE,
+        base::BindOnce(&AdblockCnameCache::Resolve, cache_, GURL(spec),
+                       network_isolation_key_));
+  }
+  task_environment_.RunUntilIdle();
+
+  EXPECT_EQ(resolved_hosts_.size(), 2u);
+}
+
+}  // namespace brave
@@ -8,26 +8,24 @@
 #include <memory>
 #include <string>
 #include <utility>
-#include <vector>
 
 #include "base/base64url.h"
+#include "base/feature_list.h"
+#include "base/no_destructor.h"
 #include "base/strings/string_util.h"
 #include "brave/browser/brave_browser_process_impl.h"
+#include "brave/browser/net/adblock_cname_cache.h"
+#include "brave/browser/net/request_context_snapshot.h"
 #include "brave/browser/net/url_context.h"
 #include "brave/common/network_constants.h"
+#include "brave/components/brave_shields/browser/ad_block_decision_cache.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
+#include "brave/components/brave_shields/common/features.h"
 #include "brave/grit/brave_generated_resources.h"
-#include "content/public/browser/browser_context.h"
-#include "content/public/browser/browser_thread.h"
-#include "content/public/browser/render_frame_host.h"
-#include "content/public/browser/storage_partition.h"
-#include "content/public/browser/web_contents.h"
 #include "extensions/common/url_pattern.h"
-#include "mojo/public/cpp/bindings/remote.h"
-#include "services/network/network_context.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "url/url_canon.h"
 
@@ -35,21 +33,46 @@ namespace brave {
 
 namespace {
 
-content::WebContents* GetWebContents(int render_process_id,
-                                     int render_frame_id,
-                                     int frame_tree_node_id) {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-  content::WebContents* web_contents =
-      content::WebContents::FromFrameTreeNodeId(frame_tree_node_id);
-  if (!web_contents) {
-    content::RenderFrameHost* rfh =
-        content::RenderFrameHost::FromID(render_process_id, render_frame_id);
-    if (!rfh) {
-      return nullptr;
-    }
-    web_contents = content::WebContents::FromRenderFrameHost(rfh);
+// Only touched on the adblock task runner.
+brave_shields::AdBlockDecisionCache* GetDecisionCache() {
+  static base::NoDestructor<brave_shields::AdBlockDecisionCache> cache;
+  return cache.get();
+}
+
+// Wraps AdBlockService::ShouldStartRequest with the optional decision cache.
+bool ShouldStartRequest(const GURL& url,
+                        blink::mojom::ResourceType resource_type,
+                        const std::string& tab_host,
+                        bool* did_match_exception,
+                        bool* cancel_request_explicitly,
+                        std::string* mock_data_url) {
+  auto* ad_block_service = g_brave_browser_process->ad_block_service();
+  if (!base::FeatureList::IsEnabled(
+          brave_shields::features::kBraveAdblockDecisionCache)) {
+    return ad_block_service->ShouldStartRequest(
+        url, resource_type, tab_host, did_match_exception,
+        cancel_request_explicitly, mock_data_url);
   }
-  return web_contents;
+
+  DCHECK(ad_block_service->GetTaskRunner()->RunsTasksInCurrentSequence());
+  const uint64_t generation =
+      brave_shields::AdBlockBaseService::GetEngineGeneration();
+  brave_shields::AdBlockDecisionCache::Decision decision;
+  if (!GetDecisionCache()->Get(url, resource_type, tab_host, generation,
+                               &decision)) {
+    decision.should_start = ad_block_service->ShouldStartRequest(
+        url, resource_type, tab_host, &decision.did_match_exception,
+        &decision.cancel_request_explicitly, &decision.mock_data_url);
+    GetDecisionCache()->Put(url, resource_type, tab_host, generation,
+                            decision);
+  }
+
+  *did_match_exception = decision.did_match_exception;
+  if (!decision.should_start)
+    *cancel_request_explicitly = decision.cancel_request_explicitly;
+  if (!decision.mock_data_url.empty())
+    *mock_data_url = decision.mock_data_url;
+  return decision.should_start;
 }
 
 }  // namespace
@@ -57,8 +80,8 @@ content::WebContents* GetWebContents(int render_process_id,
 void ShouldBlockAdOnTaskRunner(std::shared_ptr<BraveRequestInfo> ctx,
                                base::Optional<std::string> canonical_name) {
   bool did_match_exception = false;
-  std::string tab_host = ctx->tab_origin.host();
-  if (!g_brave_browser_process->ad_block_service()->ShouldStartRequest(
+  std::string tab_host = ctx->tab_origin().host();
+  if (!ShouldStartRequest(
           ctx->request_url, ctx->resource_type, tab_host, &did_match_exception,
           &ctx->cancel_request_explicitly, &ctx->mock_data_url)) {
     ctx->blocked_by = kAdBlocked;
@@ -71,7 +94,7 @@ void ShouldBlockAdOnTaskRunner(std::shared_ptr<BraveRequestInfo> ctx,
         url::Component(0, static_cast<int>(canonical_name->length())));
     const GURL canonical_url = ctx->request_url.ReplaceComponents(replacements);
 
-    if (!g_brave_browser_process->ad_block_service()->ShouldStartRequest(
+    if (!ShouldStartRequest(
             canonical_url, ctx->resource_type, tab_host, &did_match_exception,
             &ctx->cancel_request_explicitly, &ctx->mock_data_url)) {
       ctx->blocked_by = kAdBlocked;
@@ -81,7 +104,6 @@ void ShouldBlockAdOnTaskRunner(std::shared_ptr<BraveRequestInfo> ctx,
 
 void OnShouldBlockAdResult(const ResponseCallback& next_callback,
                            std::shared_ptr<BraveRequestInfo> ctx) {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   if (ctx->blocked_by == kAdBlocked) {
     brave_shields::DispatchBlockedEvent(
         ctx->request_url, ctx->render_frame_id, ctx->render_process_id,
@@ -95,92 +117,16 @@ void ShouldBlockAdWithOptionalCname(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx,
     const base::Optional<std::string> cname) {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   task_runner->PostTaskAndReply(
       FROM_HERE, base::BindOnce(&ShouldBlockAdOnTaskRunner, ctx, cname),
       base::BindOnce(&OnShouldBlockAdResult, next_callback, ctx));
 }
 
-class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
- private:
-  mojo::Receiver<network::mojom::ResolveHostClient> receiver_{this};
-  base::OnceCallback<void(base::Optional<std::string>)> cb_;
-  base::TimeTicks start_time_;
-
- public:
-  AdblockCnameResolveHostClient(
-      const ResponseCallback& next_callback,
-      scoped_refptr<base::SequencedTaskRunner> task_runner,
-      std::shared_ptr<BraveRequestInfo> ctx) {
-    cb_ = base::BindOnce(&ShouldBlockAdWithOptionalCname, task_runner,
-                         std::move(next_callback), ctx);
-
-    auto* web_contents = GetWebContents(
-        ctx->render_process_id, ctx->render_frame_id, ctx->frame_tree_node_id);
-    if (!web_contents) {
-      start_time_ = base::TimeTicks::Now();
-      this->OnComplete(net::ERR_FAILED, net::ResolveErrorInfo(), base::nullopt);
-      return;
-    }
-
-    content::BrowserContext* context = web_contents->GetBrowserContext();
-
-    const auto network_isolation_key = ctx->network_isolation_key;
-
-    network::mojom::ResolveHostParametersPtr optional_parameters =
-        network::mojom::ResolveHostParameters::New();
-    optional_parameters->include_canonical_name = true;
-
-    network::mojom::NetworkContext* network_context =
-        content::BrowserContext::GetDefaultStoragePartition(context)
-            ->GetNetworkContext();
-
-    start_time_ = base::TimeTicks::Now();
-
-    network_context->ResolveHost(
-        net::HostPortPair::FromURL(ctx->request_url), network_isolation_key,
-        std::move(optional_parameters), receiver_.BindNewPipeAndPassRemote());
-
-    receiver_.set_disconnect_handler(
-        base::BindOnce(&AdblockCnameResolveHostClient::OnComplete,
-                       base::Unretained(this), net::ERR_NAME_NOT_RESOLVED,
-                       net::ResolveErrorInfo(net::ERR_FAILED), base::nullopt));
-  }
-
-  void OnComplete(
-      int32_t result,
-      const net::ResolveErrorInfo& resolve_error_info,
-      const base::Optional<net::AddressList>& resolved_addresses) override {
-    UMA_HISTOGRAM_TIMES("Brave.ShieldsCNAMEBlocking.TotalResolutionTime",
-                        base::TimeTicks::Now() - start_time_);
-    if (result == net::OK && resolved_addresses) {
-      DCHECK(resolved_addresses.has_value() && !resolved_addresses->empty());
-      std::move(cb_).Run(
-          base::Optional<std::string>(resolved_addresses->canonical_name()));
-    } else {
-      std::move(cb_).Run(base::nullopt);
-    }
-
-    delete this;
-  }
-
-  // Should not be called
-  void OnTextResults(const std::vector<std::string>& text_results) override {
-    NOTREACHED();
-  }
-
-  // Should not be called
-  void OnHostnameResults(const std::vector<net::HostPortPair>& hosts) override {
-    NOTREACHED();
-  }
-};
-
 void OnBeforeURLRequestAdBlockTP(const ResponseCallback& next_callback,
                                  std::shared_ptr<BraveRequestInfo> ctx) {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   // If the following info isn't available, then proper content settings can't
   // be looked up, so do nothing.
-  if (ctx->tab_origin.is_empty() || !ctx->tab_origin.has_host() ||
+  if (ctx->tab_origin().is_empty() || !ctx->tab_origin().has_host() ||
       ctx->request_url.is_empty()) {
     return;
   }
@@ -189,7 +135,21 @@ void OnBeforeURLRequestAdBlockTP(const ResponseCallback& next_callback,
   scoped_refptr<base::SequencedTaskRunner> task_runner =
       g_brave_browser_process->ad_block_service()->GetTaskRunner();
 
-  new AdblockCnameResolveHostClient(std::move(next_callback), task_runner, ctx);
+  // The request is matched right away. Its uncloaked host is checked too if
+  // the canonical name is already known; otherwise it is looked up in the
+  // background for the benefit of later requests to the same host.
+  base::Optional<std::string> cname;
+  if (ctx->context_snapshot) {
+    AdblockCnameCache* cache = ctx->context_snapshot->adblock_cname_cache();
+    std::string canonical_name;
+    if (cache->Get(ctx->request_url.host(), ctx->network_isolation_key,
+                   &canonical_name))
+      cname = canonical_name;
+    else
+      cache->Resolve(ctx->request_url, ctx->network_isolation_key);
+  }
+
+  ShouldBlockAdWithOptionalCname(task_runner, next_callback, ctx, cname);
 }
 
 int OnBeforeURLRequest_AdBlockTPPreWork(const ResponseCallback& next_callback,
@@ -200,7 +160,7 @@ int OnBeforeURLRequest_AdBlockTPPreWork(const ResponseCallback& next_callback,
 
   // If the following info isn't available, then proper content settings can't
   // be looked up, so do nothing.
-  if (ctx->tab_origin.is_empty() || !ctx->allow_brave_shields ||
+  if (ctx->tab_origin().is_empty() || !ctx->allow_brave_shields ||
       ctx->allow_ads ||
       ctx->resource_type == BraveRequestInfo::kInvalidResourceType) {
     return net::OK;
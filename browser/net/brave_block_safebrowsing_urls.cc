@@ -5,9 +5,7 @@
 
 #include "brave/browser/net/brave_block_safebrowsing_urls.h"
 
-#include <vector>
-
-#include "extensions/common/url_pattern.h"
+#include "brave/browser/net/brave_static_request_rules.h"
 #include "net/base/net_errors.h"
 #include "url/gurl.h"
 
@@ -16,30 +14,9 @@ namespace brave {
 const char kDummyUrl[] = "https://no-thanks.invalid";
 
 bool IsSafeBrowsingReportingURL(const GURL& gurl) {
-  static const std::vector<URLPattern> allowed_patterns({
-      URLPattern(
-          URLPattern::SCHEME_HTTPS,
-          "https://sb-ssl.google.com/safebrowsing/clientreport/download*"),
-  });
-  static const std::vector<URLPattern> reporting_patterns({
-      URLPattern(URLPattern::SCHEME_HTTPS,
-                 "https://sb-ssl.google.com/safebrowsing/clientreport/*"),
-      URLPattern(URLPattern::SCHEME_HTTPS,
-                 "https://safebrowsing.google.com/safebrowsing/clientreport/*"),
-      URLPattern(URLPattern::SCHEME_HTTPS,
-                 "https://safebrowsing.google.com/safebrowsing/report*"),
-      URLPattern(URLPattern::SCHEME_HTTPS,
-                 "https://safebrowsing.google.com/safebrowsing/uploads/*"),
-  });
-
-  if (std::any_of(
-          allowed_patterns.begin(), allowed_patterns.end(),
-          [&gurl](URLPattern pattern) { return pattern.MatchesURL(gurl); })) {
-    return false;
-  }
-  return std::any_of(
-      reporting_patterns.begin(), reporting_patterns.end(),
-      [&gurl](URLPattern pattern) { return pattern.MatchesURL(gurl); });
+  const StaticRequestRuleMatches rules = MatchStaticRequestRules(gurl);
+  return rules.Has(StaticRequestRule::kSafeBrowsingReport) &&
+         !rules.Has(StaticRequestRule::kSafeBrowsingReportAllowed);
 }
 
 int OnBeforeURLRequest_BlockSafeBrowsingReportingURLs(const GURL& request_url,
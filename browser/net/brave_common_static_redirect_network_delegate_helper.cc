@@ -13,18 +13,12 @@
 #include "base/feature_list.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
+#include "brave/browser/net/brave_static_request_rules.h"
 #include "brave/common/network_constants.h"
 #include "brave/components/brave_component_updater/browser/features.h"
 #include "brave/components/brave_component_updater/browser/switches.h"
-#include "components/component_updater/component_updater_url_constants.h"
-#include "extensions/buildflags/buildflags.h"
-#include "extensions/common/url_pattern.h"
 #include "net/base/net_errors.h"
 
-#if BUILDFLAG(ENABLE_EXTENSIONS)
-#include "extensions/common/extension_urls.h"
-#endif
-
 namespace brave {
 
 const char kUpdaterTestingEndpoint[] = "test.updater.com";
@@ -47,27 +41,6 @@ std::string GetUpdateURLHost() {
   return UPDATER_DEV_ENDPOINT;
 }
 
-// Update server checks happen from the profile context for admin policy
-// installed extensions. Update server checks happen from the system context for
-// normal update operations.
-bool IsUpdaterURL(const GURL& gurl) {
-  static std::vector<URLPattern> updater_patterns(
-      {URLPattern(URLPattern::SCHEME_HTTPS,
-                  std::string(component_updater::kUpdaterJSONDefaultUrl) + "*"),
-       URLPattern(
-           URLPattern::SCHEME_HTTP,
-           std::string(component_updater::kUpdaterJSONFallbackUrl) + "*"),
-#if BUILDFLAG(ENABLE_EXTENSIONS)
-       URLPattern(
-           URLPattern::SCHEME_HTTPS,
-           std::string(extension_urls::kChromeWebstoreUpdateURL) + "*")
-#endif
-  });
-  return std::any_of(
-      updater_patterns.begin(), updater_patterns.end(),
-      [&gurl](URLPattern pattern) { return pattern.MatchesURL(gurl); });
-}
-
 bool RewriteBugReportingURL(const GURL& request_url, GURL* new_url) {
   GURL url("https://github.com/brave/brave-browser/issues/new");
   std::string query = "title=Crash%20Report&labels=crash";
@@ -115,16 +88,15 @@ int OnBeforeURLRequest_CommonStaticRedirectWorkForGURL(
     GURL* new_url) {
   DCHECK(new_url);
 
+  const StaticRequestRuleMatches rules = MatchStaticRequestRules(request_url);
+  if (rules.empty())
+    return net::OK;
+
   GURL::Replacements replacements;
-  static URLPattern chromecast_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kChromeCastPrefix);
-  static URLPattern clients4_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kClients4Prefix);
-  static URLPattern bugsChromium_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS,
-      "*://bugs.chromium.org/p/chromium/issues/entry?*");
-
-  if (IsUpdaterURL(request_url)) {
+  // Update server checks happen from the profile context for admin policy
+  // installed extensions. Update server checks happen from the system context
+  // for normal update operations.
+  if (rules.Has(StaticRequestRule::kUpdater)) {
     auto update_host = GetUpdateURLHost();
     if (!update_host.empty()) {
       replacements.SetQueryStr(request_url.query_piece());
@@ -133,21 +105,21 @@ int OnBeforeURLRequest_CommonStaticRedirectWorkForGURL(
     return net::OK;
   }
 
-  if (chromecast_pattern.MatchesURL(request_url)) {
+  if (rules.Has(StaticRequestRule::kChromecast)) {
     replacements.SetSchemeStr("https");
     replacements.SetHostStr(kBraveRedirectorProxy);
     *new_url = request_url.ReplaceComponents(replacements);
     return net::OK;
   }
 
-  if (clients4_pattern.MatchesHost(request_url)) {
+  if (rules.Has(StaticRequestRule::kClients4)) {
     replacements.SetSchemeStr("https");
     replacements.SetHostStr(kBraveClients4Proxy);
     *new_url = request_url.ReplaceComponents(replacements);
     return net::OK;
   }
 
-  if (bugsChromium_pattern.MatchesURL(request_url)) {
+  if (rules.Has(StaticRequestRule::kBugsChromium)) {
     if (RewriteBugReportingURL(request_url, new_url))
       return net::OK;
   }
@@ -15,9 +15,6 @@
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/https_everywhere_service.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
-#include "content/public/browser/browser_thread.h"
-
-using content::BrowserThread;
 
 namespace brave {
 
@@ -33,8 +30,6 @@ void OnBeforeURLRequest_HttpseFileWork(
 void OnBeforeURLRequest_HttpsePostFileWork(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx) {
-  DCHECK_CURRENTLY_ON(BrowserThread::UI);
-
   if (!ctx->new_url_spec.empty() &&
     ctx->new_url_spec != ctx->request_url.spec()) {
     brave_shields::DispatchBlockedEvent(ctx->request_url,
@@ -48,14 +43,12 @@ void OnBeforeURLRequest_HttpsePostFileWork(
 int OnBeforeURLRequest_HttpsePreFileWork(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx) {
-  DCHECK_CURRENTLY_ON(BrowserThread::UI);
-
   // Don't try to overwrite an already set URL by another delegate (adblock/tp)
   if (!ctx->new_url_spec.empty()) {
     return net::OK;
   }
 
-  if (ctx->tab_origin.is_empty() || ctx->allow_http_upgradable_resource ||
+  if (ctx->tab_origin().is_empty() || ctx->allow_http_upgradable_resource ||
       !ctx->allow_brave_shields) {
     return net::OK;
   }
@@ -71,24 +64,31 @@ int OnBeforeURLRequest_HttpsePreFileWork(
   }
 
   if (is_valid_url) {
-    if (!g_brave_browser_process->https_everywhere_service()->
-        GetHTTPSURLFromCacheOnly(&ctx->request_url,
-                                 ctx->request_identifier,
-                                 &ctx->new_url_spec)) {
-      g_brave_browser_process->https_everywhere_service()->
-        GetTaskRunner()->PostTaskAndReply(FROM_HERE,
+    brave_shields::HTTPSEverywhereService* service =
+        g_brave_browser_process->https_everywhere_service();
+    bool found = service->GetHTTPSURLFromCacheOnly(
+        &ctx->request_url, ctx->request_identifier, &ctx->new_url_spec);
+    if (!found && service->HasRuleIndex()) {
+      // The precompiled index answers on this thread, so cache misses don't
+      // need a trip to the file task runner.
+      found = service->GetHTTPSURLFromIndex(
+          &ctx->request_url, ctx->request_identifier, &ctx->new_url_spec);
+      if (!found)
+        return net::OK;
+    }
+    if (!found) {
+      service->GetTaskRunner()->PostTaskAndReply(FROM_HERE,
           base::Bind(OnBeforeURLRequest_HttpseFileWork, ctx),
           base::Bind(base::IgnoreResult(
               &OnBeforeURLRequest_HttpsePostFileWork),
               next_callback, ctx));
       return net::ERR_IO_PENDING;
-    } else {
-      if (!ctx->new_url_spec.empty()) {
-        brave_shields::DispatchBlockedEvent(ctx->request_url,
-            ctx->render_frame_id, ctx->render_process_id,
-            ctx->frame_tree_node_id,
-            brave_shields::kHTTPUpgradableResources);
-      }
+    }
+    if (!ctx->new_url_spec.empty()) {
+      brave_shields::DispatchBlockedEvent(ctx->request_url,
+          ctx->render_frame_id, ctx->render_process_id,
+          ctx->frame_tree_node_id,
+          brave_shields::kHTTPUpgradableResources);
     }
   }
 
@@ -7,6 +7,8 @@
 
 #include "brave/browser/net/url_context.h"
 #include "brave/browser/net/brave_stp_util.h"
+#include "brave/browser/net/response_header_changes.h"
+#include "brave/test/base/scoped_allocation_counter.h"
 #include "chrome/test/base/chrome_render_view_host_test_harness.h"
 #include "content/public/test/browser_task_environment.h"
 #include "net/traffic_annotation/network_traffic_annotation_test_helper.h"
@@ -14,10 +16,10 @@
 #include "url/gurl.h"
 
 using brave::RemoveTrackableSecurityHeadersForThirdParty;
+using brave::ResponseHeaderChanges;
 using brave::TrackableSecurityHeaders;
 using net::HttpResponseHeaders;
 
-
 namespace {
 
 const char kFirstPartyDomain[] = "http://firstparty.com/";
@@ -61,9 +63,10 @@ TEST_F(BraveNetworkDelegateBaseTest, RemoveTrackableSecurityHeaders) {
   scoped_refptr<HttpResponseHeaders> headers(
       new HttpResponseHeaders(net::HttpUtil::AssembleRawHeaders(kRawHeaders)));
 
-  RemoveTrackableSecurityHeadersForThirdParty(request_url,
-                                              url::Origin::Create(tab_url),
-                                              nullptr, &headers);
+  ResponseHeaderChanges changes;
+  RemoveTrackableSecurityHeadersForThirdParty(
+      request_url, url::Origin::Create(tab_url), &changes);
+  changes.Apply(nullptr, &headers);
   for (auto header : *TrackableSecurityHeaders()) {
     EXPECT_FALSE(headers->HasHeader(header.as_string()));
   }
@@ -79,9 +82,10 @@ TEST_F(BraveNetworkDelegateBaseTest, RemoveTrackableSecurityHeadersMixedCase) {
   scoped_refptr<HttpResponseHeaders> headers(
       new HttpResponseHeaders(net::HttpUtil::AssembleRawHeaders(kRawHeaders)));
 
-  RemoveTrackableSecurityHeadersForThirdParty(request_url,
-                                              url::Origin::Create(tab_url),
-                                              nullptr, &headers);
+  ResponseHeaderChanges changes;
+  RemoveTrackableSecurityHeadersForThirdParty(
+      request_url, url::Origin::Create(tab_url), &changes);
+  changes.Apply(nullptr, &headers);
   for (auto header : *TrackableSecurityHeaders()) {
     EXPECT_FALSE(headers->HasHeader(header.as_string()));
   }
@@ -97,9 +101,10 @@ TEST_F(BraveNetworkDelegateBaseTest, RetainTrackableSecurityHeaders) {
   scoped_refptr<HttpResponseHeaders> headers(
       new HttpResponseHeaders(net::HttpUtil::AssembleRawHeaders(kRawHeaders)));
 
-  RemoveTrackableSecurityHeadersForThirdParty(request_url,
-                                              url::Origin::Create(tab_url),
-                                              nullptr, &headers);
+  ResponseHeaderChanges changes;
+  RemoveTrackableSecurityHeadersForThirdParty(
+      request_url, url::Origin::Create(tab_url), &changes);
+  changes.Apply(nullptr, &headers);
   for (auto header : *TrackableSecurityHeaders()) {
     EXPECT_TRUE(headers->HasHeader(header.as_string()));
   }
@@ -107,4 +112,97 @@ TEST_F(BraveNetworkDelegateBaseTest, RetainTrackableSecurityHeaders) {
   EXPECT_TRUE(headers->HasHeader(kXSSProtectionHeader));
 }
 
+TEST_F(BraveNetworkDelegateBaseTest,
+       ThirdPartyResponseWithoutTrackableSecurityHeadersIsNotCopied) {
+  GURL request_url(kThirdPartyDomain);
+  GURL tab_url(kFirstPartyDomain);
+
+  scoped_refptr<HttpResponseHeaders> original_headers(
+      new HttpResponseHeaders(net::HttpUtil::AssembleRawHeaders(
+          "HTTP/1.0 200 OK\n"
+          "Accept-Language: *\n"
+          "X-XSS-Protection: 0")));
+  scoped_refptr<HttpResponseHeaders> override_headers;
+
+  ResponseHeaderChanges changes;
+  RemoveTrackableSecurityHeadersForThirdParty(
+      request_url, url::Origin::Create(tab_url), &changes);
+  EXPECT_FALSE(changes.empty());
+  changes.Apply(original_headers.get(), &override_headers);
+  EXPECT_FALSE(override_headers);
+}
+
+TEST_F(BraveNetworkDelegateBaseTest, ChangesAreAppliedTogether) {
+  scoped_refptr<HttpResponseHeaders> original_headers(
+      new HttpResponseHeaders(net::HttpUtil::AssembleRawHeaders(kRawHeaders)));
+  scoped_refptr<HttpResponseHeaders> override_headers;
+
+  ResponseHeaderChanges changes;
+  changes.ReplaceStatusLine("HTTP/1.1 307 Temporary Redirect");
+  changes.RemoveHeader(kAcceptLanguageHeader);
+  changes.RemoveHeader("Location");
+  changes.AddHeader("Location", "https://example.com/");
+  changes.Apply(original_headers.get(), &override_headers);
+
+  ASSERT_TRUE(override_headers);
+  EXPECT_EQ("HTTP/1.1 307 Temporary Redirect",
+            override_headers->GetStatusLine());
+  EXPECT_FALSE(override_headers->HasHeader(kAcceptLanguageHeader));
+  EXPECT_TRUE(override_headers->HasHeader(kXSSProtectionHeader));
+  std::string location;
+  EXPECT_TRUE(override_headers->EnumerateHeader(nullptr, "Location",
+                                                &location));
+  EXPECT_EQ("https://example.com/", location);
+  // The original headers are left alone.
+  EXPECT_TRUE(original_headers->HasHeader(kAcceptLanguageHeader));
+}
+
+#if BUILDFLAG(USE_ALLOCATOR_SHIM)
+TEST_F(BraveNetworkDelegateBaseTest,
+       RemoveTrackableSecurityHeadersAllocatesLess) {
+  GURL request_url(kThirdPartyDomain);
+  GURL tab_url(kFirstPartyDomain);
+
+  // A CDN-style response with a long Content-Security-Policy.
+  std::string raw_headers = kRawHeaders;
+  raw_headers += "\nContent-Security-Policy: default-src 'self'";
+  for (int i = 0; i < 100; ++i)
+    raw_headers += " https://cdn" + std::to_string(i) + ".example.com";
+  for (int i = 0; i < 20; ++i)
+    raw_headers += "\nX-Custom-" + std::to_string(i) + ": value";
+  scoped_refptr<HttpResponseHeaders> original_headers(
+      new HttpResponseHeaders(net::HttpUtil::AssembleRawHeaders(raw_headers)));
+
+  // Copying the headers and removing them one by one, as was done before.
+  size_t per_header_allocations;
+  {
+    scoped_refptr<HttpResponseHeaders> override_headers;
+    ScopedAllocationCounter counter;
+    override_headers =
+        new HttpResponseHeaders(original_headers->raw_headers());
+    for (auto header : *TrackableSecurityHeaders())
+      override_headers->RemoveHeader(header.as_string());
+    per_header_allocations = counter.count();
+  }
+
+  size_t batched_allocations;
+  scoped_refptr<HttpResponseHeaders> override_headers;
+  {
+    ResponseHeaderChanges changes;
+    ScopedAllocationCounter counter;
+    RemoveTrackableSecurityHeadersForThirdParty(
+        request_url, url::Origin::Create(tab_url), &changes);
+    changes.Apply(original_headers.get(), &override_headers);
+    batched_allocations = counter.count();
+  }
+
+  ASSERT_TRUE(override_headers);
+  for (auto header : *TrackableSecurityHeaders())
+    EXPECT_FALSE(override_headers->HasHeader(header.as_string()));
+  EXPECT_TRUE(override_headers->HasHeader("Content-Security-Policy"));
+  EXPECT_TRUE(override_headers->HasHeader("X-Custom-19"));
+  EXPECT_LT(batched_allocations, per_header_allocations);
+}
+#endif  // BUILDFLAG(USE_ALLOCATOR_SHIM)
+
 }  // namespace
@@ -14,7 +14,6 @@
 #include "base/task/post_task.h"
 #include "brave/browser/net/brave_request_handler.h"
 #include "brave/components/brave_shields/browser/adblock_stub_response.h"
-#include "content/public/browser/browser_context.h"
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/render_frame_host.h"
@@ -94,7 +93,7 @@ BraveProxyingURLLoaderFactory::InProgressRequest::InProgressRequest(
     int frame_tree_node_id,
     uint32_t options,
     const network::ResourceRequest& request,
-    content::BrowserContext* browser_context,
+    scoped_refptr<const brave::RequestContextSnapshot> context_snapshot,
     const net::MutableNetworkTrafficAnnotationTag& traffic_annotation,
     mojo::PendingReceiver<network::mojom::URLLoader> loader_receiver,
     mojo::PendingRemote<network::mojom::URLLoaderClient> client)
@@ -106,7 +105,7 @@ BraveProxyingURLLoaderFactory::InProgressRequest::InProgressRequest(
       frame_tree_node_id_(frame_tree_node_id),
       routing_id_(routing_id),
       options_(options),
-      browser_context_(browser_context),
+      context_snapshot_(std::move(context_snapshot)),
       traffic_annotation_(traffic_annotation),
       proxied_loader_receiver_(this, std::move(loader_receiver)),
       target_client_(std::move(client)),
@@ -143,11 +142,9 @@ void BraveProxyingURLLoaderFactory::InProgressRequest::RestartInternal() {
       base::BindRepeating(&InProgressRequest::ContinueToBeforeSendHeaders,
                           weak_factory_.GetWeakPtr());
   redirect_url_ = GURL();
-  std::shared_ptr<brave::BraveRequestInfo> old_ctx = ctx_;
-  ctx_ = std::make_shared<brave::BraveRequestInfo>();
-  brave::BraveRequestInfo::FillCTX(request_, render_process_id_,
-                                   frame_tree_node_id_, request_id_,
-                                   browser_context_, old_ctx, ctx_);
+  ctx_ = brave::BraveRequestInfo::MakeCTX(
+      request_, render_process_id_, frame_tree_node_id_, request_id_,
+      context_snapshot_, ctx_);
   int result = factory_->request_handler_->OnBeforeURLRequest(
       ctx_, continuation, &redirect_url_);
 
@@ -409,11 +406,9 @@ void BraveProxyingURLLoaderFactory::InProgressRequest::
     auto continuation = base::BindRepeating(
         &InProgressRequest::ContinueToSendHeaders, weak_factory_.GetWeakPtr());
 
-    std::shared_ptr<brave::BraveRequestInfo> old_ctx = ctx_;
-    ctx_ = std::make_shared<brave::BraveRequestInfo>();
-    brave::BraveRequestInfo::FillCTX(request_, render_process_id_,
-                                     frame_tree_node_id_, request_id_,
-                                     browser_context_, old_ctx, ctx_);
+    ctx_ = brave::BraveRequestInfo::MakeCTX(
+        request_, render_process_id_, frame_tree_node_id_, request_id_,
+        context_snapshot_, ctx_);
     int result = factory_->request_handler_->OnBeforeStartTransaction(
         ctx_, continuation, &request_.headers);
 
@@ -471,19 +466,17 @@ void BraveProxyingURLLoaderFactory::InProgressRequest::ContinueToSendHeaders(
     OnRequestError(network::URLLoaderCompletionStatus(error_code));
     return;
   }
-  const std::set<std::string>& removed_headers = ctx_->removed_headers;
-  const std::set<std::string>& set_headers = ctx_->set_headers;
-
   if (pending_follow_redirect_params_) {
-    pending_follow_redirect_params_->removed_headers.insert(
-        pending_follow_redirect_params_->removed_headers.end(),
-        removed_headers.begin(), removed_headers.end());
+    for (const std::string* removed_header : ctx_->removed_headers) {
+      pending_follow_redirect_params_->removed_headers.push_back(
+          *removed_header);
+    }
 
-    for (auto& set_header : set_headers) {
+    for (const std::string* set_header : ctx_->set_headers) {
       std::string header_value;
-      if (request_.headers.GetHeader(set_header, &header_value)) {
+      if (request_.headers.GetHeader(*set_header, &header_value)) {
         pending_follow_redirect_params_->modified_headers.SetHeader(
-            set_header, header_value);
+            *set_header, header_value);
       } else {
         NOTREACHED();
       }
@@ -593,11 +586,9 @@ void BraveProxyingURLLoaderFactory::InProgressRequest::
   net::CompletionRepeatingCallback copyable_callback =
       base::AdaptCallbackForRepeating(std::move(continuation));
   if (request_.url.SchemeIsHTTPOrHTTPS()) {
-    std::shared_ptr<brave::BraveRequestInfo> old_ctx = ctx_;
-    ctx_ = std::make_shared<brave::BraveRequestInfo>();
-    brave::BraveRequestInfo::FillCTX(request_, render_process_id_,
-                                     frame_tree_node_id_, request_id_,
-                                     browser_context_, old_ctx, ctx_);
+    ctx_ = brave::BraveRequestInfo::MakeCTX(
+        request_, render_process_id_, frame_tree_node_id_, request_id_,
+        context_snapshot_, ctx_);
     int result = factory_->request_handler_->OnHeadersReceived(
         ctx_, copyable_callback, current_response_->headers.get(),
         &override_headers_, &redirect_url_);
@@ -635,7 +626,7 @@ void BraveProxyingURLLoaderFactory::InProgressRequest::OnRequestError(
 
 BraveProxyingURLLoaderFactory::BraveProxyingURLLoaderFactory(
     BraveRequestHandler* request_handler,
-    content::BrowserContext* browser_context,
+    scoped_refptr<const brave::RequestContextSnapshot> context_snapshot,
     int render_process_id,
     int frame_tree_node_id,
     mojo::PendingReceiver<network::mojom::URLLoaderFactory> receiver,
@@ -643,13 +634,12 @@ BraveProxyingURLLoaderFactory::BraveProxyingURLLoaderFactory(
     scoped_refptr<RequestIDGenerator> request_id_generator,
     DisconnectCallback on_disconnect)
     : request_handler_(request_handler),
-      browser_context_(browser_context),
+      context_snapshot_(std::move(context_snapshot)),
       render_process_id_(render_process_id),
       frame_tree_node_id_(frame_tree_node_id),
       request_id_generator_(request_id_generator),
       disconnect_callback_(std::move(on_disconnect)),
       weak_factory_(this) {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   DCHECK(proxy_receivers_.empty());
   DCHECK(!target_factory_.is_bound());
 
@@ -692,7 +682,7 @@ void BraveProxyingURLLoaderFactory::CreateLoaderAndStart(
     const network::ResourceRequest& request,
     mojo::PendingRemote<network::mojom::URLLoaderClient> client,
     const net::MutableNetworkTrafficAnnotationTag& traffic_annotation) {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
   // The request ID doesn't really matter in the Network Service path. It just
   // needs to be unique per-BrowserContext so request handlers can make sense of
@@ -702,7 +692,7 @@ void BraveProxyingURLLoaderFactory::CreateLoaderAndStart(
 
   auto result = requests_.emplace(std::make_unique<InProgressRequest>(
       this, brave_request_id, request_id, routing_id, render_process_id_,
-      frame_tree_node_id_, options, request, browser_context_,
+      frame_tree_node_id_, options, request, context_snapshot_,
       traffic_annotation, std::move(loader_receiver), std::move(client)));
   (*result.first)->Restart();
 }
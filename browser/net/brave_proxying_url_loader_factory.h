@@ -20,7 +20,9 @@
 #include "base/memory/ref_counted_delete_on_sequence.h"
 #include "base/memory/weak_ptr.h"
 #include "base/optional.h"
+#include "base/sequence_checker.h"
 #include "base/time/time.h"
+#include "brave/browser/net/request_context_snapshot.h"
 #include "brave/browser/net/resource_context_data.h"
 #include "brave/browser/net/url_context.h"
 #include "mojo/public/cpp/bindings/binding.h"
@@ -60,7 +62,7 @@ class BraveProxyingURLLoaderFactory
         int32_t routing_id,
         uint32_t options,
         const network::ResourceRequest& request,
-        content::BrowserContext* browser_context,
+        scoped_refptr<const brave::RequestContextSnapshot> context_snapshot,
         const net::MutableNetworkTrafficAnnotationTag& traffic_annotation,
         mojo::PendingReceiver<network::mojom::URLLoader> loader_receiver,
         mojo::PendingRemote<network::mojom::URLLoaderClient> client);
@@ -124,7 +126,7 @@ class BraveProxyingURLLoaderFactory
     const int32_t routing_id_;
     const uint32_t options_;
 
-    content::BrowserContext* browser_context_;
+    const scoped_refptr<const brave::RequestContextSnapshot> context_snapshot_;
     const net::MutableNetworkTrafficAnnotationTag traffic_annotation_;
 
     // This is our proxy's receiver that will talk to the original client. It
@@ -172,10 +174,12 @@ class BraveProxyingURLLoaderFactory
   };
 
   // Constructor public for testing purposes. New instances should be created
-  // by calling MaybeProxyRequest().
+  // by calling MaybeProxyRequest(). The factory is bound to the sequence it is
+  // created on, which is the UI thread unless requests are handled off it
+  // (see ResourceContextData).
   BraveProxyingURLLoaderFactory(
       BraveRequestHandler* request_handler,
-      content::BrowserContext* browser_context,
+      scoped_refptr<const brave::RequestContextSnapshot> context_snapshot,
       int render_process_id,
       int frame_tree_node_id,
       mojo::PendingReceiver<network::mojom::URLLoaderFactory> receiver,
@@ -216,7 +220,7 @@ class BraveProxyingURLLoaderFactory
   void MaybeRemoveProxy();
 
   BraveRequestHandler* const request_handler_;
-  content::BrowserContext* browser_context_;
+  const scoped_refptr<const brave::RequestContextSnapshot> context_snapshot_;
   const int render_process_id_;
   const int frame_tree_node_id_;
 
@@ -230,6 +234,8 @@ class BraveProxyingURLLoaderFactory
 
   DisconnectCallback disconnect_callback_;
 
+  SEQUENCE_CHECKER(sequence_checker_);
+
   base::WeakPtrFactory<BraveProxyingURLLoaderFactory> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(BraveProxyingURLLoaderFactory);
@@ -28,7 +28,7 @@ BraveProxyingWebSocket::BraveProxyingWebSocket(
         handshake_client,
     int process_id,
     int frame_tree_node_id,
-    content::BrowserContext* browser_context,
+    scoped_refptr<const brave::RequestContextSnapshot> context_snapshot,
     scoped_refptr<RequestIDGenerator> request_id_generator,
     BraveRequestHandler* handler,
     DisconnectCallback on_disconnect)
@@ -36,7 +36,7 @@ BraveProxyingWebSocket::BraveProxyingWebSocket(
       process_id_(process_id),
       frame_tree_node_id_(frame_tree_node_id),
       factory_(std::move(factory)),
-      browser_context_(browser_context),
+      context_snapshot_(std::move(context_snapshot)),
       request_id_generator_(std::move(request_id_generator)),
       forwarding_handshake_client_(std::move(handshake_client)),
       receiver_as_handshake_client_(this),
@@ -85,11 +85,9 @@ void BraveProxyingWebSocket::Start() {
         weak_factory_.GetWeakPtr());
   }
 
-  std::shared_ptr<brave::BraveRequestInfo> old_ctx = ctx_;
-  ctx_ = std::make_shared<brave::BraveRequestInfo>();
-  brave::BraveRequestInfo::FillCTX(request_, process_id_,
-                                   frame_tree_node_id_, request_id_,
-                                   browser_context_, old_ctx, ctx_);
+  ctx_ = brave::BraveRequestInfo::MakeCTX(
+      request_, process_id_, frame_tree_node_id_, request_id_,
+      context_snapshot_, ctx_);
   int result = request_handler_->OnBeforeURLRequest(
       ctx_, continuation, &redirect_url_);
   // TODO(bridiver) - need to handle general case for redirect_url
@@ -157,11 +155,9 @@ void BraveProxyingWebSocket::ContinueToHeadersReceived() {
   auto continuation = base::BindRepeating(
       &BraveProxyingWebSocket::OnHeadersReceivedComplete,
       weak_factory_.GetWeakPtr());
-  std::shared_ptr<brave::BraveRequestInfo> old_ctx = ctx_;
-  ctx_ = std::make_shared<brave::BraveRequestInfo>();
-  brave::BraveRequestInfo::FillCTX(request_, process_id_,
-                                   frame_tree_node_id_, request_id_,
-                                   browser_context_, old_ctx, ctx_);
+  ctx_ = brave::BraveRequestInfo::MakeCTX(
+      request_, process_id_, frame_tree_node_id_, request_id_,
+      context_snapshot_, ctx_);
   int result = request_handler_->OnHeadersReceived(
       ctx_, continuation, response_.headers.get(),
       &override_headers_, &redirect_url_);
@@ -269,11 +265,9 @@ void BraveProxyingWebSocket::OnBeforeSendHeadersCompleteFromProxy(
       &BraveProxyingWebSocket::OnBeforeSendHeadersComplete,
       weak_factory_.GetWeakPtr());
 
-  std::shared_ptr<brave::BraveRequestInfo> old_ctx = ctx_;
-  ctx_ = std::make_shared<brave::BraveRequestInfo>();
-  brave::BraveRequestInfo::FillCTX(request_, process_id_,
-                                   frame_tree_node_id_, request_id_,
-                                   browser_context_, old_ctx, ctx_);
+  ctx_ = brave::BraveRequestInfo::MakeCTX(
+      request_, process_id_, frame_tree_node_id_, request_id_,
+      context_snapshot_, ctx_);
   int result = request_handler_->OnBeforeStartTransaction(
       ctx_, continuation, &request_.headers);
 
@@ -15,6 +15,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "base/optional.h"
+#include "brave/browser/net/request_context_snapshot.h"
 #include "brave/browser/net/resource_context_data.h"
 #include "brave/browser/net/url_context.h"
 #include "content/public/browser/content_browser_client.h"
@@ -31,7 +32,6 @@
 #include "url/origin.h"
 
 namespace content {
-class BrowserContext;
 class RenderFrameHost;
 }
 
@@ -52,7 +52,7 @@ class BraveProxyingWebSocket : public network::mojom::WebSocketHandshakeClient,
           handshake_client,
       int process_id,
       int frame_tree_node_id,
-      content::BrowserContext* browser_context,
+      scoped_refptr<const brave::RequestContextSnapshot> context_snapshot,
       scoped_refptr<RequestIDGenerator> request_id_generator,
       BraveRequestHandler* handler,
       DisconnectCallback on_disconnect);
@@ -133,7 +133,7 @@ class BraveProxyingWebSocket : public network::mojom::WebSocketHandshakeClient,
   const int process_id_;
   const int frame_tree_node_id_;
   content::ContentBrowserClient::WebSocketFactory factory_;
-  content::BrowserContext* const browser_context_;
+  const scoped_refptr<const brave::RequestContextSnapshot> context_snapshot_;
   scoped_refptr<RequestIDGenerator> request_id_generator_;
   mojo::Remote<network::mojom::WebSocketHandshakeClient>
       forwarding_handshake_client_;
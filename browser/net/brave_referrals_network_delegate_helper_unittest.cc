@@ -11,6 +11,8 @@
 #include "base/json/json_reader.h"
 #include "brave/browser/net/url_context.h"
 #include "brave/common/network_constants.h"
+#include "brave/components/brave_referrals/browser/brave_referrals_service.h"
+#include "brave/components/brave_referrals/browser/referral_header_index.h"
 #include "net/base/net_errors.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "url/gurl.h"
@@ -62,9 +64,12 @@ TEST(BraveReferralsNetworkDelegateHelperTest, ReplaceHeadersForMatchingDomain) {
   const base::ListValue* referral_headers_list = nullptr;
   referral_headers.value->GetAsList(&referral_headers_list);
 
+  auto referral_header_index =
+      base::MakeRefCounted<brave::ReferralHeaderIndex>(*referral_headers_list);
+
   net::HttpRequestHeaders headers;
   auto request_info = std::make_shared<brave::BraveRequestInfo>(url);
-  request_info->referral_headers_list = referral_headers_list;
+  request_info->referral_header_index = referral_header_index.get();
 
   int rc = brave::OnBeforeStartTransaction_ReferralsWork(
       &headers, brave::ResponseCallback(), request_info);
@@ -91,12 +96,65 @@ TEST(BraveReferralsNetworkDelegateHelperTest,
   const base::ListValue* referral_headers_list = nullptr;
   referral_headers.value->GetAsList(&referral_headers_list);
 
+  auto referral_header_index =
+      base::MakeRefCounted<brave::ReferralHeaderIndex>(*referral_headers_list);
+
   net::HttpRequestHeaders headers;
   auto request_info = std::make_shared<brave::BraveRequestInfo>(GURL());
-  request_info->referral_headers_list = referral_headers_list;
+  request_info->referral_header_index = referral_header_index.get();
   int rc = brave::OnBeforeStartTransaction_ReferralsWork(
       &headers, brave::ResponseCallback(), request_info);
 
   EXPECT_FALSE(headers.HasHeader("X-Brave-Partner"));
   EXPECT_EQ(rc, net::OK);
 }
+
+TEST(BraveReferralsNetworkDelegateHelperTest, IndexMatchesReferralHeadersList) {
+  base::JSONReader::ValueWithError referral_headers =
+      base::JSONReader::ReadAndReturnValueWithError(R"(
+    [
+      { "domains": ["marketwatch.com"], "headers": {"X-Brave-Partner": "a"} },
+      { "domains": ["www.marketwatch.com", "barrons.com", "127.0.0.1"],
+        "headers": {"X-Brave-Partner": "b"} },
+      { "headers": {"X-Brave-Partner": "no domains"} },
+      { "domains": ["xxlmag.com"], "headers": "not a dictionary" },
+      { "domains": ["xxlmag.com"], "headers": {"X-Brave-Partner": "c"} },
+      { "domains": ["popcrush.com", "0.1"],
+        "headers": {"X-Brave-Partner": "d"} }
+    ])");
+  ASSERT_TRUE(referral_headers.value);
+  const base::ListValue* referral_headers_list = nullptr;
+  ASSERT_TRUE(referral_headers.value->GetAsList(&referral_headers_list));
+  auto referral_header_index =
+      base::MakeRefCounted<brave::ReferralHeaderIndex>(*referral_headers_list);
+
+  const char* urls[] = {
+      "https://marketwatch.com/",
+      "http://www.marketwatch.com/path?query",
+      "https://a.b.marketwatch.com/",
+      "https://notmarketwatch.com/",
+      "https://marketwatch.com.evil.com/",
+      "ftp://marketwatch.com/",
+      "https://barrons.com:8080/",
+      "https://127.0.0.1/",
+      "https://10.0.0.1/",
+      "https://xxlmag.com/",
+      "https://www.xxlmag.com/",
+      "https://popcrush.com/",
+      "https://google.com/",
+      "invalid",
+  };
+  for (const char* spec : urls) {
+    const GURL url(spec);
+    const base::DictionaryValue* expected = nullptr;
+    brave::BraveReferralsService::GetMatchingReferralHeaders(
+        *referral_headers_list, &expected, url);
+    const base::Value* headers = referral_header_index->FindHeaders(url);
+    if (!expected) {
+      EXPECT_FALSE(headers) << spec;
+      continue;
+    }
+    ASSERT_TRUE(headers) << spec;
+    EXPECT_EQ(*expected, *headers) << spec;
+  }
+}
@@ -9,7 +9,7 @@
 #include <utility>
 
 #include "base/metrics/histogram_macros.h"
-#include "base/task/post_task.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "brave/browser/net/brave_ad_block_tp_network_delegate_helper.h"
 #include "brave/browser/net/brave_common_static_redirect_network_delegate_helper.h"
 #include "brave/browser/net/brave_httpse_network_delegate_helper.h"
@@ -17,16 +17,10 @@
 #include "brave/browser/net/brave_stp_util.h"
 #include "brave/browser/net/global_privacy_control_network_delegate_helper.h"
 #include "brave/browser/translate/buildflags/buildflags.h"
-#include "brave/common/pref_names.h"
 #include "brave/components/brave_referrals/buildflags/buildflags.h"
 #include "brave/components/brave_rewards/browser/buildflags/buildflags.h"
 #include "brave/components/brave_webtorrent/browser/buildflags/buildflags.h"
 #include "brave/components/ipfs/buildflags/buildflags.h"
-#include "chrome/browser/browser_process.h"
-#include "components/prefs/pref_change_registrar.h"
-#include "components/prefs/pref_service.h"
-#include "content/public/browser/browser_task_traits.h"
-#include "content/public/browser/browser_thread.h"
 #include "content/public/common/url_constants.h"
 #include "extensions/common/constants.h"
 #include "net/base/net_errors.h"
@@ -57,87 +51,114 @@ static bool IsInternalScheme(std::shared_ptr<brave::BraveRequestInfo> ctx) {
          ctx->request_url.SchemeIs(content::kChromeUIScheme);
 }
 
-BraveRequestHandler::BraveRequestHandler() {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-  SetupCallbacks();
-  // Initialize the preference change registrar.
-  InitPrefChangeRegistrar();
+namespace {
+
+int RunBeforeStartTransactionStep(
+    const brave::OnBeforeStartTransactionCallback& callback,
+    const brave::ResponseCallback& next_callback,
+    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  return callback.Run(ctx->headers, next_callback, ctx);
 }
 
-BraveRequestHandler::~BraveRequestHandler() = default;
+int RunHeadersReceivedStep(const brave::OnHeadersReceivedCallback& callback,
+                           const brave::ResponseCallback& next_callback,
+                           std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  return callback.Run(ctx->original_response_headers,
+                      ctx->override_response_headers,
+                      ctx->allowed_unsafe_redirect_url, next_callback, ctx);
+}
 
-void BraveRequestHandler::SetupCallbacks() {
-  brave::OnBeforeURLRequestCallback callback =
-      base::Bind(brave::OnBeforeURLRequest_SiteHacksWork);
-  before_url_request_callbacks_.push_back(callback);
+}  // namespace
+
+BraveRequestHandler::Step::Step(brave::BraveNetworkDelegateEventType event_type,
+                                StepMode mode,
+                                StepCallback callback)
+    : event_type(event_type), mode(mode), callback(std::move(callback)) {}
 
-  callback = base::Bind(brave::OnBeforeURLRequest_AdBlockTPPreWork);
-  before_url_request_callbacks_.push_back(callback);
+BraveRequestHandler::Step::Step(const Step& other) = default;
 
-  callback = base::Bind(brave::OnBeforeURLRequest_HttpsePreFileWork);
-  before_url_request_callbacks_.push_back(callback);
+BraveRequestHandler::Step::~Step() = default;
 
-  callback = base::Bind(brave::OnBeforeURLRequest_CommonStaticRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+BraveRequestHandler::BraveRequestHandler() {
+  SetupCallbacks();
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+BraveRequestHandler::BraveRequestHandler(std::vector<Step> steps)
+    : steps_(std::move(steps)) {
+  std::stable_sort(steps_.begin(), steps_.end(),
+                   [](const Step& a, const Step& b) {
+                     return a.event_type < b.event_type;
+                   });
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+BraveRequestHandler::~BraveRequestHandler() = default;
 
+void BraveRequestHandler::SetupCallbacks() {
+  // Steps are run in the order they are added here, grouped by event type.
+  AddStep(StepMode::kSync,
+          base::BindRepeating(brave::OnBeforeURLRequest_SiteHacksWork));
+  AddStep(StepMode::kMayBlock,
+          base::BindRepeating(brave::OnBeforeURLRequest_AdBlockTPPreWork));
+  AddStep(StepMode::kMayBlock,
+          base::BindRepeating(brave::OnBeforeURLRequest_HttpsePreFileWork));
+  AddStep(
+      StepMode::kSync,
+      base::BindRepeating(brave::OnBeforeURLRequest_CommonStaticRedirectWork));
 #if BUILDFLAG(BRAVE_REWARDS_ENABLED)
-  callback = base::Bind(brave_rewards::OnBeforeURLRequest);
-  before_url_request_callbacks_.push_back(callback);
+  AddStep(StepMode::kSync,
+          base::BindRepeating(brave_rewards::OnBeforeURLRequest));
 #endif
-
 #if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
-  callback =
-      base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddStep(StepMode::kSync,
+          base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork));
 #endif
-
 #if BUILDFLAG(IPFS_ENABLED)
-  callback = base::BindRepeating(ipfs::OnBeforeURLRequest_IPFSRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddStep(StepMode::kSync,
+          base::BindRepeating(ipfs::OnBeforeURLRequest_IPFSRedirectWork));
 #endif
 
-  brave::OnBeforeStartTransactionCallback start_transaction_callback =
-      base::Bind(brave::OnBeforeStartTransaction_SiteHacksWork);
-  before_start_transaction_callbacks_.push_back(start_transaction_callback);
-
-  start_transaction_callback =
-      base::Bind(brave::OnBeforeStartTransaction_GlobalPrivacyControlWork);
-  before_start_transaction_callbacks_.push_back(start_transaction_callback);
-
+  AddStep(StepMode::kSync,
+          base::BindRepeating(brave::OnBeforeStartTransaction_SiteHacksWork));
+  AddStep(StepMode::kSync,
+          base::BindRepeating(
+              brave::OnBeforeStartTransaction_GlobalPrivacyControlWork));
 #if BUILDFLAG(ENABLE_BRAVE_REFERRALS)
-  start_transaction_callback =
-      base::Bind(brave::OnBeforeStartTransaction_ReferralsWork);
-  before_start_transaction_callbacks_.push_back(start_transaction_callback);
+  AddStep(StepMode::kSync,
+          base::BindRepeating(brave::OnBeforeStartTransaction_ReferralsWork));
 #endif
 
 #if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
-  brave::OnHeadersReceivedCallback headers_received_callback =
-      base::Bind(webtorrent::OnHeadersReceived_TorrentRedirectWork);
-  headers_received_callbacks_.push_back(headers_received_callback);
+  AddStep(
+      StepMode::kSync,
+      base::BindRepeating(webtorrent::OnHeadersReceived_TorrentRedirectWork));
 #endif
+
+  std::stable_sort(steps_.begin(), steps_.end(),
+                   [](const Step& a, const Step& b) {
+                     return a.event_type < b.event_type;
+                   });
 }
 
-void BraveRequestHandler::InitPrefChangeRegistrar() {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-#if BUILDFLAG(ENABLE_BRAVE_REFERRALS)
-  PrefService* prefs = g_browser_process->local_state();
-  pref_change_registrar_.reset(new PrefChangeRegistrar());
-  pref_change_registrar_->Init(prefs);
-  pref_change_registrar_->Add(
-      kReferralHeaders,
-      base::Bind(&BraveRequestHandler::OnReferralHeadersChanged,
-                 base::Unretained(this)));
-  // Retrieve current referral headers, if any.
-  OnReferralHeadersChanged();
-#endif
+void BraveRequestHandler::AddStep(StepMode mode,
+                                  brave::OnBeforeURLRequestCallback callback) {
+  steps_.emplace_back(brave::kOnBeforeRequest, mode, std::move(callback));
 }
 
-void BraveRequestHandler::OnReferralHeadersChanged() {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-  if (const base::ListValue* referral_headers =
-          g_browser_process->local_state()->GetList(kReferralHeaders)) {
-    referral_headers_list_.reset(referral_headers->DeepCopy());
-  }
+void BraveRequestHandler::AddStep(
+    StepMode mode,
+    brave::OnBeforeStartTransactionCallback callback) {
+  steps_.emplace_back(
+      brave::kOnBeforeStartTransaction, mode,
+      base::BindRepeating(&RunBeforeStartTransactionStep, std::move(callback)));
+}
+
+void BraveRequestHandler::AddStep(StepMode mode,
+                                  brave::OnHeadersReceivedCallback callback) {
+  steps_.emplace_back(
+      brave::kOnHeadersReceived, mode,
+      base::BindRepeating(&RunHeadersReceivedStep, std::move(callback)));
 }
 
 bool BraveRequestHandler::IsRequestIdentifierValid(
@@ -145,34 +166,36 @@ bool BraveRequestHandler::IsRequestIdentifierValid(
   return base::Contains(callbacks_, request_identifier);
 }
 
+bool BraveRequestHandler::HasSteps(
+    brave::BraveNetworkDelegateEventType event_type) const {
+  return std::any_of(
+      steps_.begin(), steps_.end(),
+      [event_type](const Step& step) { return step.event_type == event_type; });
+}
+
 int BraveRequestHandler::OnBeforeURLRequest(
     std::shared_ptr<brave::BraveRequestInfo> ctx,
     net::CompletionOnceCallback callback,
     GURL* new_url) {
-  if (before_url_request_callbacks_.empty() || IsInternalScheme(ctx)) {
+  if (!HasSteps(brave::kOnBeforeRequest) || IsInternalScheme(ctx)) {
     return net::OK;
   }
   SCOPED_UMA_HISTOGRAM_TIMER("Brave.OnBeforeURLRequest_Handler");
   ctx->new_url = new_url;
   ctx->event_type = brave::kOnBeforeRequest;
-  callbacks_[ctx->request_identifier] = std::move(callback);
-  RunNextCallback(ctx);
-  return net::ERR_IO_PENDING;
+  return StartSteps(ctx, std::move(callback));
 }
 
 int BraveRequestHandler::OnBeforeStartTransaction(
     std::shared_ptr<brave::BraveRequestInfo> ctx,
     net::CompletionOnceCallback callback,
     net::HttpRequestHeaders* headers) {
-  if (before_start_transaction_callbacks_.empty() || IsInternalScheme(ctx)) {
+  if (!HasSteps(brave::kOnBeforeStartTransaction) || IsInternalScheme(ctx)) {
     return net::OK;
   }
   ctx->event_type = brave::kOnBeforeStartTransaction;
   ctx->headers = headers;
-  ctx->referral_headers_list = referral_headers_list_.get();
-  callbacks_[ctx->request_identifier] = std::move(callback);
-  RunNextCallback(ctx);
-  return net::ERR_IO_PENDING;
+  return StartSteps(ctx, std::move(callback));
 }
 
 int BraveRequestHandler::OnHeadersReceived(
@@ -181,33 +204,31 @@ int BraveRequestHandler::OnHeadersReceived(
     const net::HttpResponseHeaders* original_response_headers,
     scoped_refptr<net::HttpResponseHeaders>* override_response_headers,
     GURL* allowed_unsafe_redirect_url) {
-  if (!ctx->tab_origin.is_empty()) {
+  if (!ctx->tab_origin().is_empty()) {
     brave::RemoveTrackableSecurityHeadersForThirdParty(
-        ctx->request_url, url::Origin::Create(ctx->tab_origin),
-        original_response_headers, override_response_headers);
+        ctx->request_url, url::Origin::Create(ctx->tab_origin()),
+        &ctx->response_header_changes);
   }
 
-  if (headers_received_callbacks_.empty() &&
+  if (!HasSteps(brave::kOnHeadersReceived) &&
       !ctx->request_url.SchemeIs(content::kChromeUIScheme)) {
     // Extension scheme not excluded since brave_webtorrent needs it.
+    ctx->response_header_changes.Apply(original_response_headers,
+                                       override_response_headers);
     return net::OK;
   }
 
-  callbacks_[ctx->request_identifier] = std::move(callback);
   ctx->event_type = brave::kOnHeadersReceived;
   ctx->original_response_headers = original_response_headers;
   ctx->override_response_headers = override_response_headers;
   ctx->allowed_unsafe_redirect_url = allowed_unsafe_redirect_url;
 
-  RunNextCallback(ctx);
-  return net::ERR_IO_PENDING;
+  return StartSteps(ctx, std::move(callback));
 }
 
 void BraveRequestHandler::OnURLRequestDestroyed(
     std::shared_ptr<brave::BraveRequestInfo> ctx) {
-  if (base::Contains(callbacks_, ctx->request_identifier)) {
-    callbacks_.erase(ctx->request_identifier);
-  }
+  callbacks_.erase(ctx->request_identifier);
 }
 
 void BraveRequestHandler::RunCallbackForRequestIdentifier(
@@ -217,92 +238,108 @@ void BraveRequestHandler::RunCallbackForRequestIdentifier(
       callbacks_.find(request_identifier);
   // We intentionally do the async call to maintain the proper flow
   // of URLLoader callbacks.
-  base::PostTask(FROM_HERE, {content::BrowserThread::UI},
-                 base::BindOnce(std::move(it->second), rv));
+  base::SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(std::move(it->second), rv));
+  callbacks_.erase(it);
 }
 
-// TODO(iefremov): Merge all callback containers into one and run only one loop
-// instead of many (issues/5574).
-void BraveRequestHandler::RunNextCallback(
-    std::shared_ptr<brave::BraveRequestInfo> ctx) {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-
-  if (!base::Contains(callbacks_, ctx->request_identifier)) {
-    return;
+int BraveRequestHandler::StartSteps(
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    net::CompletionOnceCallback callback) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  ctx->next_url_request_index =
+      std::find_if(steps_.begin(), steps_.end(),
+                   [&ctx](const Step& step) {
+                     return step.event_type == ctx->event_type;
+                   }) -
+      steps_.begin();
+
+  int rv = RunSteps(ctx, &callback);
+  if (rv == net::ERR_IO_PENDING)
+    return rv;
+
+  if (!callback) {
+    // A step that may block completed synchronously after all.
+    auto it = callbacks_.find(ctx->request_identifier);
+    DCHECK(it != callbacks_.end());
+    callback = std::move(it->second);
+    callbacks_.erase(it);
   }
 
-  // Continue processing callbacks until we hit one that returns PENDING
-  int rv = net::OK;
+  rv = FinishSteps(ctx, rv);
+  if (rv == net::OK)
+    return rv;
+  // Callers only continue synchronously on success, errors are reported
+  // through |callback| as before.
+  base::SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(std::move(callback), rv));
+  return net::ERR_IO_PENDING;
+}
 
-  if (ctx->event_type == brave::kOnBeforeRequest) {
-    while (before_url_request_callbacks_.size() !=
-           ctx->next_url_request_index) {
-      brave::OnBeforeURLRequestCallback callback =
-          before_url_request_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback =
-          base::Bind(&BraveRequestHandler::RunNextCallback,
-                     weak_factory_.GetWeakPtr(), ctx);
-      rv = callback.Run(next_callback, ctx);
-      if (rv == net::ERR_IO_PENDING) {
-        return;
-      }
-      if (rv != net::OK) {
-        break;
-      }
+int BraveRequestHandler::RunSteps(
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    net::CompletionOnceCallback* callback) {
+  int rv = net::OK;
+  while (ctx->next_url_request_index < steps_.size()) {
+    const Step& step = steps_[ctx->next_url_request_index];
+    if (step.event_type != ctx->event_type)
+      break;
+    ctx->next_url_request_index++;
+
+    brave::ResponseCallback next_callback;
+    if (step.mode == StepMode::kMayBlock) {
+      if (callback && *callback)
+        callbacks_[ctx->request_identifier] = std::move(*callback);
+      next_callback = base::Bind(&BraveRequestHandler::RunNextCallback,
+                                 weak_factory_.GetWeakPtr(), ctx);
     }
-  } else if (ctx->event_type == brave::kOnBeforeStartTransaction) {
-    while (before_start_transaction_callbacks_.size() !=
-           ctx->next_url_request_index) {
-      brave::OnBeforeStartTransactionCallback callback =
-          before_start_transaction_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback =
-          base::Bind(&BraveRequestHandler::RunNextCallback,
-                     weak_factory_.GetWeakPtr(), ctx);
-      rv = callback.Run(ctx->headers, next_callback, ctx);
-      if (rv == net::ERR_IO_PENDING) {
-        return;
-      }
-      if (rv != net::OK) {
-        break;
-      }
+    rv = step.callback.Run(next_callback, ctx);
+    if (rv == net::ERR_IO_PENDING) {
+      DCHECK(step.mode == StepMode::kMayBlock);
+      return rv;
     }
-  } else if (ctx->event_type == brave::kOnHeadersReceived) {
-    while (headers_received_callbacks_.size() != ctx->next_url_request_index) {
-      brave::OnHeadersReceivedCallback callback =
-          headers_received_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback =
-          base::Bind(&BraveRequestHandler::RunNextCallback,
-                     weak_factory_.GetWeakPtr(), ctx);
-      rv = callback.Run(ctx->original_response_headers,
-                        ctx->override_response_headers,
-                        ctx->allowed_unsafe_redirect_url, next_callback, ctx);
-      if (rv == net::ERR_IO_PENDING) {
-        return;
-      }
-      if (rv != net::OK) {
-        break;
-      }
+    if (rv != net::OK) {
+      break;
     }
   }
+  return rv;
+}
+
+void BraveRequestHandler::RunNextCallback(
+    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
-  if (rv != net::OK) {
-    RunCallbackForRequestIdentifier(ctx->request_identifier, rv);
+  if (!base::Contains(callbacks_, ctx->request_identifier)) {
     return;
   }
 
+  // Continue processing callbacks until we hit one that returns PENDING
+  int rv = RunSteps(ctx, nullptr);
+  if (rv == net::ERR_IO_PENDING) {
+    return;
+  }
+  RunCallbackForRequestIdentifier(ctx->request_identifier,
+                                  FinishSteps(ctx, rv));
+}
+
+int BraveRequestHandler::FinishSteps(
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    int rv) {
+  if (rv != net::OK)
+    return rv;
+
   if (ctx->event_type == brave::kOnBeforeRequest) {
     if (!ctx->new_url_spec.empty() &&
-        (ctx->new_url_spec != ctx->request_url.spec()) &&
-        IsRequestIdentifierValid(ctx->request_identifier)) {
+        (ctx->new_url_spec != ctx->request_url.spec())) {
       *ctx->new_url = GURL(ctx->new_url_spec);
     }
-    if (ctx->blocked_by == brave::kAdBlocked) {
-      if (ctx->cancel_request_explicitly) {
-        RunCallbackForRequestIdentifier(ctx->request_identifier,
-                                        net::ERR_ABORTED);
-        return;
-      }
+    if (ctx->blocked_by == brave::kAdBlocked &&
+        ctx->cancel_request_explicitly) {
+      return net::ERR_ABORTED;
     }
+  } else if (ctx->event_type == brave::kOnHeadersReceived) {
+    ctx->response_header_changes.Apply(ctx->original_response_headers,
+                                       ctx->override_response_headers);
   }
-  RunCallbackForRequestIdentifier(ctx->request_identifier, rv);
+  return net::OK;
 }
@@ -11,19 +11,47 @@
 #include <string>
 #include <vector>
 
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
 #include "brave/browser/net/url_context.h"
-#include "content/public/browser/browser_thread.h"
 #include "net/base/completion_once_callback.h"
 
-class PrefChangeRegistrar;
-
 // Contains different network stack hooks (similar to capabilities of WebRequest
-// API).
+// API). Not bound to a thread: it can be created anywhere and is then used on
+// one sequence, the UI thread or the request sequence of
+// ResourceContextData. Profile state comes in with each request's
+// BraveRequestInfo.
 class BraveRequestHandler {
  public:
   using ResponseCallback = base::Callback<void(const base::DictionaryValue&)>;
 
+  // How a helper completes. kSync helpers always return their result and
+  // never run |next_callback|, so they are chained inline and get a null one.
+  // kMayBlock helpers may return net::ERR_IO_PENDING and run |next_callback|
+  // later on the handler's sequence.
+  enum class StepMode { kSync, kMayBlock };
+
+  // Helpers for every event share this signature; the event specific
+  // arguments are read from |ctx|.
+  using StepCallback = base::RepeatingCallback<int(
+      const brave::ResponseCallback& next_callback,
+      std::shared_ptr<brave::BraveRequestInfo> ctx)>;
+
+  struct Step {
+    Step(brave::BraveNetworkDelegateEventType event_type,
+         StepMode mode,
+         StepCallback callback);
+    Step(const Step& other);
+    ~Step();
+
+    brave::BraveNetworkDelegateEventType event_type;
+    StepMode mode;
+    StepCallback callback;
+  };
+
   BraveRequestHandler();
+  // Runs only |steps|. For tests.
+  explicit BraveRequestHandler(std::vector<Step> steps);
   ~BraveRequestHandler();
 
   bool IsRequestIdentifierValid(uint64_t request_identifier);
@@ -47,28 +75,34 @@ class BraveRequestHandler {
 
  private:
   void SetupCallbacks();
-  void InitPrefChangeRegistrar();
-  void OnReferralHeadersChanged();
-  void OnPreferenceChanged(const std::string& pref_name);
-  void UpdateAdBlockFromPref(const std::string& pref_name);
-
+  void AddStep(StepMode mode, brave::OnBeforeURLRequestCallback callback);
+  void AddStep(StepMode mode, brave::OnBeforeStartTransactionCallback callback);
+  void AddStep(StepMode mode, brave::OnHeadersReceivedCallback callback);
+
+  bool HasSteps(brave::BraveNetworkDelegateEventType event_type) const;
+  // Runs the steps for |ctx->event_type|. Returns the result if they all
+  // complete synchronously, which is then handed back to the caller without
+  // a task hop; otherwise returns net::ERR_IO_PENDING and |callback| runs
+  // once the steps are done.
+  int StartSteps(std::shared_ptr<brave::BraveRequestInfo> ctx,
+                 net::CompletionOnceCallback callback);
+  // Runs steps from |ctx->next_url_request_index| until one is pending or
+  // fails. Before the first step that may block, |callback| (if not null) is
+  // moved into |callbacks_|.
+  int RunSteps(std::shared_ptr<brave::BraveRequestInfo> ctx,
+               net::CompletionOnceCallback* callback);
+  // Called by steps that completed asynchronously.
   void RunNextCallback(std::shared_ptr<brave::BraveRequestInfo> ctx);
+  // Applies the outcome of the finished steps to the request.
+  int FinishSteps(std::shared_ptr<brave::BraveRequestInfo> ctx, int rv);
+
+  // All steps, grouped by event type and in order within each event.
+  std::vector<Step> steps_;
 
-  std::vector<brave::OnBeforeURLRequestCallback> before_url_request_callbacks_;
-  std::vector<brave::OnBeforeStartTransactionCallback>
-      before_start_transaction_callbacks_;
-  std::vector<brave::OnHeadersReceivedCallback> headers_received_callbacks_;
-
-  // TODO(iefremov): actually, we don't have to keep the list here, since
-  // it is global for the whole browser and could live a singletonce in the
-  // rewards service. Eliminating this will also help to avoid using
-  // PrefChangeRegistrar and corresponding |base::Unretained| usages, that are
-  // illegal.
-  std::unique_ptr<base::ListValue> referral_headers_list_;
+  // Continuations of requests waiting on a step that may block.
   std::map<uint64_t, net::CompletionOnceCallback> callbacks_;
-  std::unique_ptr<PrefChangeRegistrar, content::BrowserThread::DeleteOnUIThread>
-      pref_change_registrar_;
 
+  SEQUENCE_CHECKER(sequence_checker_);
   base::WeakPtrFactory<BraveRequestHandler> weak_factory_{this};
   DISALLOW_COPY_AND_ASSIGN(BraveRequestHandler);
 };
@@ -0,0 +1,233 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/brave_request_handler.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/optional.h"
+#include "base/run_loop.h"
+#include "base/sequenced_task_runner.h"
+#include "base/task/post_task.h"
+#include "base/test/bind_test_util.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "content/public/test/browser_task_environment.h"
+#include "net/base/net_errors.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+using Step = BraveRequestHandler::Step;
+using StepMode = BraveRequestHandler::StepMode;
+
+namespace {
+
+const char kRedirectUrl[] = "https://brave.com/";
+
+int CountStep(int* count,
+              int rv,
+              const brave::ResponseCallback& next_callback,
+              std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  ++*count;
+  return rv;
+}
+
+int RedirectStep(const brave::ResponseCallback& next_callback,
+                 std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  ctx->new_url_spec = kRedirectUrl;
+  return net::OK;
+}
+
+int BlockingStep(const brave::ResponseCallback& next_callback,
+                 std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  base::SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(next_callback));
+  return net::ERR_IO_PENDING;
+}
+
+Step MakeStep(StepMode mode, BraveRequestHandler::StepCallback callback) {
+  return Step(brave::kOnBeforeRequest, mode, std::move(callback));
+}
+
+class BraveRequestHandlerTest : public testing::Test {
+ protected:
+  std::shared_ptr<brave::BraveRequestInfo> CreateContext() {
+    auto ctx = std::make_shared<brave::BraveRequestInfo>(
+        GURL("https://example.com/"));
+    ctx->request_identifier = 1;
+    return ctx;
+  }
+
+  net::CompletionOnceCallback RecordResult() {
+    return base::BindOnce(
+        [](base::Optional<int>* result, int rv) { *result = rv; }, &result_);
+  }
+
+  size_t pending_tasks() {
+    return task_environment_.GetPendingMainThreadTaskCount();
+  }
+
+  content::BrowserTaskEnvironment task_environment_;
+  base::Optional<int> result_;
+};
+
+}  // namespace
+
+TEST_F(BraveRequestHandlerTest, SyncStepsCompleteWithoutPostingTasks) {
+  int count = 0;
+  std::vector<Step> steps;
+  steps.push_back(MakeStep(StepMode::kSync,
+                           base::BindRepeating(&CountStep, &count, net::OK)));
+  steps.push_back(
+      MakeStep(StepMode::kSync, base::BindRepeating(&RedirectStep)));
+  // A step that may block but doesn't this time.
+  steps.push_back(MakeStep(StepMode::kMayBlock,
+                           base::BindRepeating(&CountStep, &count, net::OK)));
+  BraveRequestHandler handler(std::move(steps));
+
+  GURL new_url;
+  EXPECT_EQ(net::OK,
+            handler.OnBeforeURLRequest(CreateContext(), RecordResult(),
+                                       &new_url));
+  EXPECT_EQ(2, count);
+  EXPECT_EQ(GURL(kRedirectUrl), new_url);
+  EXPECT_EQ(0u, pending_tasks());
+  EXPECT_FALSE(handler.IsRequestIdentifierValid(1));
+  task_environment_.RunUntilIdle();
+  EXPECT_FALSE(result_);
+}
+
+TEST_F(BraveRequestHandlerTest, BlockingStepPostsOneCompletionTask) {
+  int count = 0;
+  std::vector<Step> steps;
+  steps.push_back(MakeStep(StepMode::kSync,
+                           base::BindRepeating(&CountStep, &count, net::OK)));
+  steps.push_back(
+      MakeStep(StepMode::kMayBlock, base::BindRepeating(&BlockingStep)));
+  steps.push_back(
+      MakeStep(StepMode::kSync, base::BindRepeating(&RedirectStep)));
+  BraveRequestHandler handler(std::move(steps));
+
+  GURL new_url;
+  EXPECT_EQ(net::ERR_IO_PENDING,
+            handler.OnBeforeURLRequest(CreateContext(), RecordResult(),
+                                       &new_url));
+  EXPECT_EQ(1, count);
+  // Only the blocking step's own task.
+  EXPECT_EQ(1u, pending_tasks());
+
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(result_);
+  EXPECT_EQ(net::OK, *result_);
+  EXPECT_EQ(GURL(kRedirectUrl), new_url);
+  EXPECT_FALSE(handler.IsRequestIdentifierValid(1));
+}
+
+TEST_F(BraveRequestHandlerTest, ErrorIsReportedThroughCallback) {
+  int count = 0;
+  std::vector<Step> steps;
+  steps.push_back(
+      MakeStep(StepMode::kSync,
+               base::BindRepeating(&CountStep, &count, net::ERR_ABORTED)));
+  steps.push_back(MakeStep(StepMode::kSync,
+                           base::BindRepeating(&CountStep, &count, net::OK)));
+  BraveRequestHandler handler(std::move(steps));
+
+  GURL new_url;
+  EXPECT_EQ(net::ERR_IO_PENDING,
+            handler.OnBeforeURLRequest(CreateContext(), RecordResult(),
+                                       &new_url));
+  EXPECT_EQ(1, count);
+  EXPECT_EQ(1u, pending_tasks());
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(result_);
+  EXPECT_EQ(net::ERR_ABORTED, *result_);
+  EXPECT_TRUE(new_url.is_empty());
+}
+
+TEST_F(BraveRequestHandlerTest, DestroyedRequestIsNotResumed) {
+  int count = 0;
+  std::vector<Step> steps;
+  steps.push_back(
+      MakeStep(StepMode::kMayBlock, base::BindRepeating(&BlockingStep)));
+  steps.push_back(MakeStep(StepMode::kSync,
+                           base::BindRepeating(&CountStep, &count, net::OK)));
+  BraveRequestHandler handler(std::move(steps));
+
+  auto ctx = CreateContext();
+  GURL new_url;
+  EXPECT_EQ(net::ERR_IO_PENDING,
+            handler.OnBeforeURLRequest(ctx, RecordResult(), &new_url));
+  handler.OnURLRequestDestroyed(ctx);
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(0, count);
+  EXPECT_FALSE(result_);
+}
+
+TEST_F(BraveRequestHandlerTest, StepsRunOnlyForTheirEvent) {
+  int before_request_count = 0;
+  int start_transaction_count = 0;
+  std::vector<Step> steps;
+  steps.push_back(Step(brave::kOnBeforeStartTransaction, StepMode::kSync,
+                       base::BindRepeating(&CountStep, &start_transaction_count,
+                                           net::OK)));
+  steps.push_back(MakeStep(
+      StepMode::kSync,
+      base::BindRepeating(&CountStep, &before_request_count, net::OK)));
+  BraveRequestHandler handler(std::move(steps));
+
+  GURL new_url;
+  EXPECT_EQ(net::OK, handler.OnBeforeURLRequest(CreateContext(),
+                                                RecordResult(), &new_url));
+  EXPECT_EQ(1, before_request_count);
+  EXPECT_EQ(0, start_transaction_count);
+
+  net::HttpRequestHeaders headers;
+  EXPECT_EQ(net::OK, handler.OnBeforeStartTransaction(
+                         CreateContext(), RecordResult(), &headers));
+  EXPECT_EQ(1, before_request_count);
+  EXPECT_EQ(1, start_transaction_count);
+  EXPECT_EQ(0u, pending_tasks());
+}
+
+// The handler isn't tied to the UI thread; it can be driven from the request
+// sequence of ResourceContextData and completes requests there.
+TEST_F(BraveRequestHandlerTest, RunsOnAnySequence) {
+  std::vector<Step> steps;
+  steps.push_back(
+      MakeStep(StepMode::kMayBlock, base::BindRepeating(&BlockingStep)));
+  steps.push_back(
+      MakeStep(StepMode::kSync, base::BindRepeating(&RedirectStep)));
+  auto handler = std::make_unique<BraveRequestHandler>(std::move(steps));
+  scoped_refptr<base::SequencedTaskRunner> task_runner =
+      base::CreateSequencedTaskRunner({base::ThreadPool()});
+
+  GURL new_url;
+  base::RunLoop run_loop;
+  task_runner->PostTask(
+      FROM_HERE, base::BindLambdaForTesting([&]() {
+        EXPECT_EQ(net::ERR_IO_PENDING,
+                  handler->OnBeforeURLRequest(
+                      CreateContext(),
+                      base::BindLambdaForTesting([&](int rv) {
+                        EXPECT_TRUE(task_runner->RunsTasksInCurrentSequence());
+                        result_ = rv;
+                        run_loop.Quit();
+                      }),
+                      &new_url));
+      }));
+  run_loop.Run();
+
+  ASSERT_TRUE(result_);
+  EXPECT_EQ(net::OK, *result_);
+  EXPECT_EQ(GURL(kRedirectUrl), new_url);
+  // Nothing was posted to the UI thread.
+  EXPECT_EQ(0u, pending_tasks());
+
+  task_runner->DeleteSoon(FROM_HERE, std::move(handler));
+  task_environment_.RunUntilIdle();
+}
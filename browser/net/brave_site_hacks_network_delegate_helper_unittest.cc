@@ -138,8 +138,8 @@ TEST(BraveSiteHacksNetworkDelegateHelperTest,
                                       GURL("https://bondy.brian.org")});
   for (const auto& url : urls) {
     auto brave_request_info = std::make_shared<brave::BraveRequestInfo>(url);
-    brave_request_info->tab_origin =
-        GURL("chrome-extension://aemmndcbldboiebfnladdacbdfmadadm/");
+    brave_request_info->set_tab_origin(
+        GURL("chrome-extension://aemmndcbldboiebfnladdacbdfmadadm/"));
     const GURL original_referrer("https://hello.brianbondy.com/about");
     brave_request_info->referrer = original_referrer;
 
@@ -174,8 +174,8 @@ TEST(BraveSiteHacksNetworkDelegateHelperTest, QueryStringUntouched) {
   for (const auto& url : urls) {
     auto brave_request_info =
         std::make_shared<brave::BraveRequestInfo>(GURL(url));
-    brave_request_info->initiator_url =
-        GURL("https://example.net");  // cross-site
+    brave_request_info->set_initiator_url(
+        GURL("https://example.net"));  // cross-site
     int rc = brave::OnBeforeURLRequest_SiteHacksWork(ResponseCallback(),
                                                      brave_request_info);
     EXPECT_EQ(rc, net::OK);
@@ -195,7 +195,7 @@ TEST(BraveSiteHacksNetworkDelegateHelperTest, QueryStringExempted) {
   for (const auto& initiator : initiators) {
     auto brave_request_info =
         std::make_shared<brave::BraveRequestInfo>(tracking_url);
-    brave_request_info->initiator_url = GURL(initiator);
+    brave_request_info->set_initiator_url(GURL(initiator));
     int rc = brave::OnBeforeURLRequest_SiteHacksWork(ResponseCallback(),
                                                      brave_request_info);
     EXPECT_EQ(rc, net::OK);
@@ -207,8 +207,8 @@ TEST(BraveSiteHacksNetworkDelegateHelperTest, QueryStringExempted) {
   {
     auto brave_request_info =
         std::make_shared<brave::BraveRequestInfo>(tracking_url);
-    brave_request_info->initiator_url =
-        GURL("https://example.net");  // cross-site
+    brave_request_info->set_initiator_url(
+        GURL("https://example.net"));  // cross-site
     brave_request_info->internal_redirect = true;
     brave_request_info->redirect_source =
         GURL("https://example.org");  // cross-site
@@ -223,8 +223,8 @@ TEST(BraveSiteHacksNetworkDelegateHelperTest, QueryStringExempted) {
   {
     auto brave_request_info =
         std::make_shared<brave::BraveRequestInfo>(tracking_url);
-    brave_request_info->initiator_url =
-        GURL("https://example.net");  // cross-site
+    brave_request_info->set_initiator_url(
+        GURL("https://example.net"));  // cross-site
     brave_request_info->redirect_source =
         GURL("https://sub.example.com");  // same-site
     int rc = brave::OnBeforeURLRequest_SiteHacksWork(ResponseCallback(),
@@ -264,8 +264,8 @@ TEST(BraveSiteHacksNetworkDelegateHelperTest, QueryStringFiltered) {
   for (const auto& pair : urls) {
     auto brave_request_info =
         std::make_shared<brave::BraveRequestInfo>(GURL(pair.first));
-    brave_request_info->initiator_url =
-        GURL("https://example.net");  // cross-site
+    brave_request_info->set_initiator_url(
+        GURL("https://example.net"));  // cross-site
     int rc = brave::OnBeforeURLRequest_SiteHacksWork(ResponseCallback(),
                                                      brave_request_info);
     EXPECT_EQ(rc, net::OK);
@@ -276,8 +276,8 @@ TEST(BraveSiteHacksNetworkDelegateHelperTest, QueryStringFiltered) {
   {
     auto brave_request_info = std::make_shared<brave::BraveRequestInfo>(
         GURL("https://example.com/?fbclid=1"));
-    brave_request_info->initiator_url =
-        GURL("https://example.com");  // same-origin
+    brave_request_info->set_initiator_url(
+        GURL("https://example.com"));  // same-origin
     brave_request_info->redirect_source =
         GURL("https://example.net");  // cross-site
     int rc = brave::OnBeforeURLRequest_SiteHacksWork(ResponseCallback(),
@@ -290,7 +290,7 @@ TEST(BraveSiteHacksNetworkDelegateHelperTest, QueryStringFiltered) {
   {
     auto brave_request_info = std::make_shared<brave::BraveRequestInfo>(
         GURL("https://example.com/?fbclid=2"));
-    brave_request_info->initiator_url = GURL();
+    brave_request_info->set_initiator_url(GURL());
     int rc = brave::OnBeforeURLRequest_SiteHacksWork(ResponseCallback(),
                                                      brave_request_info);
     EXPECT_EQ(rc, net::OK);
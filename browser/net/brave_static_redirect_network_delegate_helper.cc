@@ -11,10 +11,10 @@
 #include <vector>
 
 #include "base/strings/string_piece_forward.h"
+#include "brave/browser/net/brave_static_request_rules.h"
 #include "brave/browser/translate/buildflags/buildflags.h"
 #include "brave/common/network_constants.h"
 #include "brave/common/translate_network_constants.h"
-#include "extensions/common/url_pattern.h"
 #include "net/base/net_errors.h"
 
 namespace brave {
@@ -52,117 +52,61 @@ int OnBeforeURLRequest_StaticRedirectWork(
 int OnBeforeURLRequest_StaticRedirectWorkForGURL(
     const GURL& request_url,
     GURL* new_url) {
-  GURL::Replacements replacements;
-  static URLPattern geo_pattern(URLPattern::SCHEME_HTTPS, kGeoLocationsPattern);
-  static URLPattern safeBrowsing_pattern(URLPattern::SCHEME_HTTPS,
-                                         kSafeBrowsingPrefix);
-  static URLPattern safebrowsingfilecheck_pattern(URLPattern::SCHEME_HTTPS,
-                                         kSafeBrowsingFileCheckPrefix);
-
-  // To-Do (@jumde) - Update the naming for the variables below
-  // https://github.com/brave/brave-browser/issues/10314
-  static URLPattern crlSet_pattern1(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kCRLSetPrefix1);
-  static URLPattern crlSet_pattern2(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kCRLSetPrefix2);
-  static URLPattern crlSet_pattern3(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kCRLSetPrefix3);
-  static URLPattern crlSet_pattern4(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kCRLSetPrefix4);
-  static URLPattern crxDownload_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kCRXDownloadPrefix);
-  static URLPattern autofill_pattern(
-      URLPattern::SCHEME_HTTPS, kAutofillPrefix);
-  static URLPattern gvt1_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, "*://*.gvt1.com/*");
-  static URLPattern googleDl_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS,
-      "*://dl.google.com/*");
-
-  static URLPattern widevine_gvt1_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS,
-      kWidevineGvt1Prefix);
-  static URLPattern widevine_google_dl_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS,
-      kWidevineGoogleDlPrefix);
+  const StaticRequestRuleMatches rules = MatchStaticRequestRules(request_url);
+  if (rules.empty())
+    return net::OK;
 
-#if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
-  static URLPattern translate_pattern(URLPattern::SCHEME_HTTPS,
-      kTranslateElementJSPattern);
-  static URLPattern translate_language_pattern(URLPattern::SCHEME_HTTPS,
-      kTranslateLanguagePattern);
-#endif
-  if (geo_pattern.MatchesURL(request_url)) {
+  GURL::Replacements replacements;
+  if (rules.Has(StaticRequestRule::kGeolocation)) {
     *new_url = GURL(GOOGLEAPIS_ENDPOINT GOOGLEAPIS_API_KEY);
     return net::OK;
   }
 
   auto safebrowsing_endpoint = GetSafeBrowsingEndpoint();
   if (!safebrowsing_endpoint.empty() &&
-      safeBrowsing_pattern.MatchesHost(request_url)) {
+      rules.Has(StaticRequestRule::kSafeBrowsing)) {
     replacements.SetHostStr(safebrowsing_endpoint);
     *new_url = request_url.ReplaceComponents(replacements);
     return net::OK;
   }
 
-  if (safebrowsingfilecheck_pattern.MatchesHost(request_url)) {
+  if (rules.Has(StaticRequestRule::kSafeBrowsingFileCheck)) {
     replacements.SetHostStr(kBraveSafeBrowsingFileCheckProxy);
     *new_url = request_url.ReplaceComponents(replacements);
     return net::OK;
   }
 
-  if (crxDownload_pattern.MatchesURL(request_url)) {
+  if (rules.Has(StaticRequestRule::kCRXDownload)) {
     replacements.SetSchemeStr("https");
     replacements.SetHostStr("crxdownload.brave.com");
     *new_url = request_url.ReplaceComponents(replacements);
     return net::OK;
   }
 
-  if (autofill_pattern.MatchesURL(request_url)) {
+  if (rules.Has(StaticRequestRule::kAutofill)) {
     replacements.SetSchemeStr("https");
     replacements.SetHostStr(kBraveStaticProxy);
     *new_url = request_url.ReplaceComponents(replacements);
     return net::OK;
   }
 
-  if (crlSet_pattern1.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr("crlsets.brave.com");
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (crlSet_pattern2.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr("crlsets.brave.com");
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (crlSet_pattern3.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr("crlsets.brave.com");
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (crlSet_pattern4.MatchesURL(request_url)) {
+  if (rules.Has(StaticRequestRule::kCRLSet)) {
     replacements.SetSchemeStr("https");
     replacements.SetHostStr("crlsets.brave.com");
     *new_url = request_url.ReplaceComponents(replacements);
     return net::OK;
   }
 
-  if (gvt1_pattern.MatchesURL(request_url) &&
-      !widevine_gvt1_pattern.MatchesURL(request_url)) {
+  if (rules.Has(StaticRequestRule::kGvt1) &&
+      !rules.Has(StaticRequestRule::kWidevineGvt1)) {
     replacements.SetSchemeStr("https");
     replacements.SetHostStr(kBraveRedirectorProxy);
     *new_url = request_url.ReplaceComponents(replacements);
     return net::OK;
   }
 
-  if (googleDl_pattern.MatchesURL(request_url) &&
-      !widevine_google_dl_pattern.MatchesURL(request_url)) {
+  if (rules.Has(StaticRequestRule::kGoogleDl) &&
+      !rules.Has(StaticRequestRule::kWidevineGoogleDl)) {
     replacements.SetSchemeStr("https");
     replacements.SetHostStr(kBraveRedirectorProxy);
     *new_url = request_url.ReplaceComponents(replacements);
@@ -170,7 +114,7 @@ int OnBeforeURLRequest_StaticRedirectWorkForGURL(
   }
 
 #if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
-  if (translate_pattern.MatchesURL(request_url)) {
+  if (rules.Has(StaticRequestRule::kTranslateElementJS)) {
     replacements.SetQueryStr(request_url.query_piece());
     replacements.SetPathStr(request_url.path_piece());
     *new_url =
@@ -178,7 +122,7 @@ int OnBeforeURLRequest_StaticRedirectWorkForGURL(
     return net::OK;
   }
 
-  if (translate_language_pattern.MatchesURL(request_url)) {
+  if (rules.Has(StaticRequestRule::kTranslateLanguage)) {
     *new_url = GURL(kBraveTranslateLanguageEndpoint);
     return net::OK;
   }
@@ -0,0 +1,130 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/brave_static_request_rules.h"
+
+#include <utility>
+
+#include "base/no_destructor.h"
+#include "brave/common/network_constants.h"
+#include "brave/common/translate_network_constants.h"
+#include "components/component_updater/component_updater_url_constants.h"
+#include "extensions/buildflags/buildflags.h"
+#include "url/gurl.h"
+
+#if BUILDFLAG(ENABLE_EXTENSIONS)
+#include "extensions/common/extension_urls.h"
+#endif
+
+namespace brave {
+
+namespace {
+
+constexpr int kHttpOrHttps = URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS;
+
+std::vector<StaticRequestRulePattern> CreateStaticRequestRulePatterns() {
+  using Rule = StaticRequestRule;
+  using MatchType = UrlPatternSet::MatchType;
+  const MatchType kURL = MatchType::kURL;
+  return {
+      {Rule::kSafeBrowsingReportAllowed, URLPattern::SCHEME_HTTPS,
+       "https://sb-ssl.google.com/safebrowsing/clientreport/download*", kURL},
+      {Rule::kSafeBrowsingReport, URLPattern::SCHEME_HTTPS,
+       "https://sb-ssl.google.com/safebrowsing/clientreport/*", kURL},
+      {Rule::kSafeBrowsingReport, URLPattern::SCHEME_HTTPS,
+       "https://safebrowsing.google.com/safebrowsing/clientreport/*", kURL},
+      {Rule::kSafeBrowsingReport, URLPattern::SCHEME_HTTPS,
+       "https://safebrowsing.google.com/safebrowsing/report*", kURL},
+      {Rule::kSafeBrowsingReport, URLPattern::SCHEME_HTTPS,
+       "https://safebrowsing.google.com/safebrowsing/uploads/*", kURL},
+
+      {Rule::kGeolocation, URLPattern::SCHEME_HTTPS, kGeoLocationsPattern,
+       kURL},
+      {Rule::kSafeBrowsing, URLPattern::SCHEME_HTTPS, kSafeBrowsingPrefix,
+       MatchType::kHost},
+      {Rule::kSafeBrowsingFileCheck, URLPattern::SCHEME_HTTPS,
+       kSafeBrowsingFileCheckPrefix, MatchType::kHost},
+      {Rule::kCRXDownload, kHttpOrHttps, kCRXDownloadPrefix, kURL},
+      {Rule::kAutofill, URLPattern::SCHEME_HTTPS, kAutofillPrefix, kURL},
+      {Rule::kCRLSet, kHttpOrHttps, kCRLSetPrefix1, kURL},
+      {Rule::kCRLSet, kHttpOrHttps, kCRLSetPrefix2, kURL},
+      {Rule::kCRLSet, kHttpOrHttps, kCRLSetPrefix3, kURL},
+      {Rule::kCRLSet, kHttpOrHttps, kCRLSetPrefix4, kURL},
+      {Rule::kGvt1, kHttpOrHttps, "*://*.gvt1.com/*", kURL},
+      {Rule::kWidevineGvt1, kHttpOrHttps, kWidevineGvt1Prefix, kURL},
+      {Rule::kGoogleDl, kHttpOrHttps, "*://dl.google.com/*", kURL},
+      {Rule::kWidevineGoogleDl, kHttpOrHttps, kWidevineGoogleDlPrefix, kURL},
+      {Rule::kTranslateElementJS, URLPattern::SCHEME_HTTPS,
+       kTranslateElementJSPattern, kURL},
+      {Rule::kTranslateLanguage, URLPattern::SCHEME_HTTPS,
+       kTranslateLanguagePattern, kURL},
+
+      {Rule::kUpdater, URLPattern::SCHEME_HTTPS,
+       std::string(component_updater::kUpdaterJSONDefaultUrl) + "*", kURL},
+      {Rule::kUpdater, URLPattern::SCHEME_HTTP,
+       std::string(component_updater::kUpdaterJSONFallbackUrl) + "*", kURL},
+#if BUILDFLAG(ENABLE_EXTENSIONS)
+      {Rule::kUpdater, URLPattern::SCHEME_HTTPS,
+       std::string(extension_urls::kChromeWebstoreUpdateURL) + "*", kURL},
+#endif
+      {Rule::kChromecast, kHttpOrHttps, kChromeCastPrefix, kURL},
+      {Rule::kClients4, kHttpOrHttps, kClients4Prefix, MatchType::kHost},
+      {Rule::kBugsChromium, kHttpOrHttps,
+       "*://bugs.chromium.org/p/chromium/issues/entry?*", kURL},
+
+      {Rule::kTranslateGen204, URLPattern::SCHEME_HTTPS,
+       kTranslateGen204Pattern, kURL},
+      {Rule::kTranslateResource, URLPattern::SCHEME_HTTPS,
+       kTranslateElementMainCSSPattern, kURL},
+      {Rule::kTranslateResource, URLPattern::SCHEME_HTTPS,
+       kTranslateBrandingPNGPattern, kURL},
+      {Rule::kTranslateScript, URLPattern::SCHEME_HTTPS,
+       kTranslateElementMainJSPattern, kURL},
+      {Rule::kTranslateScript, URLPattern::SCHEME_HTTPS,
+       kTranslateMainJSPattern, kURL},
+      {Rule::kTranslateRequest, URLPattern::SCHEME_HTTPS,
+       kTranslateRequestPattern, kURL},
+
+      {Rule::kBraveServicesKey, URLPattern::SCHEME_HTTPS, kBraveProxyPattern,
+       kURL},
+      {Rule::kBraveServicesKey, URLPattern::SCHEME_HTTPS,
+       kBraveSoftwareProxyPattern, kURL},
+  };
+}
+
+const UrlPatternSet& GetStaticRequestRuleSet() {
+  static const base::NoDestructor<UrlPatternSet> rule_set([] {
+    UrlPatternSet rule_set;
+    for (const auto& rule_pattern : GetStaticRequestRulePatterns()) {
+      rule_set.Add(static_cast<int>(rule_pattern.rule),
+                   URLPattern(rule_pattern.valid_schemes, rule_pattern.pattern),
+                   rule_pattern.match_type);
+    }
+    return rule_set;
+  }());
+  return *rule_set;
+}
+
+}  // namespace
+
+StaticRequestRuleMatches::StaticRequestRuleMatches(base::flat_set<int> rules)
+    : rules_(std::move(rules)) {}
+
+StaticRequestRuleMatches::StaticRequestRuleMatches(
+    const StaticRequestRuleMatches& other) = default;
+
+StaticRequestRuleMatches::~StaticRequestRuleMatches() = default;
+
+const std::vector<StaticRequestRulePattern>& GetStaticRequestRulePatterns() {
+  static const base::NoDestructor<std::vector<StaticRequestRulePattern>>
+      patterns(CreateStaticRequestRulePatterns());
+  return *patterns;
+}
+
+StaticRequestRuleMatches MatchStaticRequestRules(const GURL& url) {
+  return StaticRequestRuleMatches(GetStaticRequestRuleSet().MatchAll(url));
+}
+
+}  // namespace brave
@@ -0,0 +1,84 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_BROWSER_NET_BRAVE_STATIC_REQUEST_RULES_H_
+#define BRAVE_BROWSER_NET_BRAVE_STATIC_REQUEST_RULES_H_
+
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_set.h"
+#include "brave/browser/net/url_pattern_set.h"
+
+class GURL;
+
+namespace brave {
+
+// The fixed URL rules applied by the static redirect, translate redirect,
+// safe browsing blocking and system request helpers. Each rule stands for one
+// or more URLPatterns; what happens on a match is up to the helper.
+enum class StaticRequestRule {
+  // brave_block_safebrowsing_urls.cc
+  kSafeBrowsingReportAllowed,
+  kSafeBrowsingReport,
+  // brave_static_redirect_network_delegate_helper.cc
+  kGeolocation,
+  kSafeBrowsing,
+  kSafeBrowsingFileCheck,
+  kCRXDownload,
+  kAutofill,
+  kCRLSet,
+  kGvt1,
+  kWidevineGvt1,
+  kGoogleDl,
+  kWidevineGoogleDl,
+  kTranslateElementJS,
+  kTranslateLanguage,
+  // brave_common_static_redirect_network_delegate_helper.cc
+  kUpdater,
+  kChromecast,
+  kClients4,
+  kBugsChromium,
+  // brave_translate_redirect_network_delegate_helper.cc
+  kTranslateGen204,
+  kTranslateResource,
+  kTranslateScript,
+  kTranslateRequest,
+  // brave_system_request_handler.cc
+  kBraveServicesKey,
+};
+
+struct StaticRequestRulePattern {
+  StaticRequestRule rule;
+  int valid_schemes;
+  std::string pattern;
+  UrlPatternSet::MatchType match_type;
+};
+
+// The rules matched by one request.
+class StaticRequestRuleMatches {
+ public:
+  explicit StaticRequestRuleMatches(base::flat_set<int> rules);
+  StaticRequestRuleMatches(const StaticRequestRuleMatches& other);
+  ~StaticRequestRuleMatches();
+
+  bool empty() const { return rules_.empty(); }
+  bool Has(StaticRequestRule rule) const {
+    return rules_.count(static_cast<int>(rule)) > 0;
+  }
+
+ private:
+  base::flat_set<int> rules_;
+};
+
+// Every pattern of every rule, in the form they are compiled from.
+const std::vector<StaticRequestRulePattern>& GetStaticRequestRulePatterns();
+
+// Matches |url| against all of the static rules with a single indexed lookup.
+StaticRequestRuleMatches MatchStaticRequestRules(const GURL& url);
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_NET_BRAVE_STATIC_REQUEST_RULES_H_
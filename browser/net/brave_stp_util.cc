@@ -6,6 +6,7 @@
 #include "brave/browser/net/brave_stp_util.h"
 
 #include "base/no_destructor.h"
+#include "brave/browser/net/response_header_changes.h"
 #include "net/base/registry_controlled_domains/registry_controlled_domain.h"
 
 namespace brave {
@@ -20,24 +21,15 @@ base::flat_set<base::StringPiece>* TrackableSecurityHeaders() {
 
 void RemoveTrackableSecurityHeadersForThirdParty(
     const GURL& request_url, const url::Origin& top_frame_origin,
-    const net::HttpResponseHeaders* original_response_headers,
-    scoped_refptr<net::HttpResponseHeaders>* override_response_headers) {
-  if (!original_response_headers && !override_response_headers->get()) {
-    return;
-  }
-
+    ResponseHeaderChanges* changes) {
   if (net::registry_controlled_domains::SameDomainOrHost(
           request_url, top_frame_origin,
           net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES)) {
     return;
   }
 
-  if (!override_response_headers->get()) {
-    *override_response_headers =
-        new net::HttpResponseHeaders(original_response_headers->raw_headers());
-  }
   for (auto header : *TrackableSecurityHeaders()) {
-    (*override_response_headers)->RemoveHeader(header.as_string());
+    changes->RemoveHeader(header);
   }
 }
 
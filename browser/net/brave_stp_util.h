@@ -8,18 +8,20 @@
 
 #include "base/containers/flat_set.h"
 #include "base/strings/string_piece.h"
-#include "net/http/http_response_headers.h"
 #include "url/gurl.h"
 #include "url/origin.h"
 
 namespace brave {
 
+class ResponseHeaderChanges;
+
 base::flat_set<base::StringPiece>* TrackableSecurityHeaders();
 
+// Records the removal of TrackableSecurityHeaders() in |changes| if
+// |request_url| is third-party to |top_frame_origin|.
 void RemoveTrackableSecurityHeadersForThirdParty(
     const GURL& request_url, const url::Origin& top_frame_origin,
-    const net::HttpResponseHeaders* original_response_headers,
-    scoped_refptr<net::HttpResponseHeaders>* override_response_headers);
+    ResponseHeaderChanges* changes);
 
 }  // namespace brave
 
@@ -8,8 +8,8 @@
 #include "brave/browser/net/brave_block_safebrowsing_urls.h"
 #include "brave/browser/net/brave_common_static_redirect_network_delegate_helper.h"
 #include "brave/browser/net/brave_static_redirect_network_delegate_helper.h"
+#include "brave/browser/net/brave_static_request_rules.h"
 #include "brave/common/network_constants.h"
-#include "extensions/common/url_pattern.h"
 #include "services/network/public/cpp/resource_request.h"
 #include "url/gurl.h"
 
@@ -20,12 +20,8 @@ std::string BraveServicesKeyForTesting() {
 }
 
 void AddBraveServicesKeyHeader(network::ResourceRequest* url_request) {
-  static URLPattern brave_proxy_pattern(URLPattern::SCHEME_HTTPS,
-                                        kBraveProxyPattern);
-  static URLPattern bravesoftware_proxy_pattern(URLPattern::SCHEME_HTTPS,
-                                                kBraveSoftwareProxyPattern);
-  if (brave_proxy_pattern.MatchesURL(url_request->url) ||
-      bravesoftware_proxy_pattern.MatchesURL(url_request->url)) {
+  if (MatchStaticRequestRules(url_request->url)
+          .Has(StaticRequestRule::kBraveServicesKey)) {
     url_request->headers.SetHeaderIfMissing(kBraveServicesKeyHeader,
                                             BRAVE_SERVICES_KEY);
   }
@@ -29,8 +29,8 @@ bool IsViewerURL(const GURL& url) {
 
 
 bool IsWebtorrentInitiated(std::shared_ptr<brave::BraveRequestInfo> ctx) {
-  return ctx->initiator_url.scheme() == extensions::kExtensionScheme &&
-      ctx->initiator_url.host() == brave_webtorrent_extension_id;
+  return ctx->initiator_url().scheme() == extensions::kExtensionScheme &&
+      ctx->initiator_url().host() == brave_webtorrent_extension_id;
 }
 
 // Returns true if the resource type is a frame (i.e. a top level page) or a
@@ -60,17 +60,15 @@ int OnHeadersReceived_TorrentRedirectWork(
     return net::OK;
   }
 
-  *override_response_headers =
-    new net::HttpResponseHeaders(original_response_headers->raw_headers());
-  (*override_response_headers)
-      ->ReplaceStatusLine("HTTP/1.1 307 Temporary Redirect");
-  (*override_response_headers)->RemoveHeader("Location");
+  ctx->response_header_changes.ReplaceStatusLine(
+      "HTTP/1.1 307 Temporary Redirect");
+  ctx->response_header_changes.RemoveHeader("Location");
   GURL url(
       base::StrCat({extensions::kExtensionScheme, "://",
       brave_webtorrent_extension_id,
       "/extension/brave_webtorrent2.html?",
       ctx->request_url.spec()}));
-  (*override_response_headers)->AddHeader("Location", url.spec());
+  ctx->response_header_changes.AddHeader("Location", url.spec());
   *allowed_unsafe_redirect_url = url;
   return net::OK;
 }
@@ -74,6 +74,8 @@ TEST_F(BraveTorrentRedirectNetworkDelegateHelperTest,
   int rc = webtorrent::OnHeadersReceived_TorrentRedirectWork(
       orig_response_headers.get(), &overwrite_response_headers,
       &allowed_unsafe_redirect_url, ResponseCallback(), request_info);
+  request_info->response_header_changes.Apply(
+      orig_response_headers.get(), &overwrite_response_headers);
 
   EXPECT_EQ(overwrite_response_headers->GetStatusLine(), "HTTP/1.0 200 OK");
   std::string location;
@@ -101,6 +103,8 @@ TEST_F(BraveTorrentRedirectNetworkDelegateHelperTest,
   int rc = webtorrent::OnHeadersReceived_TorrentRedirectWork(
       orig_response_headers.get(), &overwrite_response_headers,
       &allowed_unsafe_redirect_url, ResponseCallback(), request_info);
+  request_info->response_header_changes.Apply(
+      orig_response_headers.get(), &overwrite_response_headers);
 
   EXPECT_EQ(overwrite_response_headers->GetStatusLine(),
             "HTTP/1.1 307 Temporary Redirect");
@@ -130,6 +134,8 @@ TEST_F(BraveTorrentRedirectNetworkDelegateHelperTest,
   int rc = webtorrent::OnHeadersReceived_TorrentRedirectWork(
       orig_response_headers.get(), &overwrite_response_headers,
       &allowed_unsafe_redirect_url, ResponseCallback(), request_info);
+  request_info->response_header_changes.Apply(
+      orig_response_headers.get(), &overwrite_response_headers);
 
   EXPECT_EQ(overwrite_response_headers->GetStatusLine(),
             "HTTP/1.1 307 Temporary Redirect");
@@ -165,6 +171,8 @@ TEST_F(BraveTorrentRedirectNetworkDelegateHelperTest,
   int rc = webtorrent::OnHeadersReceived_TorrentRedirectWork(
       orig_response_headers.get(), &overwrite_response_headers,
       &allowed_unsafe_redirect_url, ResponseCallback(), request_info);
+  request_info->response_header_changes.Apply(
+      orig_response_headers.get(), &overwrite_response_headers);
 
   EXPECT_EQ(overwrite_response_headers->GetStatusLine(),
             "HTTP/1.1 307 Temporary Redirect");
@@ -196,6 +204,8 @@ TEST_F(BraveTorrentRedirectNetworkDelegateHelperTest,
   int rc = webtorrent::OnHeadersReceived_TorrentRedirectWork(
       orig_response_headers.get(), &overwrite_response_headers,
       &allowed_unsafe_redirect_url, ResponseCallback(), request_info);
+  request_info->response_header_changes.Apply(
+      orig_response_headers.get(), &overwrite_response_headers);
 
   EXPECT_EQ(overwrite_response_headers->GetStatusLine(), "HTTP/1.0 200 OK");
   std::string location;
@@ -222,6 +232,8 @@ TEST_F(BraveTorrentRedirectNetworkDelegateHelperTest, MimeTypeNoRedirect) {
   int rc = webtorrent::OnHeadersReceived_TorrentRedirectWork(
       orig_response_headers.get(), &overwrite_response_headers,
       &allowed_unsafe_redirect_url, ResponseCallback(), request_info);
+  request_info->response_header_changes.Apply(
+      orig_response_headers.get(), &overwrite_response_headers);
 
   EXPECT_EQ(overwrite_response_headers->GetStatusLine(), "HTTP/1.0 200 OK");
   std::string location;
@@ -244,12 +256,14 @@ TEST_F(BraveTorrentRedirectNetworkDelegateHelperTest,
       new net::HttpResponseHeaders(std::string());
   GURL allowed_unsafe_redirect_url;
   auto request_info = std::make_shared<brave::BraveRequestInfo>(torrent_url());
-  request_info->initiator_url = torrent_extension_url();
+  request_info->set_initiator_url(torrent_extension_url());
   request_info->resource_type = blink::mojom::ResourceType::kMainFrame;
 
   int rc = webtorrent::OnHeadersReceived_TorrentRedirectWork(
       orig_response_headers.get(), &overwrite_response_headers,
       &allowed_unsafe_redirect_url, ResponseCallback(), request_info);
+  request_info->response_header_changes.Apply(
+      orig_response_headers.get(), &overwrite_response_headers);
 
   EXPECT_EQ(overwrite_response_headers->GetStatusLine(), "HTTP/1.0 200 OK");
   std::string location;
@@ -273,12 +287,14 @@ TEST_F(BraveTorrentRedirectNetworkDelegateHelperTest,
   GURL allowed_unsafe_redirect_url;
   auto request_info =
       std::make_shared<brave::BraveRequestInfo>(torrent_viewer_url());
-  request_info->initiator_url = torrent_extension_url();
+  request_info->set_initiator_url(torrent_extension_url());
   request_info->resource_type = blink::mojom::ResourceType::kMainFrame;
 
   int rc = webtorrent::OnHeadersReceived_TorrentRedirectWork(
       orig_response_headers.get(), &overwrite_response_headers,
       &allowed_unsafe_redirect_url, ResponseCallback(), request_info);
+  request_info->response_header_changes.Apply(
+      orig_response_headers.get(), &overwrite_response_headers);
 
   EXPECT_EQ(overwrite_response_headers->GetStatusLine(),
             "HTTP/1.1 307 Temporary Redirect");
@@ -309,6 +325,8 @@ TEST_F(BraveTorrentRedirectNetworkDelegateHelperTest,
   int rc = webtorrent::OnHeadersReceived_TorrentRedirectWork(
       orig_response_headers.get(), &overwrite_response_headers,
       &allowed_unsafe_redirect_url, ResponseCallback(), request_info);
+  request_info->response_header_changes.Apply(
+      orig_response_headers.get(), &overwrite_response_headers);
 
   EXPECT_EQ(overwrite_response_headers->GetStatusLine(), "HTTP/1.0 200 OK");
   std::string location;
@@ -322,6 +340,8 @@ TEST_F(BraveTorrentRedirectNetworkDelegateHelperTest,
   rc = webtorrent::OnHeadersReceived_TorrentRedirectWork(
       orig_response_headers.get(), &overwrite_response_headers,
       &allowed_unsafe_redirect_url, ResponseCallback(), request_info);
+  request_info->response_header_changes.Apply(
+      orig_response_headers.get(), &overwrite_response_headers);
 
   EXPECT_EQ(overwrite_response_headers->GetStatusLine(), "HTTP/1.0 200 OK");
   EXPECT_FALSE(overwrite_response_headers->EnumerateHeader(nullptr, "Location",
@@ -0,0 +1,210 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/request_context_snapshot.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/memory/ptr_util.h"
+#include "base/supports_user_data.h"
+#include "brave/browser/net/adblock_cname_cache.h"
+#include "brave/components/brave_referrals/browser/referral_header_index.h"
+#include "brave/components/brave_shields/browser/shields_settings_snapshot.h"
+#include "brave/components/brave_webtorrent/browser/buildflags/buildflags.h"
+#include "brave/components/ipfs/buildflags/buildflags.h"
+#include "chrome/browser/profiles/profile.h"
+#include "chrome/browser/profiles/profile_observer.h"
+#include "content/public/browser/browser_thread.h"
+
+#if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
+#include "base/scoped_observer.h"
+#include "brave/components/brave_webtorrent/browser/webtorrent_util.h"
+#include "extensions/browser/extension_registry.h"
+#include "extensions/browser/extension_registry_observer.h"
+#include "extensions/common/constants.h"
+#endif
+
+#if BUILDFLAG(IPFS_ENABLED)
+#include "brave/components/ipfs/ipfs_constants.h"
+#include "brave/components/ipfs/pref_names.h"
+#include "components/prefs/pref_change_registrar.h"
+#include "components/prefs/pref_service.h"
+#include "components/user_prefs/user_prefs.h"
+#endif
+
+namespace brave {
+
+namespace {
+
+const void* const kRequestContextPrefsUserDataKey =
+    &kRequestContextPrefsUserDataKey;
+
+bool IsWebTorrentDisabled(content::BrowserContext* browser_context) {
+#if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
+  return !webtorrent::IsWebtorrentEnabled(browser_context);
+#else
+  return true;
+#endif
+}
+
+bool IsIPFSLocal(content::BrowserContext* browser_context) {
+#if BUILDFLAG(IPFS_ENABLED)
+  auto* prefs = user_prefs::UserPrefs::Get(browser_context);
+  return static_cast<ipfs::IPFSResolveMethodTypes>(
+             prefs->GetInteger(kIPFSResolveMethod)) ==
+         ipfs::IPFSResolveMethodTypes::IPFS_LOCAL;
+#else
+  return true;
+#endif
+}
+
+}  // namespace
+
+// Ties the prefs to their profile and updates them when the WebTorrent
+// extension is loaded or unloaded and when the IPFS resolve method changes.
+// Lives on the UI thread, and stops watching once the profile starts being
+// destroyed, before what it watches goes away.
+class RequestContextPrefs::Holder
+    : public base::SupportsUserData::Data,
+#if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
+      public extensions::ExtensionRegistryObserver,
+#endif
+      public ProfileObserver {
+ public:
+  explicit Holder(content::BrowserContext* browser_context)
+      : browser_context_(browser_context),
+        profile_(Profile::FromBrowserContext(browser_context)),
+        prefs_(base::MakeRefCounted<RequestContextPrefs>(
+            IsWebTorrentDisabled(browser_context),
+            IsIPFSLocal(browser_context))) {
+    profile_->AddObserver(this);
+#if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
+    extension_registry_observer_.Add(
+        extensions::ExtensionRegistry::Get(browser_context));
+#endif
+#if BUILDFLAG(IPFS_ENABLED)
+    pref_change_registrar_.Init(user_prefs::UserPrefs::Get(browser_context));
+    pref_change_registrar_.Add(
+        kIPFSResolveMethod,
+        base::BindRepeating(&Holder::OnIPFSResolveMethodChanged,
+                            base::Unretained(this)));
+#endif
+  }
+
+  ~Holder() override {
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    StopWatching();
+  }
+
+  RequestContextPrefs* prefs() const { return prefs_.get(); }
+
+  // ProfileObserver overrides:
+  void OnProfileWillBeDestroyed(Profile* profile) override { StopWatching(); }
+
+#if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
+  // extensions::ExtensionRegistryObserver overrides:
+  void OnExtensionLoaded(content::BrowserContext* browser_context,
+                         const extensions::Extension* extension) override {
+    if (extension->id() == brave_webtorrent_extension_id)
+      OnWebTorrentChanged();
+  }
+
+  void OnExtensionUnloaded(
+      content::BrowserContext* browser_context,
+      const extensions::Extension* extension,
+      extensions::UnloadedExtensionReason reason) override {
+    if (extension->id() == brave_webtorrent_extension_id)
+      OnWebTorrentChanged();
+  }
+#endif
+
+ private:
+  void StopWatching() {
+    if (!profile_)
+      return;
+#if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
+    extension_registry_observer_.RemoveAll();
+#endif
+#if BUILDFLAG(IPFS_ENABLED)
+    pref_change_registrar_.RemoveAll();
+#endif
+    profile_->RemoveObserver(this);
+    profile_ = nullptr;
+  }
+
+  void OnWebTorrentChanged() {
+    prefs_->is_webtorrent_disabled_.store(
+        IsWebTorrentDisabled(browser_context_), std::memory_order_relaxed);
+  }
+
+  void OnIPFSResolveMethodChanged() {
+    prefs_->ipfs_local_.store(IsIPFSLocal(browser_context_),
+                              std::memory_order_relaxed);
+  }
+
+  content::BrowserContext* const browser_context_;
+  // Null once the profile started being destroyed.
+  Profile* profile_;
+  scoped_refptr<RequestContextPrefs> prefs_;
+#if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
+  ScopedObserver<extensions::ExtensionRegistry,
+                 extensions::ExtensionRegistryObserver>
+      extension_registry_observer_{this};
+#endif
+#if BUILDFLAG(IPFS_ENABLED)
+  PrefChangeRegistrar pref_change_registrar_;
+#endif
+
+  DISALLOW_COPY_AND_ASSIGN(Holder);
+};
+
+// static
+scoped_refptr<const RequestContextPrefs>
+RequestContextPrefs::FromBrowserContext(
+    content::BrowserContext* browser_context) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  auto* holder = static_cast<Holder*>(
+      browser_context->GetUserData(kRequestContextPrefsUserDataKey));
+  if (!holder) {
+    holder = new Holder(browser_context);
+    browser_context->SetUserData(kRequestContextPrefsUserDataKey,
+                                 base::WrapUnique(holder));
+  }
+  return holder->prefs();
+}
+
+RequestContextPrefs::RequestContextPrefs(bool is_webtorrent_disabled,
+                                         bool ipfs_local)
+    : is_webtorrent_disabled_(is_webtorrent_disabled),
+      ipfs_local_(ipfs_local) {}
+
+RequestContextPrefs::~RequestContextPrefs() = default;
+
+// static
+scoped_refptr<const RequestContextSnapshot> RequestContextSnapshot::Create(
+    content::BrowserContext* browser_context,
+    scoped_refptr<const ReferralHeaderIndex> referral_header_index) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  return base::MakeRefCounted<RequestContextSnapshot>(
+      brave_shields::ShieldsSettingsCache::FromBrowserContext(browser_context),
+      RequestContextPrefs::FromBrowserContext(browser_context),
+      std::move(referral_header_index),
+      AdblockCnameCache::FromBrowserContext(browser_context));
+}
+
+RequestContextSnapshot::RequestContextSnapshot(
+    scoped_refptr<brave_shields::ShieldsSettingsCache> shields_settings,
+    scoped_refptr<const RequestContextPrefs> prefs,
+    scoped_refptr<const ReferralHeaderIndex> referral_header_index,
+    scoped_refptr<AdblockCnameCache> adblock_cname_cache)
+    : shields_settings_(std::move(shields_settings)),
+      prefs_(std::move(prefs)),
+      referral_header_index_(std::move(referral_header_index)),
+      adblock_cname_cache_(std::move(adblock_cname_cache)) {}
+
+RequestContextSnapshot::~RequestContextSnapshot() = default;
+
+}  // namespace brave
@@ -0,0 +1,108 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_BROWSER_NET_REQUEST_CONTEXT_SNAPSHOT_H_
+#define BRAVE_BROWSER_NET_REQUEST_CONTEXT_SNAPSHOT_H_
+
+#include <atomic>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+
+namespace brave_shields {
+class ShieldsSettingsCache;
+}
+
+namespace content {
+class BrowserContext;
+}
+
+namespace brave {
+
+class AdblockCnameCache;
+class ReferralHeaderIndex;
+
+// The prefs of a profile that request handling reads. They are kept current
+// on the UI thread and can be read from any sequence, so that proxies which
+// outlive a change, e.g. WebTorrent being loaded for a .torrent navigation,
+// see it.
+class RequestContextPrefs
+    : public base::RefCountedThreadSafe<RequestContextPrefs> {
+ public:
+  // Must be called on the UI thread.
+  static scoped_refptr<const RequestContextPrefs> FromBrowserContext(
+      content::BrowserContext* browser_context);
+
+  RequestContextPrefs(bool is_webtorrent_disabled, bool ipfs_local);
+
+  bool is_webtorrent_disabled() const {
+    return is_webtorrent_disabled_.load(std::memory_order_relaxed);
+  }
+  bool ipfs_local() const {
+    return ipfs_local_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<RequestContextPrefs>;
+  class Holder;
+
+  ~RequestContextPrefs();
+
+  std::atomic<bool> is_webtorrent_disabled_;
+  std::atomic<bool> ipfs_local_;
+
+  DISALLOW_COPY_AND_ASSIGN(RequestContextPrefs);
+};
+
+// The profile state that BraveRequestInfo::MakeCTX and the request helpers
+// read, captured on the UI thread when a proxy is created. It is immutable
+// and safe to use from any sequence, which lets requests be handled off the
+// UI thread. Shields settings and prefs are read through the profile's
+// (thread-safe) cache and RequestContextPrefs, which are kept current.
+class RequestContextSnapshot
+    : public base::RefCountedThreadSafe<RequestContextSnapshot> {
+ public:
+  // Must be called on the UI thread.
+  static scoped_refptr<const RequestContextSnapshot> Create(
+      content::BrowserContext* browser_context,
+      scoped_refptr<const ReferralHeaderIndex> referral_header_index);
+
+  RequestContextSnapshot(
+      scoped_refptr<brave_shields::ShieldsSettingsCache> shields_settings,
+      scoped_refptr<const RequestContextPrefs> prefs,
+      scoped_refptr<const ReferralHeaderIndex> referral_header_index,
+      scoped_refptr<AdblockCnameCache> adblock_cname_cache);
+
+  brave_shields::ShieldsSettingsCache* shields_settings() const {
+    return shields_settings_.get();
+  }
+  bool is_webtorrent_disabled() const {
+    return prefs_->is_webtorrent_disabled();
+  }
+  bool ipfs_local() const { return prefs_->ipfs_local(); }
+  // May be null.
+  const ReferralHeaderIndex* referral_header_index() const {
+    return referral_header_index_.get();
+  }
+  // Not a snapshot: the cache is shared by the profile and guards itself.
+  AdblockCnameCache* adblock_cname_cache() const {
+    return adblock_cname_cache_.get();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<RequestContextSnapshot>;
+  ~RequestContextSnapshot();
+
+  const scoped_refptr<brave_shields::ShieldsSettingsCache> shields_settings_;
+  const scoped_refptr<const RequestContextPrefs> prefs_;
+  const scoped_refptr<const ReferralHeaderIndex> referral_header_index_;
+  const scoped_refptr<AdblockCnameCache> adblock_cname_cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(RequestContextSnapshot);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_NET_REQUEST_CONTEXT_SNAPSHOT_H_
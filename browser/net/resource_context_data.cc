@@ -8,48 +8,155 @@
 #include <string>
 #include <utility>
 
+#include "base/bind.h"
+#include "base/feature_list.h"
+#include "base/sequence_checker.h"
+#include "base/task/post_task.h"
 #include "brave/browser/net/brave_proxying_url_loader_factory.h"
 #include "brave/browser/net/brave_proxying_web_socket.h"
 #include "brave/browser/net/brave_request_handler.h"
+#include "brave/browser/net/request_context_snapshot.h"
+#include "brave/common/pref_names.h"
+#include "brave/components/brave_referrals/browser/referral_header_index.h"
+#include "brave/components/brave_referrals/buildflags/buildflags.h"
+#include "brave/components/brave_shields/common/features.h"
+#include "chrome/browser/browser_process.h"
+#include "components/prefs/pref_service.h"
 #include "content/public/browser/browser_context.h"
 #include "net/cookies/site_for_cookies.h"
 
 // User data key for ResourceContextData.
 const void* const kResourceContextUserDataKey = &kResourceContextUserDataKey;
 
-ResourceContextData::ResourceContextData()
-    : request_id_generator_(base::MakeRefCounted<RequestIDGenerator>()),
+class ResourceContextData::SequenceData {
+ public:
+  SequenceData() { DETACH_FROM_SEQUENCE(sequence_checker_); }
+  ~SequenceData() { DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_); }
+
+  void StartProxying(
+      scoped_refptr<const brave::RequestContextSnapshot> context_snapshot,
+      int render_process_id,
+      int frame_tree_node_id,
+      network::mojom::URLLoaderFactoryRequest request,
+      network::mojom::URLLoaderFactoryPtrInfo target_factory,
+      scoped_refptr<RequestIDGenerator> request_id_generator) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    auto proxy = std::make_unique<BraveProxyingURLLoaderFactory>(
+        &request_handler_, std::move(context_snapshot), render_process_id,
+        frame_tree_node_id, std::move(request), std::move(target_factory),
+        std::move(request_id_generator),
+        base::BindOnce(&SequenceData::RemoveProxy,
+                       weak_factory_.GetWeakPtr()));
+    proxies_.emplace(std::move(proxy));
+  }
+
+ private:
+  void RemoveProxy(BraveProxyingURLLoaderFactory* proxy) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    auto it = proxies_.find(proxy);
+    DCHECK(it != proxies_.end());
+    proxies_.erase(it);
+  }
+
+  BraveRequestHandler request_handler_;
+  // Declared after |request_handler_|, which they point to.
+  std::set<std::unique_ptr<BraveProxyingURLLoaderFactory>,
+           base::UniquePtrComparator>
+      proxies_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+  base::WeakPtrFactory<SequenceData> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(SequenceData);
+};
+
+ResourceContextData::ResourceContextData(
+    content::BrowserContext* browser_context)
+    : browser_context_(browser_context),
+      request_handler_(std::make_unique<BraveRequestHandler>()),
+      request_id_generator_(base::MakeRefCounted<RequestIDGenerator>()),
+      sequence_data_(nullptr, base::OnTaskRunnerDeleter(nullptr)),
       weak_factory_(this) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+#if BUILDFLAG(ENABLE_BRAVE_REFERRALS)
+  local_state_change_registrar_.Init(g_browser_process->local_state());
+  local_state_change_registrar_.Add(
+      kReferralHeaders,
+      base::BindRepeating(&ResourceContextData::OnReferralHeadersChanged,
+                          base::Unretained(this)));
+  // Retrieve current referral headers, if any.
+  OnReferralHeadersChanged();
+#endif
+
+  if (base::FeatureList::IsEnabled(
+          brave_shields::features::kBraveRequestsOffUIThread)) {
+    request_task_runner_ = base::CreateSequencedTaskRunner(
+        {base::ThreadPool(), base::TaskPriority::USER_BLOCKING,
+         base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN});
+    sequence_data_ = std::unique_ptr<SequenceData, base::OnTaskRunnerDeleter>(
+        new SequenceData, base::OnTaskRunnerDeleter(request_task_runner_));
+  }
 }
 
 ResourceContextData::~ResourceContextData() = default;
 
 // static
-void ResourceContextData::StartProxying(
-    content::BrowserContext* browser_context,
-    int render_process_id,
-    int frame_tree_node_id,
-    network::mojom::URLLoaderFactoryRequest request,
-    network::mojom::URLLoaderFactoryPtrInfo target_factory) {
+ResourceContextData* ResourceContextData::Get(
+    content::BrowserContext* browser_context) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-
   auto* self = static_cast<ResourceContextData*>(
       browser_context->GetUserData(kResourceContextUserDataKey));
   if (!self) {
-    self = new ResourceContextData();
+    self = new ResourceContextData(browser_context);
     browser_context->SetUserData(kResourceContextUserDataKey,
                                   base::WrapUnique(self));
   }
+  return self;
+}
+
+scoped_refptr<const brave::RequestContextSnapshot>
+ResourceContextData::CreateContextSnapshot() {
+  return brave::RequestContextSnapshot::Create(browser_context_,
+                                               referral_header_index_);
+}
+
+void ResourceContextData::OnReferralHeadersChanged() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  if (const base::ListValue* referral_headers =
+          g_browser_process->local_state()->GetList(kReferralHeaders)) {
+    referral_header_index_ =
+        base::MakeRefCounted<brave::ReferralHeaderIndex>(*referral_headers);
+  }
+}
+
+// static
+void ResourceContextData::StartProxying(
+    content::BrowserContext* browser_context,
+    int render_process_id,
+    int frame_tree_node_id,
+    network::mojom::URLLoaderFactoryRequest request,
+    network::mojom::URLLoaderFactoryPtrInfo target_factory) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
 
-  if (!self->request_handler_) {
-    self->request_handler_.reset(new BraveRequestHandler);
+  auto* self = Get(browser_context);
+
+  if (self->sequence_data_) {
+    // |sequence_data_| is deleted on |request_task_runner_|, after this task.
+    self->request_task_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(&SequenceData::StartProxying,
+                       base::Unretained(self->sequence_data_.get()),
+                       self->CreateContextSnapshot(), render_process_id,
+                       frame_tree_node_id, std::move(request),
+                       std::move(target_factory),
+                       self->request_id_generator_));
+    return;
   }
 
   auto proxy = std::make_unique<BraveProxyingURLLoaderFactory>(
-      self->request_handler_.get(), browser_context, render_process_id,
-      frame_tree_node_id, std::move(request), std::move(target_factory),
-      self->request_id_generator_,
+      self->request_handler_.get(), self->CreateContextSnapshot(),
+      render_process_id, frame_tree_node_id, std::move(request),
+      std::move(target_factory), self->request_id_generator_,
       base::BindOnce(&ResourceContextData::RemoveProxy,
                      self->weak_factory_.GetWeakPtr()));
 
@@ -71,17 +178,7 @@ BraveProxyingWebSocket* ResourceContextData::StartProxyingWebSocket(
     const url::Origin& origin) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
 
-  auto* self = static_cast<ResourceContextData*>(
-      browser_context->GetUserData(kResourceContextUserDataKey));
-  if (!self) {
-    self = new ResourceContextData();
-    browser_context->SetUserData(kResourceContextUserDataKey,
-                                  base::WrapUnique(self));
-  }
-
-  if (!self->request_handler_) {
-    self->request_handler_.reset(new BraveRequestHandler);
-  }
+  auto* self = Get(browser_context);
 
   network::ResourceRequest request;
   request.url = url;
@@ -94,9 +191,10 @@ BraveProxyingWebSocket* ResourceContextData::StartProxyingWebSocket(
   request.request_initiator = origin;
   request.render_frame_id = frame_id;
 
+  // WebSockets are few, they stay on the UI thread.
   auto proxy = std::make_unique<BraveProxyingWebSocket>(
       std::move(factory), request, std::move(handshake_client),
-      render_process_id, frame_tree_node_id, browser_context,
+      render_process_id, frame_tree_node_id, self->CreateContextSnapshot(),
       self->request_id_generator_, self->request_handler_.get(),
       base::BindOnce(&ResourceContextData::RemoveProxyWebSocket,
                      self->weak_factory_.GetWeakPtr()));
@@ -118,4 +216,3 @@ void ResourceContextData::RemoveProxyWebSocket(BraveProxyingWebSocket* proxy) {
   DCHECK(it != websocket_proxies_.end());
   websocket_proxies_.erase(it);
 }
-
@@ -6,6 +6,7 @@
 #ifndef BRAVE_BROWSER_NET_RESOURCE_CONTEXT_DATA_H_
 #define BRAVE_BROWSER_NET_RESOURCE_CONTEXT_DATA_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <set>
@@ -14,7 +15,10 @@
 #include "base/containers/unique_ptr_adapters.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequenced_task_runner.h"
 #include "base/supports_user_data.h"
+#include "components/prefs/pref_change_registrar.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/content_browser_client.h"
 #include "services/network/public/mojom/url_loader_factory.mojom.h"
@@ -24,6 +28,11 @@ class BraveProxyingURLLoaderFactory;
 class BraveProxyingWebSocket;
 class BraveRequestHandler;
 
+namespace brave {
+class ReferralHeaderIndex;
+class RequestContextSnapshot;
+}  // namespace brave
+
 namespace content {
 class BrowserContext;
 }
@@ -33,24 +42,22 @@ class RequestIDGenerator
     : public base::RefCountedThreadSafe<RequestIDGenerator> {
  public:
   RequestIDGenerator() = default;
-  int64_t Generate() {
-    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-    return ++id_;
-  }
+  // Safe from any sequence: proxies on the UI thread and on the request
+  // sequence share one generator per profile.
+  int64_t Generate() { return ++id_; }
 
  private:
   friend class base::RefCountedThreadSafe<RequestIDGenerator>;
   ~RequestIDGenerator() {}
 
-  // Although this initialization can be done in a thread other than the IO
-  // thread, we expect at least one memory barrier before actually calling
-  // Generate in the IO thread, so we don't protect the variable with a lock.
-  int64_t id_ = 0;
+  std::atomic<int64_t> id_{0};
   DISALLOW_COPY_AND_ASSIGN(RequestIDGenerator);
 };
 
 // Owns proxying factories for URLLoaders and websocket proxies. There is
-// one |ResourceContextData| per profile.
+// one |ResourceContextData| per profile. It lives on the UI thread; with
+// features::kBraveRequestsOffUIThread the URLLoader proxies and their request
+// handler live on a sequence of their own instead.
 class ResourceContextData : public base::SupportsUserData::Data {
  public:
   ~ResourceContextData() override;
@@ -79,10 +86,26 @@ class ResourceContextData : public base::SupportsUserData::Data {
   void RemoveProxyWebSocket(BraveProxyingWebSocket* proxy);
 
  private:
-  ResourceContextData();
+  // The request handler and URLLoader proxies that live on
+  // |request_task_runner_|.
+  class SequenceData;
+
+  explicit ResourceContextData(content::BrowserContext* browser_context);
+
+  static ResourceContextData* Get(content::BrowserContext* browser_context);
 
+  scoped_refptr<const brave::RequestContextSnapshot> CreateContextSnapshot();
+  void OnReferralHeadersChanged();
+
+  content::BrowserContext* const browser_context_;
   std::unique_ptr<BraveRequestHandler> request_handler_;
   scoped_refptr<RequestIDGenerator> request_id_generator_;
+  // Rebuilt whenever the referral headers pref changes.
+  scoped_refptr<const brave::ReferralHeaderIndex> referral_header_index_;
+  PrefChangeRegistrar local_state_change_registrar_;
+
+  scoped_refptr<base::SequencedTaskRunner> request_task_runner_;
+  std::unique_ptr<SequenceData, base::OnTaskRunnerDeleter> sequence_data_;
 
   std::set<std::unique_ptr<BraveProxyingURLLoaderFactory>,
            base::UniquePtrComparator>
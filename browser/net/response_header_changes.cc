@@ -0,0 +1,67 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/response_header_changes.h"
+
+#include <algorithm>
+
+#include "net/http/http_response_headers.h"
+
+namespace brave {
+
+ResponseHeaderChanges::ResponseHeaderChanges() = default;
+
+ResponseHeaderChanges::~ResponseHeaderChanges() = default;
+
+void ResponseHeaderChanges::ReplaceStatusLine(base::StringPiece status_line) {
+  status_line_ = status_line.as_string();
+}
+
+void ResponseHeaderChanges::RemoveHeader(base::StringPiece name) {
+  removed_headers_.insert(name.as_string());
+}
+
+void ResponseHeaderChanges::AddHeader(base::StringPiece name,
+                                      base::StringPiece value) {
+  added_headers_.emplace_back(name.as_string(), value.as_string());
+}
+
+bool ResponseHeaderChanges::empty() const {
+  return !status_line_ && removed_headers_.empty() && added_headers_.empty();
+}
+
+bool ResponseHeaderChanges::HasEffectOn(
+    const net::HttpResponseHeaders& headers) const {
+  if (status_line_ || !added_headers_.empty())
+    return true;
+  return std::any_of(
+      removed_headers_.begin(), removed_headers_.end(),
+      [&headers](const std::string& name) { return headers.HasHeader(name); });
+}
+
+void ResponseHeaderChanges::Apply(
+    const net::HttpResponseHeaders* original_response_headers,
+    scoped_refptr<net::HttpResponseHeaders>* override_response_headers) const {
+  const net::HttpResponseHeaders* headers =
+      override_response_headers->get() ? override_response_headers->get()
+                                       : original_response_headers;
+  if (!headers || !HasEffectOn(*headers))
+    return;
+
+  if (!override_response_headers->get()) {
+    *override_response_headers =
+        new net::HttpResponseHeaders(original_response_headers->raw_headers());
+  }
+  net::HttpResponseHeaders* override_headers = override_response_headers->get();
+  if (status_line_)
+    override_headers->ReplaceStatusLine(*status_line_);
+  // Rebuilds the headers once for all removals.
+  if (!removed_headers_.empty())
+    override_headers->RemoveHeaders(removed_headers_);
+  for (const auto& header : added_headers_)
+    override_headers->AddHeader(header.first, header.second);
+}
+
+}  // namespace brave
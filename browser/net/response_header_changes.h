@@ -0,0 +1,60 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_BROWSER_NET_RESPONSE_HEADER_CHANGES_H_
+#define BRAVE_BROWSER_NET_RESPONSE_HEADER_CHANGES_H_
+
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/optional.h"
+#include "base/strings/string_piece.h"
+
+namespace net {
+class HttpResponseHeaders;
+}
+
+namespace brave {
+
+// Changes to a response's headers, recorded by the OnHeadersReceived helpers
+// instead of each of them copying the headers. They are applied together
+// once all helpers have run, so a response is copied at most once, and not at
+// all if none of the changes would have an effect.
+class ResponseHeaderChanges {
+ public:
+  ResponseHeaderChanges();
+  ~ResponseHeaderChanges();
+
+  void ReplaceStatusLine(base::StringPiece status_line);
+  // Removals are applied before additions, so a header can be replaced by
+  // removing and then adding it.
+  void RemoveHeader(base::StringPiece name);
+  void AddHeader(base::StringPiece name, base::StringPiece value);
+
+  bool empty() const;
+
+  // Applies the changes to |*override_response_headers|, or else to a copy of
+  // |original_response_headers| which is stored there.
+  void Apply(const net::HttpResponseHeaders* original_response_headers,
+             scoped_refptr<net::HttpResponseHeaders>* override_response_headers)
+      const;
+
+ private:
+  bool HasEffectOn(const net::HttpResponseHeaders& headers) const;
+
+  base::Optional<std::string> status_line_;
+  std::unordered_set<std::string> removed_headers_;
+  std::vector<std::pair<std::string, std::string>> added_headers_;
+
+  DISALLOW_COPY_AND_ASSIGN(ResponseHeaderChanges);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_NET_RESPONSE_HEADER_CHANGES_H_
@@ -5,37 +5,29 @@
 
 #include "brave/browser/net/url_context.h"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
 
-#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "brave/browser/net/request_context_snapshot.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
-#include "brave/components/brave_webtorrent/browser/buildflags/buildflags.h"
-#include "brave/components/brave_webtorrent/browser/webtorrent_util.h"
-#include "brave/components/ipfs/buildflags/buildflags.h"
-#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
-#include "chrome/browser/profiles/profile.h"
-#include "content/public/browser/browser_thread.h"
+#include "brave/components/brave_shields/browser/shields_settings_snapshot.h"
 #include "net/base/isolation_info.h"
-
-#if BUILDFLAG(IPFS_ENABLED)
-#include "brave/components/ipfs/pref_names.h"
-#include "brave/components/ipfs/ipfs_constants.h"
-#include "components/prefs/testing_pref_service.h"
-#include "components/user_prefs/user_prefs.h"
-#endif
+#include "services/network/public/cpp/resource_request.h"
+#include "services/network/public/cpp/resource_request_body.h"
 
 namespace brave {
 
 namespace {
 
-std::string GetUploadData(const network::ResourceRequest& request) {
+std::string GetUploadData(const network::ResourceRequestBody& request_body) {
   std::string upload_data;
-  if (!request.request_body) {
-    return {};
-  }
-  const auto* elements = request.request_body->elements();
-  for (const network::DataElement& element : *elements) {
+  for (const network::DataElement& element : *request_body.elements()) {
     if (element.type() == network::mojom::DataElementType::kBytes) {
       upload_data.append(element.bytes(), element.length());
     }
@@ -44,45 +36,62 @@ std::string GetUploadData(const network::ResourceRequest& request) {
   return upload_data;
 }
 
+const std::string* InternHeaderName(base::StringPiece name) {
+  static base::NoDestructor<base::Lock> lock;
+  static base::NoDestructor<std::set<std::string, std::less<>>> names;
+  base::AutoLock auto_lock(*lock);
+  auto it = names->find(name);
+  if (it == names->end())
+    it = names->emplace(name).first;
+  return &*it;
+}
+
 }  // namespace
 
-BraveRequestInfo::BraveRequestInfo() = default;
+HeaderNameSet::HeaderNameSet() = default;
 
-BraveRequestInfo::BraveRequestInfo(const GURL& url) : request_url(url) {}
+HeaderNameSet::~HeaderNameSet() = default;
 
-BraveRequestInfo::~BraveRequestInfo() = default;
+void HeaderNameSet::insert(base::StringPiece name) {
+  names_.insert(InternHeaderName(name));
+}
 
-// static
-void BraveRequestInfo::FillCTX(const network::ResourceRequest& request,
-                               int render_process_id,
-                               int frame_tree_node_id,
-                               uint64_t request_identifier,
-                               content::BrowserContext* browser_context,
-                               std::shared_ptr<brave::BraveRequestInfo> old_ctx,
-                               std::shared_ptr<brave::BraveRequestInfo> ctx) {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-  ctx->request_identifier = request_identifier;
-  ctx->request_url = request.url;
-  // TODO(iefremov): Replace GURL with Origin
-  ctx->initiator_url =
-      request.request_initiator.value_or(url::Origin()).GetURL();
+bool HeaderNameSet::contains(base::StringPiece name) const {
+  return std::any_of(names_.begin(), names_.end(),
+                     [name](const std::string* it) { return *it == name; });
+}
 
-  ctx->referrer = request.referrer;
-  ctx->referrer_policy = request.referrer_policy;
+BraveRequestInfo::BraveRequestInfo()
+    : internal_redirect(false),
+      allow_brave_shields(true),
+      allow_ads(false),
+      allow_http_upgradable_resource(false),
+      allow_referrers(false),
+      is_webtorrent_disabled(false),
+      ipfs_local(true) {}
+
+BraveRequestInfo::BraveRequestInfo(const GURL& url) : BraveRequestInfo() {
+  request_url = url;
+}
 
-  ctx->resource_type =
-      static_cast<blink::mojom::ResourceType>(request.resource_type);
+BraveRequestInfo::BraveRequestInfo(const network::ResourceRequest& request,
+                                   int render_process_id,
+                                   int frame_tree_node_id,
+                                   uint64_t request_identifier)
+    : BraveRequestInfo() {
+  this->request_identifier = request_identifier;
+  request_url = request.url;
+  initiator_ = request.request_initiator;
 
-  ctx->is_webtorrent_disabled =
-#if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
-      !webtorrent::IsWebtorrentEnabled(browser_context);
-#else
-      true;
-#endif
+  referrer = request.referrer;
+  referrer_policy = request.referrer_policy;
 
-  ctx->render_frame_id = request.render_frame_id;
-  ctx->render_process_id = render_process_id;
-  ctx->frame_tree_node_id = frame_tree_node_id;
+  resource_type =
+      static_cast<blink::mojom::ResourceType>(request.resource_type);
+
+  render_frame_id = request.render_frame_id;
+  this->render_process_id = render_process_id;
+  this->frame_tree_node_id = frame_tree_node_id;
 
   // TODO(iefremov): remove tab_url. Change tab_origin from GURL to Origin.
   // ctx->tab_url = request.top_frame_origin;
@@ -91,41 +100,85 @@ void BraveRequestInfo::FillCTX(const network::ResourceRequest& request,
     // cross-site top-level navigations. Fortunately for now it is not a problem
     // for shields functionality. We should reconsider this machinery, also
     // given that this is always empty for subresources.
-    ctx->network_isolation_key =
+    network_isolation_key =
         request.trusted_params->isolation_info.network_isolation_key();
-    ctx->tab_origin = ctx->network_isolation_key
-            .GetTopFrameOrigin()
-            .value_or(url::Origin())
-            .GetURL();
   }
+  request_body_ = request.request_body;
+}
+
+BraveRequestInfo::~BraveRequestInfo() = default;
+
+const GURL& BraveRequestInfo::tab_origin() const {
+  if (tab_origin_)
+    return *tab_origin_;
+  tab_origin_ = network_isolation_key.GetTopFrameOrigin()
+                    .value_or(url::Origin())
+                    .GetURL();
   // TODO(iefremov): We still need this for WebSockets, currently
   // |AddChannelRequest| provides only old-fashioned |site_for_cookies|.
   // (See |BraveProxyingWebSocket|).
-  if (ctx->tab_origin.is_empty()) {
-    ctx->tab_origin = brave_shields::BraveShieldsWebContentsObserver::
-                          GetTabURLFromRenderFrameInfo(ctx->render_process_id,
-                                                       ctx->render_frame_id,
-                                                       ctx->frame_tree_node_id)
-                              .GetOrigin();
+  if (tab_origin_->is_empty()) {
+    tab_origin_ = brave_shields::BraveShieldsWebContentsObserver::
+                      GetTabURLFromRenderFrameInfo(render_process_id,
+                                                   render_frame_id,
+                                                   frame_tree_node_id)
+                          .GetOrigin();
+  }
+  return *tab_origin_;
+}
+
+void BraveRequestInfo::set_tab_origin(const GURL& tab_origin) {
+  tab_origin_ = tab_origin;
+}
+
+const GURL& BraveRequestInfo::initiator_url() const {
+  // TODO(iefremov): Replace GURL with Origin
+  if (!initiator_url_)
+    initiator_url_ = initiator_.value_or(url::Origin()).GetURL();
+  return *initiator_url_;
+}
+
+void BraveRequestInfo::set_initiator_url(const GURL& initiator_url) {
+  initiator_url_ = initiator_url;
+}
+
+const std::string& BraveRequestInfo::upload_data() const {
+  if (!upload_data_) {
+    upload_data_ =
+        request_body_ ? GetUploadData(*request_body_) : std::string();
   }
+  return *upload_data_;
+}
 
-  Profile* profile = Profile::FromBrowserContext(browser_context);
-  auto* map = HostContentSettingsMapFactory::GetForProfile(profile);
-  ctx->allow_brave_shields =
-      brave_shields::GetBraveShieldsEnabled(map, ctx->tab_origin);
-  ctx->allow_ads = brave_shields::GetAdControlType(
-      map, ctx->tab_origin) == brave_shields::ControlType::ALLOW;
-  ctx->allow_http_upgradable_resource =
-      !brave_shields::GetHTTPSEverywhereEnabled(map, ctx->tab_origin);
-  ctx->allow_referrers = brave_shields::AllowReferrers(map, ctx->tab_origin);
-  ctx->upload_data = GetUploadData(request);
-
-#if BUILDFLAG(IPFS_ENABLED)
-  auto* prefs = user_prefs::UserPrefs::Get(browser_context);
-  ctx->ipfs_local = static_cast<ipfs::IPFSResolveMethodTypes>(
-      prefs->GetInteger(kIPFSResolveMethod)) ==
-          ipfs::IPFSResolveMethodTypes::IPFS_LOCAL;
-#endif
+// static
+std::shared_ptr<BraveRequestInfo> BraveRequestInfo::MakeCTX(
+    const network::ResourceRequest& request,
+    int render_process_id,
+    int frame_tree_node_id,
+    uint64_t request_identifier,
+    scoped_refptr<const RequestContextSnapshot> snapshot,
+    std::shared_ptr<brave::BraveRequestInfo> old_ctx) {
+  auto ctx = std::make_shared<BraveRequestInfo>(
+      request, render_process_id, frame_tree_node_id, request_identifier);
+
+  ctx->is_webtorrent_disabled = snapshot->is_webtorrent_disabled();
+
+  // Look the settings up by the top frame origin while there is one, so that
+  // the tab_origin() GURL is only built if a helper asks for it.
+  const base::Optional<url::Origin>& top_frame_origin =
+      ctx->network_isolation_key.GetTopFrameOrigin();
+  scoped_refptr<const brave_shields::ShieldsSettingsSnapshot> settings =
+      top_frame_origin && !top_frame_origin->opaque()
+          ? snapshot->shields_settings()->Get(*top_frame_origin)
+          : snapshot->shields_settings()->Get(ctx->tab_origin());
+  ctx->allow_brave_shields = settings->brave_shields_enabled;
+  ctx->allow_ads = settings->ad_control == brave_shields::ControlType::ALLOW;
+  ctx->allow_http_upgradable_resource = !settings->https_everywhere_enabled;
+  ctx->allow_referrers = settings->allow_referrers;
+
+  ctx->ipfs_local = snapshot->ipfs_local();
+  ctx->referral_header_index = snapshot->referral_header_index();
+  ctx->context_snapshot = std::move(snapshot);
 
   // TODO(fmarier): remove this once the hacky code in
   // brave_proxying_url_loader_factory.cc is refactored. See
@@ -134,6 +187,7 @@ void BraveRequestInfo::FillCTX(const network::ResourceRequest& request,
     ctx->internal_redirect = old_ctx->internal_redirect;
     ctx->redirect_source = old_ctx->redirect_source;
   }
+  return ctx;
 }
 
 }  // namespace brave
@@ -7,27 +7,32 @@
 #define BRAVE_BROWSER_NET_URL_CONTEXT_H_
 
 #include <memory>
-#include <set>
 #include <string>
 
+#include "base/containers/flat_set.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/optional.h"
+#include "base/strings/string_piece.h"
+#include "brave/browser/net/response_header_changes.h"
 #include "net/base/network_isolation_key.h"
 #include "net/http/http_request_headers.h"
 #include "net/http/http_response_headers.h"
 #include "net/url_request/referrer_policy.h"
 #include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
 #include "url/gurl.h"
+#include "url/origin.h"
 
 class BraveRequestHandler;
 
-namespace content {
-class BrowserContext;
-}
-
 namespace network {
+class ResourceRequestBody;
 struct ResourceRequest;
 }
 
 namespace brave {
+class ReferralHeaderIndex;
+class RequestContextSnapshot;
 struct BraveRequestInfo;
 using ResponseCallback = base::Callback<void()>;
 }  // namespace brave
@@ -50,19 +55,55 @@ enum BraveNetworkDelegateEventType {
 
 enum BlockedBy { kNotBlocked, kAdBlocked, kOtherBlocked };
 
+// A set of request header names. Names are interned for the life of the
+// process, so adding one to a request copies a pointer, not a string.
+class HeaderNameSet {
+ public:
+  using const_iterator = base::flat_set<const std::string*>::const_iterator;
+
+  HeaderNameSet();
+  ~HeaderNameSet();
+
+  void insert(base::StringPiece name);
+  bool contains(base::StringPiece name) const;
+
+  bool empty() const { return names_.empty(); }
+  size_t size() const { return names_.size(); }
+  const_iterator begin() const { return names_.begin(); }
+  const_iterator end() const { return names_.end(); }
+
+ private:
+  base::flat_set<const std::string*> names_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeaderNameSet);
+};
+
 struct BraveRequestInfo {
   BraveRequestInfo();
 
   // For tests, should not be used directly.
   explicit BraveRequestInfo(const GURL& url);
 
+  // Copies what the request stages need from |request|. URLs which are
+  // already parsed are copied as is; those derived from origins or from the
+  // request body are only built if a helper asks for them.
+  BraveRequestInfo(const network::ResourceRequest& request,
+                   int render_process_id,
+                   int frame_tree_node_id,
+                   uint64_t request_identifier);
+
   ~BraveRequestInfo();
   GURL request_url;
-  GURL tab_origin;
   GURL tab_url;
-  GURL initiator_url;
 
-  bool internal_redirect = false;
+  // The top frame origin of |network_isolation_key|, or else the origin of
+  // the tab URL the frame was last seen with.
+  const GURL& tab_origin() const;
+  void set_tab_origin(const GURL& tab_origin);
+
+  const GURL& initiator_url() const;
+  void set_initiator_url(const GURL& initiator_url);
+
   GURL redirect_source;
 
   GURL referrer;
@@ -71,11 +112,16 @@ struct BraveRequestInfo {
   base::Optional<GURL> new_referrer;
 
   std::string new_url_spec;
-  bool allow_brave_shields = true;
-  bool allow_ads = false;
-  bool allow_http_upgradable_resource = false;
-  bool allow_referrers = false;
-  bool is_webtorrent_disabled = false;
+
+  // Packed together; the defaults are set by the constructors.
+  bool internal_redirect : 1;
+  bool allow_brave_shields : 1;
+  bool allow_ads : 1;
+  bool allow_http_upgradable_resource : 1;
+  bool allow_referrers : 1;
+  bool is_webtorrent_disabled : 1;
+  bool ipfs_local : 1;
+
   int render_process_id = 0;
   int render_frame_id = 0;
   int frame_tree_node_id = 0;
@@ -85,18 +131,22 @@ struct BraveRequestInfo {
   net::HttpRequestHeaders* headers = nullptr;
   // The following two sets are populated by |OnBeforeStartTransactionCallback|.
   // |set_headers| contains headers which values were added or modified.
-  std::set<std::string> set_headers;
-  std::set<std::string> removed_headers;
+  HeaderNameSet set_headers;
+  HeaderNameSet removed_headers;
   const net::HttpResponseHeaders* original_response_headers = nullptr;
   scoped_refptr<net::HttpResponseHeaders>* override_response_headers = nullptr;
+  // Changes the |OnHeadersReceivedCallback|s make to the response headers.
+  // They are applied to |override_response_headers| once all of them ran.
+  ResponseHeaderChanges response_header_changes;
 
   GURL* allowed_unsafe_redirect_url = nullptr;
   BraveNetworkDelegateEventType event_type = kUnknownEventType;
-  const base::ListValue* referral_headers_list = nullptr;
+  const ReferralHeaderIndex* referral_header_index = nullptr;
+  // The profile state the request was set up with. Null in most unit tests.
+  scoped_refptr<const RequestContextSnapshot> context_snapshot;
   BlockedBy blocked_by = kNotBlocked;
   bool cancel_request_explicitly = false;
   std::string mock_data_url;
-  bool ipfs_local = true;
 
   net::NetworkIsolationKey network_isolation_key = net::NetworkIsolationKey();
 
@@ -108,15 +158,16 @@ struct BraveRequestInfo {
       static_cast<blink::mojom::ResourceType>(-1);
   blink::mojom::ResourceType resource_type = kInvalidResourceType;
 
-  std::string upload_data;
+  // The bytes elements of the request body, concatenated.
+  const std::string& upload_data() const;
 
-  static void FillCTX(const network::ResourceRequest& request,
-                      int render_process_id,
-                      int frame_tree_node_id,
-                      uint64_t request_identifier,
-                      content::BrowserContext* browser_context,
-                      std::shared_ptr<brave::BraveRequestInfo> old_ctx,
-                      std::shared_ptr<brave::BraveRequestInfo> ctx);
+  static std::shared_ptr<BraveRequestInfo> MakeCTX(
+      const network::ResourceRequest& request,
+      int render_process_id,
+      int frame_tree_node_id,
+      uint64_t request_identifier,
+      scoped_refptr<const RequestContextSnapshot> snapshot,
+      std::shared_ptr<brave::BraveRequestInfo> old_ctx);
 
  private:
   // Please don't add any more friends here if it can be avoided.
@@ -125,6 +176,14 @@ struct BraveRequestInfo {
 
   GURL* new_url = nullptr;
 
+  // Sources of the lazily built values above, and their caches. A request
+  // info is only used on one sequence at a time.
+  base::Optional<url::Origin> initiator_;
+  scoped_refptr<network::ResourceRequestBody> request_body_;
+  mutable base::Optional<GURL> tab_origin_;
+  mutable base::Optional<GURL> initiator_url_;
+  mutable base::Optional<std::string> upload_data_;
+
   DISALLOW_COPY_AND_ASSIGN(BraveRequestInfo);
 };
 
@@ -0,0 +1,170 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/url_context.h"
+
+#include <memory>
+#include <string>
+
+#include "base/memory/ref_counted.h"
+#include "brave/browser/net/request_context_snapshot.h"
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "brave/components/brave_shields/browser/shields_settings_snapshot.h"
+#include "brave/test/base/scoped_allocation_counter.h"
+#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
+#include "chrome/test/base/testing_profile.h"
+#include "content/public/test/browser_task_environment.h"
+#include "net/base/isolation_info.h"
+#include "net/http/http_request_headers.h"
+#include "services/network/public/cpp/resource_request.h"
+#include "services/network/public/cpp/resource_request_body.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+#include "url/origin.h"
+
+namespace brave {
+
+namespace {
+
+network::ResourceRequest MakeSubresourceRequest() {
+  network::ResourceRequest request;
+  request.url = GURL("https://cdn.example.com/static/js/banner.js?id=12345");
+  request.referrer = GURL("https://www.example.com/articles/index.html");
+  request.request_initiator =
+      url::Origin::Create(GURL("https://www.example.com"));
+  request.trusted_params = network::ResourceRequest::TrustedParams();
+  request.trusted_params->isolation_info =
+      net::IsolationInfo::CreateForInternalRequest(
+          url::Origin::Create(GURL("https://www.example.com")));
+  return request;
+}
+
+}  // namespace
+
+TEST(BraveRequestInfoTest, FromResourceRequest) {
+  network::ResourceRequest request = MakeSubresourceRequest();
+  request.request_body =
+      network::ResourceRequestBody::CreateFromBytes("name=value", 10);
+  BraveRequestInfo ctx(request, 1, 2, 3);
+
+  EXPECT_EQ(request.url, ctx.request_url);
+  EXPECT_EQ(request.referrer, ctx.referrer);
+  EXPECT_EQ(1, ctx.render_process_id);
+  EXPECT_EQ(2, ctx.frame_tree_node_id);
+  EXPECT_EQ(3u, ctx.request_identifier);
+  EXPECT_EQ(GURL("https://www.example.com/"), ctx.initiator_url());
+  EXPECT_EQ(GURL("https://www.example.com/"), ctx.tab_origin());
+  EXPECT_EQ("name=value", ctx.upload_data());
+
+  EXPECT_TRUE(ctx.allow_brave_shields);
+  EXPECT_FALSE(ctx.allow_ads);
+  EXPECT_TRUE(ctx.ipfs_local);
+}
+
+TEST(BraveRequestInfoTest, DerivedUrlsCanBeOverridden) {
+  BraveRequestInfo ctx(MakeSubresourceRequest(), 1, 2, 3);
+  ctx.set_tab_origin(GURL("https://tab.example.com/"));
+  ctx.set_initiator_url(GURL());
+
+  EXPECT_EQ(GURL("https://tab.example.com/"), ctx.tab_origin());
+  EXPECT_TRUE(ctx.initiator_url().is_empty());
+}
+
+TEST(BraveRequestInfoTest, HeaderNamesAreInterned) {
+  BraveRequestInfo first(GURL("https://a.com/"));
+  BraveRequestInfo second(GURL("https://b.com/"));
+  first.set_headers.insert(net::HttpRequestHeaders::kUserAgent);
+  first.set_headers.insert(net::HttpRequestHeaders::kUserAgent);
+  second.set_headers.insert(std::string(net::HttpRequestHeaders::kUserAgent));
+
+  EXPECT_EQ(1u, first.set_headers.size());
+  EXPECT_TRUE(first.set_headers.contains(net::HttpRequestHeaders::kUserAgent));
+  EXPECT_FALSE(first.removed_headers.contains(
+      net::HttpRequestHeaders::kUserAgent));
+  EXPECT_EQ(*first.set_headers.begin(), *second.set_headers.begin());
+}
+
+#if BUILDFLAG(USE_ALLOCATOR_SHIM)
+namespace {
+
+// What BraveRequestInfo::FillCTX did for every stage before MakeCTX replaced
+// it, kept to compare against: the initiator and tab origins were parsed into
+// GURLs up front and each shields setting was read from the content settings
+// map.
+std::shared_ptr<BraveRequestInfo> FillCTXForComparison(
+    const network::ResourceRequest& request,
+    int render_process_id,
+    int frame_tree_node_id,
+    uint64_t request_identifier,
+    HostContentSettingsMap* map) {
+  auto ctx = std::make_shared<BraveRequestInfo>();
+  ctx->request_identifier = request_identifier;
+  ctx->request_url = request.url;
+  ctx->set_initiator_url(
+      request.request_initiator.value_or(url::Origin()).GetURL());
+  ctx->referrer = request.referrer;
+  ctx->referrer_policy = request.referrer_policy;
+  ctx->resource_type =
+      static_cast<blink::mojom::ResourceType>(request.resource_type);
+  ctx->render_frame_id = request.render_frame_id;
+  ctx->render_process_id = render_process_id;
+  ctx->frame_tree_node_id = frame_tree_node_id;
+  ctx->network_isolation_key =
+      request.trusted_params->isolation_info.network_isolation_key();
+  ctx->set_tab_origin(ctx->network_isolation_key.GetTopFrameOrigin()
+                          .value_or(url::Origin())
+                          .GetURL());
+  ctx->allow_brave_shields =
+      brave_shields::GetBraveShieldsEnabled(map, ctx->tab_origin());
+  ctx->allow_ads = brave_shields::GetAdControlType(map, ctx->tab_origin()) ==
+                   brave_shields::ControlType::ALLOW;
+  ctx->allow_http_upgradable_resource =
+      !brave_shields::GetHTTPSEverywhereEnabled(map, ctx->tab_origin());
+  ctx->allow_referrers = brave_shields::AllowReferrers(map, ctx->tab_origin());
+  return ctx;
+}
+
+}  // namespace
+
+TEST(BraveRequestInfoTest, FewAllocationsPerStage) {
+  content::BrowserTaskEnvironment task_environment;
+  TestingProfile profile;
+  HostContentSettingsMap* map =
+      HostContentSettingsMapFactory::GetForProfile(&profile);
+  auto snapshot = base::MakeRefCounted<RequestContextSnapshot>(
+      brave_shields::ShieldsSettingsCache::FromBrowserContext(&profile),
+      base::MakeRefCounted<RequestContextPrefs>(false, true), nullptr,
+      nullptr);
+  const network::ResourceRequest request = MakeSubresourceRequest();
+
+  // The first stage of a page's first request reads the shields settings from
+  // the map; the other stages and requests find them in the cache.
+  auto first_ctx =
+      BraveRequestInfo::MakeCTX(request, 1, 2, 3, snapshot, nullptr);
+  ASSERT_TRUE(first_ctx->allow_brave_shields);
+
+  size_t make_ctx_allocations;
+  {
+    ScopedAllocationCounter counter;
+    auto ctx =
+        BraveRequestInfo::MakeCTX(request, 1, 2, 3, snapshot, first_ctx);
+    make_ctx_allocations = counter.count();
+  }
+
+  size_t fill_ctx_allocations;
+  {
+    ScopedAllocationCounter counter;
+    auto ctx = FillCTXForComparison(request, 1, 2, 3, map);
+    fill_ctx_allocations = counter.count();
+  }
+
+  // The control block and the request and referrer URL specs. The settings
+  // are looked up by the top frame origin, without building a GURL.
+  EXPECT_LE(make_ctx_allocations, 3u);
+  EXPECT_LE(make_ctx_allocations * 10, fill_ctx_allocations);
+}
+#endif  // BUILDFLAG(USE_ALLOCATOR_SHIM)
+
+}  // namespace brave
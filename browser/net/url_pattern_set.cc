@@ -0,0 +1,71 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/url_pattern_set.h"
+
+#include "url/gurl.h"
+
+namespace brave {
+
+UrlPatternSet::UrlPatternSet() = default;
+UrlPatternSet::UrlPatternSet(UrlPatternSet&& other) = default;
+UrlPatternSet& UrlPatternSet::operator=(UrlPatternSet&& other) = default;
+UrlPatternSet::~UrlPatternSet() = default;
+
+void UrlPatternSet::Add(int id,
+                        const URLPattern& pattern,
+                        MatchType match_type) {
+  const size_t index = entries_.size();
+  entries_.push_back({id, pattern, match_type});
+  if (pattern.host().empty())
+    any_host_.push_back(index);
+  else if (pattern.match_subdomains())
+    domains_[pattern.host()].push_back(index);
+  else
+    hosts_[pattern.host()].push_back(index);
+}
+
+base::flat_set<int> UrlPatternSet::MatchAll(const GURL& url) const {
+  base::flat_set<int> ids;
+  MatchEntries(any_host_, url, &ids);
+
+  base::StringPiece host = url.host_piece();
+  if (!host.empty() && host.back() == '.')
+    host.remove_suffix(1);
+  if (host.empty())
+    return ids;
+
+  auto it = hosts_.find(host);
+  if (it != hosts_.end())
+    MatchEntries(it->second, url, &ids);
+  // Try the host itself and then each parent domain.
+  for (base::StringPiece domain = host;;) {
+    it = domains_.find(domain);
+    if (it != domains_.end())
+      MatchEntries(it->second, url, &ids);
+    const size_t dot = domain.find('.');
+    if (dot == base::StringPiece::npos)
+      break;
+    domain.remove_prefix(dot + 1);
+  }
+  return ids;
+}
+
+void UrlPatternSet::MatchEntries(const std::vector<size_t>& candidates,
+                                 const GURL& url,
+                                 base::flat_set<int>* ids) const {
+  for (size_t index : candidates) {
+    const Entry& entry = entries_[index];
+    if (ids->count(entry.id))
+      continue;
+    const bool matches = entry.match_type == MatchType::kHost
+                             ? entry.pattern.MatchesHost(url)
+                             : entry.pattern.MatchesURL(url);
+    if (matches)
+      ids->insert(entry.id);
+  }
+}
+
+}  // namespace brave
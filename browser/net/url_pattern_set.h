@@ -0,0 +1,74 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_BROWSER_NET_URL_PATTERN_SET_H_
+#define BRAVE_BROWSER_NET_URL_PATTERN_SET_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/containers/flat_set.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "extensions/common/url_pattern.h"
+
+class GURL;
+
+namespace brave {
+
+// A set of URLPatterns, each tagged with an id, indexed by host so that a
+// lookup only tests the patterns that can match the request's host instead
+// of every pattern in turn. Several patterns may share an id. Build the set
+// once and reuse it; lookups don't modify it and are safe from any thread.
+class UrlPatternSet {
+ public:
+  enum class MatchType {
+    // URLPattern::MatchesURL
+    kURL,
+    // URLPattern::MatchesHost, ignoring scheme and path.
+    kHost,
+  };
+
+  UrlPatternSet();
+  UrlPatternSet(UrlPatternSet&& other);
+  UrlPatternSet& operator=(UrlPatternSet&& other);
+  ~UrlPatternSet();
+
+  void Add(int id,
+           const URLPattern& pattern,
+           MatchType match_type = MatchType::kURL);
+
+  // Returns the ids of all patterns that match |url|.
+  base::flat_set<int> MatchAll(const GURL& url) const;
+
+ private:
+  struct Entry {
+    int id;
+    URLPattern pattern;
+    MatchType match_type;
+  };
+  using HostIndex =
+      base::flat_map<std::string, std::vector<size_t>, std::less<>>;
+
+  void MatchEntries(const std::vector<size_t>& candidates,
+                    const GURL& url,
+                    base::flat_set<int>* ids) const;
+
+  std::vector<Entry> entries_;
+  // Patterns for exactly one host.
+  HostIndex hosts_;
+  // Patterns for a host and all of its subdomains.
+  HostIndex domains_;
+  // Patterns matching any host.
+  std::vector<size_t> any_host_;
+
+  DISALLOW_COPY_AND_ASSIGN(UrlPatternSet);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_NET_URL_PATTERN_SET_H_
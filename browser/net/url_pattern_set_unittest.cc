@@ -0,0 +1,126 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/url_pattern_set.h"
+
+#include "brave/browser/net/brave_static_request_rules.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+using brave::StaticRequestRuleMatches;
+using brave::UrlPatternSet;
+
+namespace {
+
+const int kAllSchemes = URLPattern::SCHEME_ALL;
+
+}  // namespace
+
+TEST(UrlPatternSetTest, MatchAll) {
+  UrlPatternSet set;
+  set.Add(1, URLPattern(kAllSchemes, "https://example.com/a/*"));
+  set.Add(2, URLPattern(kAllSchemes, "*://*.example.com/*"));
+  set.Add(3, URLPattern(kAllSchemes, "*://*/*.png"));
+  set.Add(4, URLPattern(kAllSchemes, "https://other.com/"),
+          UrlPatternSet::MatchType::kHost);
+  set.Add(2, URLPattern(kAllSchemes, "*://another.org/*"));
+
+  EXPECT_EQ(base::flat_set<int>({1, 2}),
+            set.MatchAll(GURL("https://example.com/a/b")));
+  EXPECT_EQ(base::flat_set<int>({2}),
+            set.MatchAll(GURL("http://sub.example.com/a/b")));
+  EXPECT_EQ(base::flat_set<int>({2, 3}),
+            set.MatchAll(GURL("http://a.b.example.com/img.png")));
+  EXPECT_EQ(base::flat_set<int>({3}),
+            set.MatchAll(GURL("http://notexample.com/img.png")));
+  EXPECT_EQ(base::flat_set<int>({4}),
+            set.MatchAll(GURL("http://other.com/any/path")));
+  EXPECT_EQ(base::flat_set<int>(),
+            set.MatchAll(GURL("http://sub.other.com/")));
+  EXPECT_EQ(base::flat_set<int>({2}),
+            set.MatchAll(GURL("https://another.org/")));
+  EXPECT_EQ(base::flat_set<int>(), set.MatchAll(GURL("https://brave.com/")));
+}
+
+// The indexed lookup gives the same answer as testing every static pattern
+// one at a time.
+TEST(UrlPatternSetTest, StaticRequestRulesMatchPatterns) {
+  const char* urls[] = {
+      "https://brave.com/",
+      "https://www.brave.com/",
+      "http://www.brave.com/",
+      "https://static1.bravesoftware.com/x.js",
+      "https://www.googleapis.com/geolocation/v1/geolocate?key=2_3_4",
+      "https://www.googleapis.com/geolocation/v1/geolocate",
+      "https://safebrowsing.googleapis.com/v4/threatListUpdates",
+      "http://safebrowsing.googleapis.com/v4",
+      "https://sb-ssl.google.com/safebrowsing/clientreport/download",
+      "https://sb-ssl.google.com/safebrowsing/clientreport/incident",
+      "https://safebrowsing.google.com/safebrowsing/report",
+      "https://safebrowsing.google.com/safebrowsing/uploads/chrome",
+      "https://safebrowsing.google.com/safebrowsing",
+      "https://clients2.googleusercontent.com/crx/blobs/QgAAAC6zw0qH2DJtn/"
+      "AKOfY.crx",
+      "https://www.gstatic.com/autofill/hourly/bins.bin",
+      "https://www.gstatic.com/images/branding/product/1x/translate_24dp.png",
+      "http://dl.google.com/release2/chrome_component/AJ4r388iQSJq_4819/"
+      "4819_all_crl-set-5934829738003798040.data.crx3",
+      "https://r2---sn-8xgp1vo-qxoe.gvt1.com/edgedl/release2/"
+      "chrome_component/AJ4r388iQSJq_4819/4819_all_crl-set.crx3",
+      "https://www.google.com/dl/release2/chrome_component/LLjIBPPmveI_4988/"
+      "4988_all_crl-set-6296993568184466307.data.crx3",
+      "https://storage.googleapis.com/update-delta/"
+      "hfnkpimlhhgieaddgfemjhofmfblmnib/5646/5645/"
+      "b855e9ab5c1da9b1bd8a1bf3bcbd5b4b4e7a3bd4eb5d55c96c8c98c2b0546d48.crxd",
+      "https://r3---sn-n4v7sn7y.gvt1.com/edgedl/chromewebstore/L2Nocm9tZV9"
+      "leHRlbnNpb24vYmxvYnMvYjYxQUFXaFBmeUtPVDRQcTB4ZWVVUEl0Zw/"
+      "1.3.0_pkedcjkdefgpdelpbcmbmeomcjbeemfm.crx",
+      "https://redirector.gvt1.com/edgedl/widevine-cdm/"
+      "oimompecagnajdejgnnjijobebaeigek.crx",
+      "https://gvt1.com/whatever",
+      "https://dl.google.com/widevine/oimompecagnajdejgnnjijobebaeigek.crx",
+      "https://dl.google.com/chrome/install/",
+      "https://clients4.google.com/chrome-sync/dev",
+      "https://clients4.google.com/",
+      "https://bugs.chromium.org/p/chromium/issues/entry?template=Crash",
+      "https://bugs.chromium.org/p/chromium/issues/list",
+      "https://update.googleapis.com/service/update2/json",
+      "https://update.googleapis.com/service/update2/json?cup2key=6:123",
+      "http://update.googleapis.com/service/update2/json",
+      "https://clients2.google.com/service/update2/crx",
+      "https://translate.googleapis.com/translate_a/element.js?cb=cb",
+      "https://translate.googleapis.com/translate_a/l?client=chrome&hl=en",
+      "https://translate.googleapis.com/translate_a/t?anno=3&client=te_lib&a=b",
+      "https://translate.googleapis.com/element/TE_20200506_00/e/js/element/"
+      "element_main.js",
+      "https://translate.googleapis.com/translate_static/js/element/main.js",
+      "https://translate.googleapis.com/translate_static/css/"
+      "translateelement.css",
+      "https://translate.google.com/gen204?client=te_lib",
+      "https://example.com./",
+      "file:///etc/passwd",
+      "about:blank",
+  };
+
+  const auto& rule_patterns = brave::GetStaticRequestRulePatterns();
+  for (const char* spec : urls) {
+    const GURL url(spec);
+    const StaticRequestRuleMatches matches =
+        brave::MatchStaticRequestRules(url);
+    for (const auto& rule_pattern : rule_patterns) {
+      bool expected = false;
+      for (const auto& other : rule_patterns) {
+        if (other.rule != rule_pattern.rule)
+          continue;
+        URLPattern pattern(other.valid_schemes, other.pattern);
+        expected |= other.match_type == UrlPatternSet::MatchType::kHost
+                        ? pattern.MatchesHost(url)
+                        : pattern.MatchesURL(url);
+      }
+      EXPECT_EQ(expected, matches.Has(rule_pattern.rule))
+          << spec << " " << rule_pattern.pattern;
+    }
+  }
+}
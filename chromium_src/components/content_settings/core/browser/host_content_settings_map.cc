@@ -2,11 +2,36 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this file,
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include "components/content_settings/core/browser/host_content_settings_map.h"
+
 #include "brave/components/content_settings/core/browser/brave_content_settings_ephemeral_provider.h"
 #include "brave/components/content_settings/core/browser/brave_content_settings_pref_provider.h"
 
 #define EphemeralProvider BraveEphemeralProvider
 #define PrefProvider BravePrefProvider
+#define GetWebsiteSetting GetWebsiteSetting_ChromiumImpl
 #include "../../../../../../components/content_settings/core/browser/host_content_settings_map.cc"
+#undef GetWebsiteSetting
 #undef EphemeralProvider
 #undef PrefProvider
+
+std::unique_ptr<base::Value> HostContentSettingsMap::GetWebsiteSetting(
+    const GURL& primary_url,
+    const GURL& secondary_url,
+    ContentSettingsType content_type,
+    const std::string& resource_identifier,
+    content_settings::SettingInfo* info) const {
+  // Cookie settings are looked up on every cookie access, so have the Brave
+  // pref provider find the first cookie rule matching these URLs through its
+  // index rather than walk all of its cookie rules.
+  if (content_type == ContentSettingsType::COOKIES) {
+    content_settings::BravePrefProvider::ScopedCookieLookup cookie_lookup(
+        primary_url, secondary_url);
+    return GetWebsiteSetting_ChromiumImpl(primary_url, secondary_url,
+                                          content_type, resource_identifier,
+                                          info);
+  }
+  return GetWebsiteSetting_ChromiumImpl(primary_url, secondary_url,
+                                        content_type, resource_identifier,
+                                        info);
+}
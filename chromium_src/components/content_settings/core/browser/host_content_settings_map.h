@@ -0,0 +1,38 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_CHROMIUM_SRC_COMPONENTS_CONTENT_SETTINGS_CORE_BROWSER_HOST_CONTENT_SETTINGS_MAP_H_
+#define BRAVE_CHROMIUM_SRC_COMPONENTS_CONTENT_SETTINGS_CORE_BROWSER_HOST_CONTENT_SETTINGS_MAP_H_
+
+// Pull in the includes of host_content_settings_map.h that could use
+// GetWebsiteSetting as a name.
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/observer_list.h"
+#include "base/optional.h"
+#include "components/content_settings/core/browser/content_settings_observer.h"
+#include "components/content_settings/core/browser/user_modifiable_provider.h"
+#include "components/content_settings/core/common/content_settings.h"
+#include "components/content_settings/core/common/content_settings_pattern.h"
+#include "components/content_settings/core/common/content_settings_types.h"
+#include "components/keyed_service/core/refcounted_keyed_service.h"
+#include "components/prefs/pref_change_registrar.h"
+
+#define GetWebsiteSetting                                    \
+  GetWebsiteSetting_ChromiumImpl(                            \
+      const GURL& primary_url, const GURL& secondary_url,    \
+      ContentSettingsType content_type,                      \
+      const std::string& resource_identifier,                \
+      content_settings::SettingInfo* info) const;            \
+  std::unique_ptr<base::Value> GetWebsiteSetting
+
+#include "../../../../../../components/content_settings/core/browser/host_content_settings_map.h"
+#undef GetWebsiteSetting
+
+#endif  // BRAVE_CHROMIUM_SRC_COMPONENTS_CONTENT_SETTINGS_CORE_BROWSER_HOST_CONTENT_SETTINGS_MAP_H_
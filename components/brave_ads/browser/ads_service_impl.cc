@@ -64,6 +64,7 @@
 #if !defined(OS_ANDROID)
 #include "chrome/browser/ui/browser.h"
 #include "chrome/browser/ui/browser_finder.h"
+#include "chrome/browser/ui/browser_list.h"
 #endif
 #include "chrome/browser/ui/browser_navigator_params.h"
 #include "chrome/browser/first_run/first_run.h"
@@ -546,6 +547,10 @@ GetAutoDetectedAdsSubdivisionTargetingCode() const {
 void AdsServiceImpl::Shutdown() {
   BackgroundHelper::GetInstance()->RemoveObserver(this);
 
+#if !defined(OS_ANDROID)
+  BrowserList::RemoveObserver(this);
+#endif
+
   g_brave_browser_process->user_model_file_service()->RemoveObserver(this);
 
   for (auto* const url_loader : url_loaders_) {
@@ -832,6 +837,10 @@ void AdsServiceImpl::OnEnsureBaseDirectoryExists(
 
   BackgroundHelper::GetInstance()->AddObserver(this);
 
+#if !defined(OS_ANDROID)
+  BrowserList::AddObserver(this);
+#endif
+
   bat_ads_service_->Create(
       bat_ads_client_receiver_.BindNewEndpointAndPassRemote(),
       bat_ads_.BindNewEndpointAndPassReceiver(),
@@ -2251,4 +2260,24 @@ void AdsServiceImpl::OnForeground() {
   bat_ads_->OnForeground();
 }
 
+#if !defined(OS_ANDROID)
+void AdsServiceImpl::OnBrowserRemoved(
+    Browser* browser) {
+  if (!connected() || browser->profile() != profile_) {
+    return;
+  }
+
+  for (auto* const open_browser : *BrowserList::GetInstance()) {
+    if (open_browser->profile() == profile_) {
+      return;
+    }
+  }
+
+  // Save pending ads state when the last browser for the profile closes, as
+  // the ads service can no longer write files once the profile is being
+  // destroyed
+  bat_ads_->Flush();
+}
+#endif
+
 }  // namespace brave_ads
@@ -29,6 +29,7 @@
 #include "brave/components/brave_user_model/browser/user_model_file_service.h"
 #include "brave/components/services/bat_ads/public/interfaces/bat_ads.mojom.h"
 #include "brave/components/brave_rewards/browser/rewards_notification_service_observer.h"
+#include "build/build_config.h"
 #include "chrome/browser/notifications/notification_handler.h"
 #include "components/history/core/browser/history_service_observer.h"
 #include "components/prefs/pref_change_registrar.h"
@@ -38,6 +39,10 @@
 #include "services/network/public/mojom/url_response_head.mojom.h"
 #include "ui/base/idle/idle.h"
 
+#if !defined(OS_ANDROID)
+#include "chrome/browser/ui/browser_list_observer.h"
+#endif
+
 using brave_rewards::RewardsNotificationService;
 using brave_user_model::UserModelFileService;
 
@@ -65,6 +70,9 @@ class AdsServiceImpl : public AdsService,
                        public history::HistoryServiceObserver,
                        BackgroundHelper::Observer,
                        public brave_user_model::Observer,
+#if !defined(OS_ANDROID)
+                       public BrowserListObserver,
+#endif
                        public base::SupportsWeakPtr<AdsServiceImpl> {
  public:
   // AdsService implementation
@@ -471,6 +479,12 @@ class AdsServiceImpl : public AdsService,
   void OnBackground() override;
   void OnForeground() override;
 
+#if !defined(OS_ANDROID)
+  // BrowserListObserver implementation
+  void OnBrowserRemoved(
+      Browser* browser) override;
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
   Profile* profile_;  // NOT OWNED
@@ -45,6 +45,9 @@ void BraveComponent::Register(const std::string& component_name,
 
 bool BraveComponent::Unregister() {
   VLOG(2) << "unregister component: " << component_id_;
+  // A ready callback may already be queued; an unregistered component
+  // doesn't get it.
+  weak_factory_.InvalidateWeakPtrs();
   return delegate_->Unregister(component_id_);
 }
 
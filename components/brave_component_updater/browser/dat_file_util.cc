@@ -10,6 +10,7 @@
 #include "base/logging.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/memory/ptr_util.h"
 
 namespace brave_component_updater {
 
@@ -44,4 +45,21 @@ std::string GetDATFileAsString(const base::FilePath& file_path) {
   return contents;
 }
 
+MappedDATFile::MappedDATFile() = default;
+
+MappedDATFile::~MappedDATFile() = default;
+
+// static
+std::unique_ptr<MappedDATFile> MappedDATFile::Open(
+    const base::FilePath& file_path) {
+  auto mapped_file = base::WrapUnique(new MappedDATFile());
+  if (!mapped_file->file_.Initialize(file_path) ||
+      mapped_file->file_.length() == 0) {
+    LOG(ERROR) << "MappedDATFile: cannot "
+               << "map dat file " << file_path;
+    return nullptr;
+  }
+  return mapped_file;
+}
+
 }  // namespace brave_component_updater
@@ -6,12 +6,19 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_COMPONENT_UPDATER_BROWSER_DAT_FILE_UTIL_H_
 #define BRAVE_COMPONENTS_BRAVE_COMPONENT_UPDATER_BROWSER_DAT_FILE_UTIL_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
 
 namespace brave_component_updater {
 
@@ -21,10 +28,38 @@ void GetDATFileData(const base::FilePath& file_path,
                     DATFileDataBuffer* buffer);
 std::string GetDATFileAsString(const base::FilePath& file_path);
 
+// A component file mapped read-only into memory, so that consumers can parse
+// it in place instead of reading it into a buffer first. The data stays valid
+// for as long as the handle lives. Unmapping blocks, so owners on sequences
+// that disallow blocking should release it on a MayBlock() task runner.
+class MappedDATFile {
+ public:
+  ~MappedDATFile();
+
+  // Returns null if |file_path| is missing, empty or can't be mapped.
+  static std::unique_ptr<MappedDATFile> Open(const base::FilePath& file_path);
+
+  const uint8_t* data() const { return file_.data(); }
+  size_t length() const { return file_.length(); }
+  base::StringPiece AsStringPiece() const {
+    return base::StringPiece(reinterpret_cast<const char*>(data()), length());
+  }
+
+ private:
+  MappedDATFile();
+
+  base::MemoryMappedFile file_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedDATFile);
+};
+
 template<typename T>
 using LoadDATFileDataResult =
     std::pair<std::unique_ptr<T>, brave_component_updater::DATFileDataBuffer>;
 
+// Reads |dat_file_path| into a heap buffer for deserializers that take a
+// mutable buffer or keep pointers into it, which callers keep alive with the
+// client. Read-only deserializers should use LoadMappedDATFileData().
 template<typename T>
 LoadDATFileDataResult<T> LoadDATFileData(
     const base::FilePath& dat_file_path) {
@@ -41,6 +76,25 @@ LoadDATFileDataResult<T> LoadDATFileData(
       std::move(client), std::move(buffer));
 }
 
+// Maps |dat_file_path| read-only and deserializes |T| directly from the
+// mapped pages, so the file contents are never copied into a heap buffer.
+// The mapping is released as soon as deserialization completes.
+template<typename T>
+std::unique_ptr<T> LoadMappedDATFileData(
+    const base::FilePath& dat_file_path) {
+  std::unique_ptr<MappedDATFile> mapped_file =
+      MappedDATFile::Open(dat_file_path);
+  if (!mapped_file)
+    return nullptr;
+
+  auto client = std::make_unique<T>();
+  if (!client->deserialize(
+          reinterpret_cast<const char*>(mapped_file->data()),
+          mapped_file->length()))
+    return nullptr;
+
+  return client;
+}
 
 }  // namespace brave_component_updater
 
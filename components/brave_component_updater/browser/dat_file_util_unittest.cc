@@ -0,0 +1,74 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_component_updater/browser/dat_file_util.h"
+
+#include <memory>
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_component_updater {
+
+namespace {
+
+// Keeps a copy of what it was given, rejecting anything starting with "x".
+class TestClient {
+ public:
+  bool deserialize(const char* data, size_t data_size) {
+    data_.assign(data, data_size);
+    return data_[0] != 'x';
+  }
+
+  const std::string& data() const { return data_; }
+
+ private:
+  std::string data_;
+};
+
+class DATFileUtilTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  base::FilePath WriteDATFile(const std::string& name,
+                              const std::string& contents) {
+    const base::FilePath path = temp_dir_.GetPath().AppendASCII(name);
+    EXPECT_TRUE(base::WriteFile(path, contents));
+    return path;
+  }
+
+  base::ScopedTempDir temp_dir_;
+};
+
+}  // namespace
+
+TEST_F(DATFileUtilTest, MappedDATFile) {
+  const std::string contents = "brave.com,example.com";
+  auto mapped_file = MappedDATFile::Open(WriteDATFile("list.dat", contents));
+  ASSERT_TRUE(mapped_file);
+  EXPECT_EQ(contents.size(), mapped_file->length());
+  EXPECT_EQ(contents, mapped_file->AsStringPiece());
+
+  EXPECT_FALSE(MappedDATFile::Open(WriteDATFile("empty.dat", "")));
+  EXPECT_FALSE(
+      MappedDATFile::Open(temp_dir_.GetPath().AppendASCII("missing.dat")));
+}
+
+TEST_F(DATFileUtilTest, LoadMappedDATFileData) {
+  auto client =
+      LoadMappedDATFileData<TestClient>(WriteDATFile("good.dat", "data"));
+  ASSERT_TRUE(client);
+  EXPECT_EQ("data", client->data());
+
+  EXPECT_FALSE(
+      LoadMappedDATFileData<TestClient>(WriteDATFile("bad.dat", "xdata")));
+  EXPECT_FALSE(LoadMappedDATFileData<TestClient>(
+      temp_dir_.GetPath().AppendASCII("missing.dat")));
+}
+
+}  // namespace brave_component_updater
@@ -0,0 +1,86 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_referrals/browser/referral_header_index.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/strings/string_piece.h"
+#include "url/gurl.h"
+
+namespace brave {
+
+namespace {
+
+// Hosts are compared without a trailing dot, as URLPattern does.
+base::StringPiece TrimTrailingDot(base::StringPiece host) {
+  if (!host.empty() && host.back() == '.')
+    host.remove_suffix(1);
+  return host;
+}
+
+}  // namespace
+
+ReferralHeaderIndex::ReferralHeaderIndex(
+    const base::ListValue& referral_headers_list) {
+  std::vector<std::pair<std::string, size_t>> domains;
+  for (const auto& headers_value : referral_headers_list) {
+    const base::Value* domains_list =
+        headers_value.FindKeyOfType("domains", base::Value::Type::LIST);
+    if (!domains_list) {
+      LOG(WARNING) << "Failed to retrieve 'domains' key from referral headers";
+      continue;
+    }
+    const base::Value* headers_dict =
+        headers_value.FindKeyOfType("headers", base::Value::Type::DICTIONARY);
+    if (!headers_dict) {
+      LOG(WARNING) << "Failed to retrieve 'headers' key from referral headers";
+      continue;
+    }
+    const size_t entry = headers_.size();
+    headers_.push_back(headers_dict->Clone());
+    for (const auto& domain_value : domains_list->GetList()) {
+      if (!domain_value.is_string())
+        continue;
+      const base::StringPiece domain =
+          TrimTrailingDot(domain_value.GetString());
+      if (domain.empty()) {
+        any_domain_entry_ = std::min(any_domain_entry_, entry);
+        continue;
+      }
+      domains.emplace_back(domain.as_string(), entry);
+    }
+  }
+  // flat_map keeps the first of equal keys, i.e. the earliest entry.
+  domains_ = base::flat_map<std::string, size_t, std::less<>>(
+      std::move(domains), base::KEEP_FIRST_OF_DUPES);
+}
+
+ReferralHeaderIndex::~ReferralHeaderIndex() = default;
+
+const base::Value* ReferralHeaderIndex::FindHeaders(const GURL& url) const {
+  if (headers_.empty() || !url.SchemeIsHTTPOrHTTPS())
+    return nullptr;
+
+  // Entries are tried in list order, so the earliest matching entry wins.
+  size_t entry = any_domain_entry_;
+  const base::StringPiece host = TrimTrailingDot(url.host_piece());
+  // Subdomains of a partner domain match too, except for IP addresses.
+  const bool match_parents = !url.HostIsIPAddress();
+  for (base::StringPiece domain = host; !domain.empty();) {
+    auto it = domains_.find(domain);
+    if (it != domains_.end())
+      entry = std::min(entry, it->second);
+    const size_t dot = domain.find('.');
+    if (!match_parents || dot == base::StringPiece::npos)
+      break;
+    domain.remove_prefix(dot + 1);
+  }
+  return entry == kNoEntry ? nullptr : &headers_[entry];
+}
+
+}  // namespace brave
@@ -0,0 +1,57 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_REFERRALS_BROWSER_REFERRAL_HEADER_INDEX_H_
+#define BRAVE_COMPONENTS_BRAVE_REFERRALS_BROWSER_REFERRAL_HEADER_INDEX_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/values.h"
+
+class GURL;
+
+namespace brave {
+
+// The referral headers list compiled for lookups by request URL. Each entry
+// of the list names partner domains and the headers to send to them; the
+// index maps every domain to the first entry naming it, so a lookup probes
+// the request host and its parent domains instead of matching every domain
+// of every entry. Gives the same answer as
+// BraveReferralsService::GetMatchingReferralHeaders on the source list.
+// Immutable once built, so it can be shared with other sequences.
+class ReferralHeaderIndex
+    : public base::RefCountedThreadSafe<ReferralHeaderIndex> {
+ public:
+  explicit ReferralHeaderIndex(const base::ListValue& referral_headers_list);
+
+  // Returns the headers dictionary for |url|, or null if no partner domain
+  // matches. Doesn't allocate.
+  const base::Value* FindHeaders(const GURL& url) const;
+
+  bool empty() const { return headers_.empty(); }
+
+ private:
+  friend class base::RefCountedThreadSafe<ReferralHeaderIndex>;
+  ~ReferralHeaderIndex();
+
+  static constexpr size_t kNoEntry = static_cast<size_t>(-1);
+
+  std::vector<base::Value> headers_;
+  // Domain to the index in |headers_| of the first entry listing it.
+  base::flat_map<std::string, size_t, std::less<>> domains_;
+  // The first entry with an empty domain, which matches every host.
+  size_t any_domain_entry_ = kNoEntry;
+
+  DISALLOW_COPY_AND_ASSIGN(ReferralHeaderIndex);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_COMPONENTS_BRAVE_REFERRALS_BROWSER_REFERRAL_HEADER_INDEX_H_
@@ -7,7 +7,9 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
+#include "base/bind.h"
 #include "base/task/post_task.h"
 #include "brave/components/brave_rewards/browser/rewards_service.h"
 #include "brave/browser/brave_rewards/rewards_service_factory.h"
@@ -74,17 +76,19 @@ void DispatchOnUI(
 int OnBeforeURLRequest(
   const brave::ResponseCallback& next_callback,
   std::shared_ptr<brave::BraveRequestInfo> ctx) {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-
-  if (IsMediaLink(ctx->request_url, ctx->tab_origin, ctx->referrer)) {
-    if (!ctx->upload_data.empty()) {
-      DispatchOnUI(ctx->upload_data,
-                   ctx->request_url,
-                   ctx->tab_url,
-                   ctx->referrer.spec(),
-                   ctx->render_process_id,
-                   ctx->render_frame_id,
-                   ctx->frame_tree_node_id);
+  if (IsMediaLink(ctx->request_url, ctx->tab_origin(), ctx->referrer)) {
+    if (!ctx->upload_data().empty()) {
+      base::OnceClosure dispatch = base::BindOnce(
+          &DispatchOnUI, ctx->upload_data(), ctx->request_url, ctx->tab_url,
+          ctx->referrer.spec(), ctx->render_process_id, ctx->render_frame_id,
+          ctx->frame_tree_node_id);
+      // Requests may be handled off the UI thread.
+      if (content::BrowserThread::CurrentlyOn(content::BrowserThread::UI)) {
+        std::move(dispatch).Run();
+      } else {
+        base::PostTask(FROM_HERE, {content::BrowserThread::UI},
+                       std::move(dispatch));
+      }
     }
   }
 
@@ -6,13 +6,13 @@
 #include "brave/components/brave_shields/browser/ad_block_base_service.h"
 
 #include <algorithm>
+#include <atomic>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/bind.h"
 #include "base/files/file_path.h"
-#include "base/json/json_reader.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
 #include "base/strings/utf_string_conversions.h"
@@ -20,6 +20,7 @@
 #include "brave/browser/net/url_context.h"
 #include "brave/common/pref_names.h"
 #include "brave/components/brave_component_updater/browser/dat_file_util.h"
+#include "brave/components/brave_shields/browser/ad_block_overlay_rules.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
 #include "components/prefs/pref_service.h"
@@ -34,7 +35,47 @@ using namespace net::registry_controlled_domains;  // NOLINT
 
 namespace {
 
-std::string ResourceTypeToString(blink::mojom::ResourceType resource_type) {
+std::atomic<uint64_t> g_engine_generation{0};
+
+}  // namespace
+
+namespace brave_shields {
+
+AdBlockBaseService::AdBlockBaseService(BraveComponent::Delegate* delegate)
+    : BaseBraveShieldsService(delegate),
+      ad_block_client_(new adblock::Engine()),
+      weak_factory_(this) {}
+
+AdBlockBaseService::~AdBlockBaseService() {
+  GetTaskRunner()->DeleteSoon(FROM_HERE, ad_block_client_.release());
+  if (overlay_client_)
+    GetTaskRunner()->DeleteSoon(FROM_HERE, overlay_client_.release());
+}
+
+// static
+uint64_t AdBlockBaseService::GetEngineGeneration() {
+  return g_engine_generation.load();
+}
+
+// static
+void AdBlockBaseService::IncrementEngineGeneration() {
+  g_engine_generation++;
+}
+
+// static
+bool AdBlockBaseService::IsThirdPartyRequest(const GURL& url,
+                                             const std::string& tab_host) {
+  // CreateFromNormalizedTuple is needed because SameDomainOrHost needs
+  // a URL or origin and not a string to a host name.
+  return !SameDomainOrHost(
+      url,
+      url::Origin::CreateFromNormalizedTuple("https", tab_host.c_str(), 80),
+      INCLUDE_PRIVATE_REGISTRIES);
+}
+
+// static
+std::string AdBlockBaseService::ResourceTypeToString(
+    blink::mojom::ResourceType resource_type) {
   std::string filter_option = "";
   switch (resource_type) {
     // top level page
@@ -100,19 +141,6 @@ std::string ResourceTypeToString(blink::mojom::ResourceType resource_type) {
   return filter_option;
 }
 
-}  // namespace
-
-namespace brave_shields {
-
-AdBlockBaseService::AdBlockBaseService(BraveComponent::Delegate* delegate)
-    : BaseBraveShieldsService(delegate),
-      ad_block_client_(new adblock::Engine()),
-      weak_factory_(this) {}
-
-AdBlockBaseService::~AdBlockBaseService() {
-  GetTaskRunner()->DeleteSoon(FROM_HERE, ad_block_client_.release());
-}
-
 bool AdBlockBaseService::ShouldStartRequest(
     const GURL& url,
     blink::mojom::ResourceType resource_type,
@@ -120,21 +148,29 @@ bool AdBlockBaseService::ShouldStartRequest(
     bool* did_match_exception,
     bool* cancel_request_explicitly,
     std::string* mock_data_url) {
+  // Determine third-party here so the library doesn't need to figure it out.
+  return ShouldStartRequestForList(
+      url, ResourceTypeToString(resource_type), tab_host,
+      IsThirdPartyRequest(url, tab_host), did_match_exception,
+      cancel_request_explicitly, mock_data_url);
+}
+
+bool AdBlockBaseService::ShouldStartRequestForList(
+    const GURL& url,
+    const std::string& resource_type,
+    const std::string& tab_host,
+    bool is_third_party,
+    bool* did_match_exception,
+    bool* cancel_request_explicitly,
+    std::string* mock_data_url) {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
 
-  // Determine third-party here so the library doesn't need to figure it out.
-  // CreateFromNormalizedTuple is needed because SameDomainOrHost needs
-  // a URL or origin and not a string to a host name.
-  bool is_third_party = !SameDomainOrHost(
-      url,
-      url::Origin::CreateFromNormalizedTuple("https", tab_host.c_str(), 80),
-      INCLUDE_PRIVATE_REGISTRIES);
   bool explicit_cancel;
   bool saved_from_exception;
-  if (ad_block_client_->matches(
-          url.spec(), url.host(), tab_host, is_third_party,
-          ResourceTypeToString(resource_type), &explicit_cancel,
-          &saved_from_exception, mock_data_url)) {
+  if (MatchesWithOverlay(ad_block_client_.get(), overlay_client_.get(),
+                         url.spec(), url.host(), tab_host, is_third_party,
+                         resource_type, &explicit_cancel,
+                         &saved_from_exception, mock_data_url)) {
     if (cancel_request_explicitly) {
       *cancel_request_explicitly = explicit_cancel;
     }
@@ -166,15 +202,20 @@ void AdBlockBaseService::EnableTag(const std::string& tag, bool enabled) {
 
   if (enabled) {
     ad_block_client_->addTag(tag);
+    if (overlay_client_)
+      overlay_client_->addTag(tag);
     tags_.push_back(tag);
   } else {
     ad_block_client_->removeTag(tag);
+    if (overlay_client_)
+      overlay_client_->removeTag(tag);
     std::vector<std::string>::iterator it =
         std::find(tags_.begin(), tags_.end(), tag);
     if (it != tags_.end()) {
       tags_.erase(it);
     }
   }
+  IncrementEngineGeneration();
 }
 
 void AdBlockBaseService::AddResources(const std::string& resources) {
@@ -186,50 +227,73 @@ void AdBlockBaseService::AddResources(const std::string& resources) {
   }
 
   ad_block_client_->addResources(resources);
+  if (overlay_client_)
+    overlay_client_->addResources(resources);
   resources_ = resources;
+  IncrementEngineGeneration();
 }
 
 bool AdBlockBaseService::TagExists(const std::string& tag) {
   return std::find(tags_.begin(), tags_.end(), tag) != tags_.end();
 }
 
-base::Optional<base::Value> AdBlockBaseService::UrlCosmeticResources(
+base::Optional<CosmeticResources> AdBlockBaseService::UrlCosmeticResources(
         const std::string& url) {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
-  return base::JSONReader::Read(ad_block_client_->urlCosmeticResources(url));
+  base::Optional<CosmeticResources> resources = CosmeticResources::FromJSON(
+      ad_block_client_->urlCosmeticResources(url));
+  if (!overlay_client_ || !resources)
+    return resources;
+  base::Optional<CosmeticResources> overlay_resources =
+      CosmeticResources::FromJSON(overlay_client_->urlCosmeticResources(url));
+  if (overlay_resources)
+    resources->MergeFrom(std::move(*overlay_resources), false);
+  return resources;
 }
 
-base::Optional<base::Value> AdBlockBaseService::HiddenClassIdSelectors(
+std::vector<std::string> AdBlockBaseService::HiddenClassIdSelectors(
         const std::vector<std::string>& classes,
         const std::vector<std::string>& ids,
         const std::vector<std::string>& exceptions) {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
-  return base::JSONReader::Read(
+  std::vector<std::string> selectors = HiddenClassIdSelectorsFromJSON(
       ad_block_client_->hiddenClassIdSelectors(classes, ids, exceptions));
+  if (overlay_client_) {
+    std::vector<std::string> overlay_selectors =
+        HiddenClassIdSelectorsFromJSON(
+            overlay_client_->hiddenClassIdSelectors(classes, ids, exceptions));
+    selectors.insert(selectors.end(), overlay_selectors.begin(),
+                     overlay_selectors.end());
+  }
+  return selectors;
 }
 
 void AdBlockBaseService::GetDATFileData(const base::FilePath& dat_file_path) {
+  // The list is deserialized straight out of a read-only mapping of the DAT
+  // file rather than from a heap copy of it.
   base::PostTaskAndReplyWithResult(
       FROM_HERE, {base::ThreadPool(), base::MayBlock()},
-      base::BindOnce(&brave_component_updater::LoadDATFileData<adblock::Engine>,
-                     dat_file_path),
+      base::BindOnce(
+          &brave_component_updater::LoadMappedDATFileData<adblock::Engine>,
+          dat_file_path),
       base::BindOnce(&AdBlockBaseService::OnGetDATFileData,
                      weak_factory_.GetWeakPtr()));
 }
 
-void AdBlockBaseService::OnGetDATFileData(GetDATFileDataResult result) {
-  if (result.second.empty()) {
-    LOG(ERROR) << "Could not obtain ad block data";
-    return;
-  }
-  if (!result.first.get()) {
-    LOG(ERROR) << "Failed to deserialize ad block data";
+void AdBlockBaseService::CancelGetDATFileData() {
+  weak_factory_.InvalidateWeakPtrs();
+}
+
+void AdBlockBaseService::OnGetDATFileData(
+    std::unique_ptr<adblock::Engine> ad_block_client) {
+  if (!ad_block_client) {
+    LOG(ERROR) << "Failed to load ad block data";
     return;
   }
   GetTaskRunner()->PostTask(
       FROM_HERE, base::BindOnce(&AdBlockBaseService::UpdateAdBlockClient,
                                 base::Unretained(this),
-                                std::move(result.first)));
+                                std::move(ad_block_client)));
 }
 
 void AdBlockBaseService::UpdateAdBlockClient(
@@ -238,6 +302,19 @@ void AdBlockBaseService::UpdateAdBlockClient(
   ad_block_client_ = std::move(ad_block_client);
   AddKnownTagsToAdBlockInstance();
   AddKnownResourcesToAdBlockInstance();
+  IncrementEngineGeneration();
+}
+
+void AdBlockBaseService::UpdateOverlayClient(
+    std::unique_ptr<adblock::Engine> overlay_client) {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  overlay_client_ = std::move(overlay_client);
+  if (overlay_client_) {
+    for (const auto& tag : tags_)
+      overlay_client_->addTag(tag);
+    overlay_client_->addResources(resources_);
+  }
+  IncrementEngineGeneration();
 }
 
 void AdBlockBaseService::AddKnownTagsToAdBlockInstance() {
@@ -259,11 +336,13 @@ void AdBlockBaseService::ResetForTest(const std::string& rules,
   // filter rules to an existing instance. At which point the hack below
   // will dissapear.
   ad_block_client_.reset(new adblock::Engine(rules));
+  overlay_client_.reset();
   AddKnownTagsToAdBlockInstance();
   if (!resources.empty()) {
     resources_ = resources;
   }
   AddKnownResourcesToAdBlockInstance();
+  IncrementEngineGeneration();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -16,7 +16,7 @@
 #include "base/files/file_path.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
-#include "base/values.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
 #include "brave/components/brave_component_updater/browser/dat_file_util.h"
 #include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
@@ -34,8 +34,15 @@ namespace brave_shields {
 // checking and init.
 class AdBlockBaseService : public BaseBraveShieldsService {
  public:
-  using GetDATFileDataResult =
-      brave_component_updater::LoadDATFileDataResult<adblock::Engine>;
+  // Returns whether |url| is third-party relative to |tab_host|.
+  static bool IsThirdPartyRequest(const GURL& url, const std::string& tab_host);
+  // Returns the adblock-rust request type for |resource_type|.
+  static std::string ResourceTypeToString(
+      blink::mojom::ResourceType resource_type);
+  // Changes whenever any adblock list, tag or resource set changes, so that
+  // callers caching match results know to discard them.
+  static uint64_t GetEngineGeneration();
+  static void IncrementEngineGeneration();
 
   explicit AdBlockBaseService(BraveComponent::Delegate* delegate);
   ~AdBlockBaseService() override;
@@ -46,13 +53,23 @@ class AdBlockBaseService : public BaseBraveShieldsService {
                           bool* did_match_exception,
                           bool* cancel_request_explicitly,
                           std::string* mock_data_url) override;
+  // Matches a request against this list only. |is_third_party| and
+  // |resource_type| are derived once by the caller so that a request checked
+  // against several lists does not recompute them for each one.
+  bool ShouldStartRequestForList(const GURL& url,
+                                 const std::string& resource_type,
+                                 const std::string& tab_host,
+                                 bool is_third_party,
+                                 bool* did_match_exception,
+                                 bool* cancel_request_explicitly,
+                                 std::string* mock_data_url);
   void AddResources(const std::string& resources);
   void EnableTag(const std::string& tag, bool enabled);
   bool TagExists(const std::string& tag);
 
-  base::Optional<base::Value> UrlCosmeticResources(
+  base::Optional<CosmeticResources> UrlCosmeticResources(
           const std::string& url);
-  base::Optional<base::Value> HiddenClassIdSelectors(
+  std::vector<std::string> HiddenClassIdSelectors(
           const std::vector<std::string>& classes,
           const std::vector<std::string>& ids,
           const std::vector<std::string>& exceptions);
@@ -62,16 +79,23 @@ class AdBlockBaseService : public BaseBraveShieldsService {
   bool Init() override;
 
   void GetDATFileData(const base::FilePath& dat_file_path);
+  // Drops the result of a GetDATFileData() call still in flight.
+  void CancelGetDATFileData();
   void AddKnownTagsToAdBlockInstance();
   void AddKnownResourcesToAdBlockInstance();
   void ResetForTest(const std::string& rules, const std::string& resources);
+  void UpdateAdBlockClient(
+      std::unique_ptr<adblock::Engine> ad_block_client);
+  // Installs, or with null removes, an engine consulted alongside
+  // |ad_block_client_| for rules added since it was compiled. See
+  // AdBlockOverlayRules.
+  void UpdateOverlayClient(std::unique_ptr<adblock::Engine> overlay_client);
 
   std::unique_ptr<adblock::Engine> ad_block_client_;
+  std::unique_ptr<adblock::Engine> overlay_client_;
 
  private:
-  void UpdateAdBlockClient(
-      std::unique_ptr<adblock::Engine> ad_block_client);
-  void OnGetDATFileData(GetDATFileDataResult result);
+  void OnGetDATFileData(std::unique_ptr<adblock::Engine> ad_block_client);
   void OnPreferenceChanges(const std::string& pref_name);
 
   std::vector<std::string> tags_;
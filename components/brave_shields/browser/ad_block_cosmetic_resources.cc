@@ -0,0 +1,135 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
+
+#include <utility>
+
+#include "base/json/json_reader.h"
+
+namespace brave_shields {
+
+namespace {
+
+void TakeStrings(base::Value* list, std::vector<std::string>* out) {
+  if (!list || !list->is_list())
+    return;
+  for (auto& item : list->GetList()) {
+    if (item.is_string())
+      out->push_back(std::move(item.GetString()));
+  }
+}
+
+base::Value ToListValue(std::vector<std::string> strings) {
+  base::Value list(base::Value::Type::LIST);
+  for (auto& item : strings)
+    list.Append(std::move(item));
+  return list;
+}
+
+void AppendAll(std::vector<std::string> from, std::vector<std::string>* into) {
+  if (into->empty()) {
+    *into = std::move(from);
+    return;
+  }
+  into->insert(into->end(), std::make_move_iterator(from.begin()),
+               std::make_move_iterator(from.end()));
+}
+
+}  // namespace
+
+CosmeticResources::CosmeticResources() = default;
+CosmeticResources::CosmeticResources(CosmeticResources&& other) = default;
+CosmeticResources& CosmeticResources::operator=(CosmeticResources&& other) =
+    default;
+CosmeticResources::~CosmeticResources() = default;
+
+// static
+base::Optional<CosmeticResources> CosmeticResources::FromJSON(
+    const std::string& json) {
+  base::Optional<base::Value> value = base::JSONReader::Read(json);
+  if (!value)
+    return base::nullopt;
+  return FromValue(std::move(*value));
+}
+
+// static
+base::Optional<CosmeticResources> CosmeticResources::FromValue(
+    base::Value value) {
+  if (!value.is_dict())
+    return base::nullopt;
+
+  CosmeticResources resources;
+  TakeStrings(value.FindKey("hide_selectors"), &resources.hide_selectors);
+  base::Value* style_selectors = value.FindKey("style_selectors");
+  if (style_selectors && style_selectors->is_dict()) {
+    for (auto item : style_selectors->DictItems()) {
+      TakeStrings(&item.second, &resources.style_selectors[item.first]);
+    }
+  }
+  TakeStrings(value.FindKey("exceptions"), &resources.exceptions);
+  std::string* injected_script = value.FindStringKey("injected_script");
+  if (injected_script)
+    resources.injected_script = std::move(*injected_script);
+  resources.generichide = value.FindBoolKey("generichide").value_or(false);
+  base::Value* force_hide_selectors = value.FindKey("force_hide_selectors");
+  if (force_hide_selectors && force_hide_selectors->is_list()) {
+    resources.force_hide_selectors.emplace();
+    TakeStrings(force_hide_selectors, &*resources.force_hide_selectors);
+  }
+  return resources;
+}
+
+void CosmeticResources::MergeFrom(CosmeticResources from, bool force_hide) {
+  if (force_hide) {
+    if (!force_hide_selectors)
+      force_hide_selectors.emplace();
+    AppendAll(std::move(from.hide_selectors), &*force_hide_selectors);
+  } else {
+    AppendAll(std::move(from.hide_selectors), &hide_selectors);
+  }
+
+  for (auto& item : from.style_selectors) {
+    AppendAll(std::move(item.second), &style_selectors[item.first]);
+  }
+
+  AppendAll(std::move(from.exceptions), &exceptions);
+
+  injected_script.push_back('\n');
+  injected_script.append(from.injected_script);
+
+  if (from.generichide)
+    generichide = true;
+}
+
+base::Value CosmeticResources::ToValue() && {
+  base::Value value(base::Value::Type::DICTIONARY);
+  value.SetKey("hide_selectors", ToListValue(std::move(hide_selectors)));
+  base::Value style_selectors_value(base::Value::Type::DICTIONARY);
+  for (auto& item : style_selectors) {
+    style_selectors_value.SetKey(item.first,
+                                 ToListValue(std::move(item.second)));
+  }
+  value.SetKey("style_selectors", std::move(style_selectors_value));
+  value.SetKey("exceptions", ToListValue(std::move(exceptions)));
+  value.SetStringKey("injected_script", std::move(injected_script));
+  value.SetBoolKey("generichide", generichide);
+  if (force_hide_selectors) {
+    value.SetKey("force_hide_selectors",
+                 ToListValue(std::move(*force_hide_selectors)));
+  }
+  return value;
+}
+
+std::vector<std::string> HiddenClassIdSelectorsFromJSON(
+    const std::string& json) {
+  std::vector<std::string> selectors;
+  base::Optional<base::Value> value = base::JSONReader::Read(json);
+  if (value)
+    TakeStrings(&*value, &selectors);
+  return selectors;
+}
+
+}  // namespace brave_shields
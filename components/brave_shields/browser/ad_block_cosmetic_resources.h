@@ -0,0 +1,55 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/optional.h"
+#include "base/values.h"
+
+namespace brave_shields {
+
+// Typed form of the cosmetic resources adblock-rust returns for a URL. Each
+// engine's result is parsed into this once, the default, regional and custom
+// results are merged in this form, and it is converted to a base::Value only
+// when handed to the extension or renderer.
+struct CosmeticResources {
+  CosmeticResources();
+  CosmeticResources(CosmeticResources&& other);
+  CosmeticResources& operator=(CosmeticResources&& other);
+  ~CosmeticResources();
+
+  // Parses a result of adblock::Engine::urlCosmeticResources. Returns
+  // base::nullopt if |json| is not a dictionary.
+  static base::Optional<CosmeticResources> FromJSON(const std::string& json);
+  // Consumes a dictionary in the format produced by ToValue.
+  static base::Optional<CosmeticResources> FromValue(base::Value value);
+
+  // Appends the contents of |from|. If |force_hide| is true, |from|'s
+  // hide selectors go into |force_hide_selectors| instead.
+  void MergeFrom(CosmeticResources from, bool force_hide);
+
+  base::Value ToValue() &&;
+
+  std::vector<std::string> hide_selectors;
+  std::map<std::string, std::vector<std::string>> style_selectors;
+  std::vector<std::string> exceptions;
+  std::string injected_script;
+  bool generichide = false;
+  // Only present once resources from the custom filter list are merged in.
+  base::Optional<std::vector<std::string>> force_hide_selectors;
+};
+
+// Parses a result of adblock::Engine::hiddenClassIdSelectors.
+std::vector<std::string> HiddenClassIdSelectorsFromJSON(
+    const std::string& json);
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_H_
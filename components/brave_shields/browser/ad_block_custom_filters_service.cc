@@ -5,6 +5,8 @@
 
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
 
+#include <memory>
+
 #include "base/logging.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/common/pref_names.h"
@@ -56,7 +58,21 @@ bool AdBlockCustomFiltersService::UpdateCustomFilters(
 void AdBlockCustomFiltersService::UpdateCustomFiltersOnFileTaskRunner(
     const std::string& custom_filters) {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
-  ad_block_client_.reset(new adblock::Engine(custom_filters.c_str()));
+  // Typical edits add a rule or two, e.g. from the element picker; those only
+  // recompile the overlay rather than the whole list.
+  switch (rules_.SetRules(custom_filters)) {
+    case AdBlockOverlayRules::UpdateResult::kUnchanged:
+      break;
+    case AdBlockOverlayRules::UpdateResult::kOverlayChanged:
+      UpdateOverlayClient(
+          std::make_unique<adblock::Engine>(rules_.GetOverlayRules()));
+      break;
+    case AdBlockOverlayRules::UpdateResult::kRebuildRequired:
+      UpdateAdBlockClient(
+          std::make_unique<adblock::Engine>(rules_.GetBaseRules()));
+      UpdateOverlayClient(nullptr);
+      break;
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -10,6 +10,7 @@
 #include <string>
 
 #include "brave/components/brave_shields/browser/ad_block_base_service.h"
+#include "brave/components/brave_shields/browser/ad_block_overlay_rules.h"
 
 class AdBlockServiceTest;
 
@@ -34,6 +35,9 @@ class AdBlockCustomFiltersService : public AdBlockBaseService {
   friend class ::AdBlockServiceTest;
   void UpdateCustomFiltersOnFileTaskRunner(const std::string& custom_filters);
 
+  // Only accessed on the adblock task runner.
+  AdBlockOverlayRules rules_;
+
   DISALLOW_COPY_AND_ASSIGN(AdBlockCustomFiltersService);
 };
 
@@ -0,0 +1,84 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/path_service.h"
+#include "brave/common/brave_paths.h"
+#include "brave/components/brave_component_updater/browser/dat_file_util.h"
+#include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+base::FilePath GetDefaultAdBlockDATPath() {
+  base::FilePath test_dir;
+  base::PathService::Get(brave::DIR_TEST_DATA, &test_dir);
+  return test_dir.AppendASCII("adblock-data")
+      .AppendASCII("adblock-default")
+      .AppendASCII("rs-ABPFilterParserData.dat");
+}
+
+bool Matches(adblock::Engine* engine,
+             const std::string& url,
+             const std::string& host,
+             const std::string& tab_host,
+             bool is_third_party,
+             const std::string& resource_type) {
+  bool explicit_cancel;
+  bool saved_from_exception;
+  std::string mock_data_url;
+  return engine->matches(url, host, tab_host, is_third_party, resource_type,
+                         &explicit_cancel, &saved_from_exception,
+                         &mock_data_url);
+}
+
+}  // namespace
+
+TEST(AdBlockDATFileTest, MappedLoadMatchesHeapLoad) {
+  const base::FilePath dat_file_path = GetDefaultAdBlockDATPath();
+
+  auto heap_result =
+      brave_component_updater::LoadDATFileData<adblock::Engine>(dat_file_path);
+  ASSERT_TRUE(heap_result.first);
+  std::unique_ptr<adblock::Engine> mapped_engine =
+      brave_component_updater::LoadMappedDATFileData<adblock::Engine>(
+          dat_file_path);
+  ASSERT_TRUE(mapped_engine);
+
+  struct {
+    const char* url;
+    const char* host;
+    const char* tab_host;
+    bool is_third_party;
+    const char* resource_type;
+  } cases[] = {
+      {"https://a.com/ad_banner.png", "a.com", "a.com", false, "image"},
+      {"https://b.com/ad_banner.png", "b.com", "a.com", true, "image"},
+      {"https://a.com/logo.png", "a.com", "a.com", false, "image"},
+      {"https://b.com/adbanner.js", "b.com", "a.com", true, "xhr"},
+      {"https://b.com/adbanner.js", "b.com", "a.com", true, "script"},
+      {"https://a.com/index.html", "a.com", "a.com", false, "main_frame"},
+  };
+  for (const auto& c : cases) {
+    EXPECT_EQ(Matches(heap_result.first.get(), c.url, c.host, c.tab_host,
+                      c.is_third_party, c.resource_type),
+              Matches(mapped_engine.get(), c.url, c.host, c.tab_host,
+                      c.is_third_party, c.resource_type))
+        << c.url << " " << c.resource_type;
+  }
+  EXPECT_TRUE(Matches(mapped_engine.get(), "https://b.com/ad_banner.png",
+                      "b.com", "a.com", true, "image"));
+}
+
+TEST(AdBlockDATFileTest, MappedLoadOfMissingFileFails) {
+  base::FilePath test_dir;
+  base::PathService::Get(brave::DIR_TEST_DATA, &test_dir);
+  EXPECT_FALSE(
+      brave_component_updater::LoadMappedDATFileData<adblock::Engine>(
+          test_dir.AppendASCII("adblock-data").AppendASCII("missing.dat")));
+}
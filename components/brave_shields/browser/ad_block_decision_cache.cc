@@ -0,0 +1,65 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_decision_cache.h"
+
+#include "base/strings/string_number_conversions.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+namespace {
+
+std::string GetCacheKey(const GURL& url,
+                        blink::mojom::ResourceType resource_type,
+                        const std::string& tab_host) {
+  std::string key = base::NumberToString(static_cast<int>(resource_type));
+  key.reserve(key.size() + tab_host.size() + url.spec().size() + 2);
+  key.push_back(' ');
+  key.append(tab_host);
+  key.push_back(' ');
+  key.append(url.spec());
+  return key;
+}
+
+}  // namespace
+
+AdBlockDecisionCache::AdBlockDecisionCache(size_t size) : data_(size) {}
+
+AdBlockDecisionCache::~AdBlockDecisionCache() = default;
+
+bool AdBlockDecisionCache::Get(const GURL& url,
+                               blink::mojom::ResourceType resource_type,
+                               const std::string& tab_host,
+                               uint64_t engine_generation,
+                               Decision* decision) {
+  MaybeInvalidate(engine_generation);
+  auto it = data_.Get(GetCacheKey(url, resource_type, tab_host));
+  if (it == data_.end()) {
+    miss_count_++;
+    return false;
+  }
+  hit_count_++;
+  *decision = it->second;
+  return true;
+}
+
+void AdBlockDecisionCache::Put(const GURL& url,
+                               blink::mojom::ResourceType resource_type,
+                               const std::string& tab_host,
+                               uint64_t engine_generation,
+                               const Decision& decision) {
+  MaybeInvalidate(engine_generation);
+  data_.Put(GetCacheKey(url, resource_type, tab_host), decision);
+}
+
+void AdBlockDecisionCache::MaybeInvalidate(uint64_t engine_generation) {
+  if (engine_generation == engine_generation_)
+    return;
+  data_.Clear();
+  engine_generation_ = engine_generation;
+}
+
+}  // namespace brave_shields
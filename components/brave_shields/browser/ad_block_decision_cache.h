@@ -0,0 +1,70 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_DECISION_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_DECISION_CACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
+
+class GURL;
+
+namespace brave_shields {
+
+// A bounded cache of recent adblock verdicts, keyed by request URL, first
+// party host and resource type. Pages commonly request the same beacon,
+// pixel or script URL many times; repeats are answered without consulting
+// the engines. Entries recorded under an older engine generation are
+// dropped. Not thread-safe; used only on the adblock task runner.
+class AdBlockDecisionCache {
+ public:
+  static constexpr size_t kDefaultSize = 1000;
+
+  struct Decision {
+    bool should_start = true;
+    bool did_match_exception = false;
+    bool cancel_request_explicitly = false;
+    std::string mock_data_url;
+  };
+
+  explicit AdBlockDecisionCache(size_t size = kDefaultSize);
+  ~AdBlockDecisionCache();
+
+  // Returns true and fills |decision| if a verdict for this request was
+  // recorded under |engine_generation|.
+  bool Get(const GURL& url,
+           blink::mojom::ResourceType resource_type,
+           const std::string& tab_host,
+           uint64_t engine_generation,
+           Decision* decision);
+  void Put(const GURL& url,
+           blink::mojom::ResourceType resource_type,
+           const std::string& tab_host,
+           uint64_t engine_generation,
+           const Decision& decision);
+
+  size_t size() const { return data_.size(); }
+  size_t hit_count() const { return hit_count_; }
+  size_t miss_count() const { return miss_count_; }
+
+ private:
+  void MaybeInvalidate(uint64_t engine_generation);
+
+  base::MRUCache<std::string, Decision> data_;
+  uint64_t engine_generation_ = 0;
+  size_t hit_count_ = 0;
+  size_t miss_count_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockDecisionCache);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_DECISION_CACHE_H_
@@ -0,0 +1,128 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <string>
+
+#include "base/stl_util.h"
+#include "brave/components/brave_shields/browser/ad_block_decision_cache.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+using blink::mojom::ResourceType;
+using brave_shields::AdBlockDecisionCache;
+
+namespace {
+
+struct TraceEntry {
+  const char* url;
+  ResourceType resource_type;
+  const char* tab_host;
+};
+
+// Subresource requests recorded while loading a news article.
+const TraceEntry kNewsPageTrace[] = {
+    {"https://news.example/", ResourceType::kMainFrame, "news.example"},
+    {"https://cdn.news.example/site.css", ResourceType::kStylesheet,
+     "news.example"},
+    {"https://cdn.news.example/app.js", ResourceType::kScript, "news.example"},
+    {"https://ads.tracker.test/pixel.gif", ResourceType::kImage,
+     "news.example"},
+    {"https://cdn.news.example/img/1.jpg", ResourceType::kImage,
+     "news.example"},
+    {"https://ads.tracker.test/pixel.gif", ResourceType::kImage,
+     "news.example"},
+    {"https://analytics.test/collect", ResourceType::kPing, "news.example"},
+    {"https://cdn.news.example/img/2.jpg", ResourceType::kImage,
+     "news.example"},
+    {"https://ads.tracker.test/pixel.gif", ResourceType::kImage,
+     "news.example"},
+    {"https://analytics.test/collect", ResourceType::kPing, "news.example"},
+    {"https://ads.tracker.test/ad.js", ResourceType::kScript, "news.example"},
+    {"https://ads.tracker.test/pixel.gif", ResourceType::kImage,
+     "news.example"},
+    {"https://analytics.test/collect", ResourceType::kPing, "news.example"},
+    {"https://ads.tracker.test/ad.js", ResourceType::kScript, "news.example"},
+    {"https://analytics.test/collect", ResourceType::kXhr, "news.example"},
+    {"https://ads.tracker.test/pixel.gif", ResourceType::kImage,
+     "other.example"},
+};
+
+// Stands in for the adblock engines: blocks anything on ads.tracker.test.
+class FakeEngine {
+ public:
+  AdBlockDecisionCache::Decision Match(const GURL& url) {
+    invocations_++;
+    AdBlockDecisionCache::Decision decision;
+    decision.should_start = url.host() != "ads.tracker.test";
+    return decision;
+  }
+
+  size_t invocations() const { return invocations_; }
+
+ private:
+  size_t invocations_ = 0;
+};
+
+bool Replay(AdBlockDecisionCache* cache,
+            FakeEngine* engine,
+            const TraceEntry& entry,
+            uint64_t generation) {
+  const GURL url(entry.url);
+  AdBlockDecisionCache::Decision decision;
+  if (!cache->Get(url, entry.resource_type, entry.tab_host, generation,
+                  &decision)) {
+    decision = engine->Match(url);
+    cache->Put(url, entry.resource_type, entry.tab_host, generation, decision);
+  }
+  return decision.should_start;
+}
+
+}  // namespace
+
+TEST(AdBlockDecisionCacheTest, ReplayTrace) {
+  AdBlockDecisionCache cache;
+  FakeEngine engine;
+  FakeEngine uncached_engine;
+
+  for (const auto& entry : kNewsPageTrace) {
+    EXPECT_EQ(uncached_engine.Match(GURL(entry.url)).should_start,
+              Replay(&cache, &engine, entry, 1))
+        << entry.url;
+  }
+
+  const size_t trace_size = base::size(kNewsPageTrace);
+  EXPECT_EQ(trace_size, cache.hit_count() + cache.miss_count());
+  EXPECT_EQ(10u, engine.invocations());
+  EXPECT_EQ(6u, cache.hit_count());
+  EXPECT_EQ(trace_size - engine.invocations(), cache.hit_count());
+}
+
+TEST(AdBlockDecisionCacheTest, EngineGenerationInvalidates) {
+  AdBlockDecisionCache cache;
+  FakeEngine engine;
+
+  Replay(&cache, &engine, kNewsPageTrace[3], 1);
+  Replay(&cache, &engine, kNewsPageTrace[3], 1);
+  EXPECT_EQ(1u, engine.invocations());
+
+  // An engine reload or tag change bumps the generation.
+  Replay(&cache, &engine, kNewsPageTrace[3], 2);
+  EXPECT_EQ(2u, engine.invocations());
+  EXPECT_EQ(1u, cache.size());
+}
+
+TEST(AdBlockDecisionCacheTest, Bounded) {
+  AdBlockDecisionCache cache(2);
+  FakeEngine engine;
+
+  Replay(&cache, &engine, kNewsPageTrace[1], 1);
+  Replay(&cache, &engine, kNewsPageTrace[2], 1);
+  Replay(&cache, &engine, kNewsPageTrace[3], 1);
+  EXPECT_EQ(2u, cache.size());
+
+  // The oldest entry was evicted.
+  Replay(&cache, &engine, kNewsPageTrace[1], 1);
+  EXPECT_EQ(4u, engine.invocations());
+}
@@ -0,0 +1,192 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_overlay_rules.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "base/stl_util.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
+
+namespace brave_shields {
+
+namespace {
+
+bool IsCommentRule(const std::string& rule) {
+  return base::StartsWith(rule, "!", base::CompareCase::SENSITIVE) ||
+         base::StartsWith(rule, "[", base::CompareCase::SENSITIVE);
+}
+
+// Rules that can undo another rule's effect. These must live in the same
+// engine as the rules they apply to, so adding one forces a rebuild.
+bool IsExceptionRule(const std::string& rule) {
+  return base::StartsWith(rule, "@@", base::CompareCase::SENSITIVE) ||
+         rule.find("#@") != std::string::npos ||
+         rule.find("badfilter") != std::string::npos;
+}
+
+std::set<std::string> ParseRules(const std::string& rules) {
+  std::set<std::string> result;
+  for (const auto& rule : base::SplitString(rules, "\n",
+                                            base::TRIM_WHITESPACE,
+                                            base::SPLIT_WANT_NONEMPTY)) {
+    if (!IsCommentRule(rule))
+      result.insert(rule);
+  }
+  return result;
+}
+
+std::set<std::string> ToRuleSet(const std::vector<std::string>& rules) {
+  std::set<std::string> result;
+  for (const auto& rule : rules) {
+    std::string trimmed;
+    base::TrimWhitespaceASCII(rule, base::TRIM_ALL, &trimmed);
+    if (!trimmed.empty() && !IsCommentRule(trimmed))
+      result.insert(trimmed);
+  }
+  return result;
+}
+
+std::string JoinRules(const std::set<std::string>& first,
+                      const std::set<std::string>& second) {
+  std::string result;
+  for (const auto* rules : {&first, &second}) {
+    for (const auto& rule : *rules) {
+      result.append(rule);
+      result.push_back('\n');
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+AdBlockOverlayRules::AdBlockOverlayRules(size_t max_overlay_rules)
+    : max_overlay_rules_(max_overlay_rules) {}
+
+AdBlockOverlayRules::~AdBlockOverlayRules() = default;
+
+AdBlockOverlayRules::UpdateResult AdBlockOverlayRules::SetRules(
+    const std::string& rules) {
+  std::set<std::string> added = ParseRules(rules);
+  std::set<std::string> removed;
+  for (const auto* current : {&base_rules_, &overlay_rules_}) {
+    for (const auto& rule : *current) {
+      if (!added.erase(rule))
+        removed.insert(rule);
+    }
+  }
+  return Apply(added, removed);
+}
+
+AdBlockOverlayRules::UpdateResult AdBlockOverlayRules::AddRules(
+    const std::vector<std::string>& rules) {
+  return Apply(ToRuleSet(rules), std::set<std::string>());
+}
+
+AdBlockOverlayRules::UpdateResult AdBlockOverlayRules::RemoveRules(
+    const std::vector<std::string>& rules) {
+  return Apply(std::set<std::string>(), ToRuleSet(rules));
+}
+
+std::string AdBlockOverlayRules::GetBaseRules() const {
+  return JoinRules(base_rules_, std::set<std::string>());
+}
+
+std::string AdBlockOverlayRules::GetOverlayRules() const {
+  return JoinRules(base_exception_rules_, overlay_rules_);
+}
+
+AdBlockOverlayRules::UpdateResult AdBlockOverlayRules::Apply(
+    const std::set<std::string>& added,
+    const std::set<std::string>& removed) {
+  std::vector<std::string> to_add;
+  for (const auto& rule : added) {
+    if (!base::Contains(base_rules_, rule) &&
+        !base::Contains(overlay_rules_, rule))
+      to_add.push_back(rule);
+  }
+  std::vector<std::string> to_remove;
+  bool removes_base_rule = false;
+  for (const auto& rule : removed) {
+    if (base::Contains(base_rules_, rule)) {
+      removes_base_rule = true;
+      to_remove.push_back(rule);
+    } else if (base::Contains(overlay_rules_, rule)) {
+      to_remove.push_back(rule);
+    }
+  }
+  if (to_add.empty() && to_remove.empty())
+    return UpdateResult::kUnchanged;
+
+  for (const auto& rule : to_remove)
+    overlay_rules_.erase(rule);
+
+  bool rebuild = removes_base_rule ||
+                 (base_rules_.empty() && overlay_rules_.empty()) ||
+                 overlay_rules_.size() + to_add.size() > max_overlay_rules_ ||
+                 std::any_of(to_add.begin(), to_add.end(), IsExceptionRule);
+
+  if (!rebuild) {
+    overlay_rules_.insert(to_add.begin(), to_add.end());
+    return UpdateResult::kOverlayChanged;
+  }
+
+  for (const auto& rule : to_remove)
+    base_rules_.erase(rule);
+  base_rules_.insert(overlay_rules_.begin(), overlay_rules_.end());
+  base_rules_.insert(to_add.begin(), to_add.end());
+  overlay_rules_.clear();
+  base_exception_rules_.clear();
+  std::copy_if(
+      base_rules_.begin(), base_rules_.end(),
+      std::inserter(base_exception_rules_, base_exception_rules_.end()),
+      IsExceptionRule);
+  return UpdateResult::kRebuildRequired;
+}
+
+bool MatchesWithOverlay(adblock::Engine* engine,
+                        adblock::Engine* overlay,
+                        const std::string& url,
+                        const std::string& host,
+                        const std::string& tab_host,
+                        bool is_third_party,
+                        const std::string& resource_type,
+                        bool* explicit_cancel,
+                        bool* saved_from_exception,
+                        std::string* mock_data_url) {
+  bool saved_by_base = false;
+  if (engine->matches(url, host, tab_host, is_third_party, resource_type,
+                      explicit_cancel, &saved_by_base, mock_data_url)) {
+    *saved_from_exception = false;
+    // A redirect rule added to the overlay still applies to requests the
+    // base blocks outright.
+    if (overlay && mock_data_url->empty()) {
+      bool overlay_explicit_cancel = false;
+      bool saved_by_overlay = false;
+      overlay->matches(url, host, tab_host, is_third_party, resource_type,
+                       &overlay_explicit_cancel, &saved_by_overlay,
+                       mock_data_url);
+    }
+    return true;
+  }
+  // The overlay never holds exception rules of its own, so it can't unblock
+  // anything the base blocked. It does carry the base's exceptions, which
+  // lets it honour them for its own blocking rules.
+  bool saved_by_overlay = false;
+  if (overlay &&
+      overlay->matches(url, host, tab_host, is_third_party, resource_type,
+                       explicit_cancel, &saved_by_overlay, mock_data_url)) {
+    *saved_from_exception = false;
+    return true;
+  }
+  *saved_from_exception = saved_by_base || saved_by_overlay;
+  return false;
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,90 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_OVERLAY_RULES_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_OVERLAY_RULES_H_
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+
+namespace adblock {
+class Engine;
+}
+
+namespace brave_shields {
+
+// Tracks the rules of a filter list that is compiled as two engines: a base
+// engine holding the rules present at the last full rebuild, and a small
+// overlay engine holding blocking rules added since. adblock-rust can't add
+// or remove rules on an existing engine, so keeping recent additions in the
+// overlay means an edit only recompiles the changed rules. Exception rules,
+// removals of base rules and an overlay grown past |max_overlay_rules| fold
+// everything back into the base. Not thread-safe.
+class AdBlockOverlayRules {
+ public:
+  static constexpr size_t kDefaultMaxOverlayRules = 200;
+
+  enum class UpdateResult {
+    // Nothing changed; both engines are still valid.
+    kUnchanged,
+    // Only the overlay changed; recompile GetOverlayRules().
+    kOverlayChanged,
+    // All rules moved to the base; recompile GetBaseRules() and drop the
+    // overlay engine.
+    kRebuildRequired,
+  };
+
+  explicit AdBlockOverlayRules(
+      size_t max_overlay_rules = kDefaultMaxOverlayRules);
+  ~AdBlockOverlayRules();
+
+  // Replaces the rule set with the newline separated |rules|, applying only
+  // the difference from the current set.
+  UpdateResult SetRules(const std::string& rules);
+  UpdateResult AddRules(const std::vector<std::string>& rules);
+  UpdateResult RemoveRules(const std::vector<std::string>& rules);
+
+  // Rules to compile into the base engine.
+  std::string GetBaseRules() const;
+  // Rules to compile into the overlay engine. Exception rules from the base
+  // are repeated here so that they also apply to overlay rules.
+  std::string GetOverlayRules() const;
+  bool HasOverlay() const { return !overlay_rules_.empty(); }
+  size_t overlay_size() const { return overlay_rules_.size(); }
+
+ private:
+  UpdateResult Apply(const std::set<std::string>& added,
+                     const std::set<std::string>& removed);
+
+  const size_t max_overlay_rules_;
+  std::set<std::string> base_rules_;
+  std::set<std::string> base_exception_rules_;
+  std::set<std::string> overlay_rules_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockOverlayRules);
+};
+
+// Matches a request against |engine| and, if non-null, the |overlay| engine
+// built from AdBlockOverlayRules::GetOverlayRules(). Gives the same verdict
+// as a single engine compiled from both rule sets, including redirects the
+// overlay adds for requests the base blocks. Returns true if the request
+// should be blocked.
+bool MatchesWithOverlay(adblock::Engine* engine,
+                        adblock::Engine* overlay,
+                        const std::string& url,
+                        const std::string& host,
+                        const std::string& tab_host,
+                        bool is_third_party,
+                        const std::string& resource_type,
+                        bool* explicit_cancel,
+                        bool* saved_from_exception,
+                        std::string* mock_data_url);
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_OVERLAY_RULES_H_
@@ -0,0 +1,164 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+#include <string>
+
+#include "brave/components/brave_shields/browser/ad_block_overlay_rules.h"
+#include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using brave_shields::AdBlockOverlayRules;
+using UpdateResult = brave_shields::AdBlockOverlayRules::UpdateResult;
+
+TEST(AdBlockOverlayRulesTest, InitialRulesBuildBase) {
+  AdBlockOverlayRules rules;
+  EXPECT_EQ(UpdateResult::kRebuildRequired,
+            rules.SetRules("! comment\n||a.com^\n\n||b.com^\n"));
+  EXPECT_EQ("||a.com^\n||b.com^\n", rules.GetBaseRules());
+  EXPECT_FALSE(rules.HasOverlay());
+  EXPECT_EQ(UpdateResult::kUnchanged, rules.SetRules("||b.com^\n||a.com^"));
+}
+
+TEST(AdBlockOverlayRulesTest, AddedBlockingRulesGoToOverlay) {
+  AdBlockOverlayRules rules;
+  rules.SetRules("||a.com^");
+  EXPECT_EQ(UpdateResult::kOverlayChanged,
+            rules.SetRules("||a.com^\n||b.com^"));
+  EXPECT_EQ(UpdateResult::kOverlayChanged, rules.AddRules({"c.com##.ad"}));
+  EXPECT_EQ(2u, rules.overlay_size());
+  EXPECT_EQ("||a.com^\n", rules.GetBaseRules());
+  EXPECT_EQ("c.com##.ad\n||b.com^\n", rules.GetOverlayRules());
+
+  // Removing an overlay rule only touches the overlay.
+  EXPECT_EQ(UpdateResult::kOverlayChanged, rules.RemoveRules({"||b.com^"}));
+  EXPECT_EQ("c.com##.ad\n", rules.GetOverlayRules());
+  EXPECT_EQ(UpdateResult::kUnchanged, rules.RemoveRules({"||b.com^"}));
+}
+
+TEST(AdBlockOverlayRulesTest, RemovingBaseRuleRebuilds) {
+  AdBlockOverlayRules rules;
+  rules.SetRules("||a.com^\n||b.com^");
+  rules.AddRules({"||c.com^"});
+  EXPECT_EQ(UpdateResult::kRebuildRequired, rules.RemoveRules({"||a.com^"}));
+  EXPECT_EQ("||b.com^\n||c.com^\n", rules.GetBaseRules());
+  EXPECT_FALSE(rules.HasOverlay());
+}
+
+TEST(AdBlockOverlayRulesTest, ExceptionRulesRebuild) {
+  AdBlockOverlayRules rules;
+  rules.SetRules("||a.com^");
+  EXPECT_EQ(UpdateResult::kRebuildRequired,
+            rules.AddRules({"@@||a.com/ok.js"}));
+  EXPECT_EQ(UpdateResult::kRebuildRequired, rules.AddRules({"a.com#@#.ad"}));
+  EXPECT_EQ(UpdateResult::kRebuildRequired,
+            rules.AddRules({"||a.com^$badfilter"}));
+  EXPECT_FALSE(rules.HasOverlay());
+
+  // Base exceptions are carried into the overlay.
+  EXPECT_EQ(UpdateResult::kOverlayChanged, rules.AddRules({"||b.com^"}));
+  EXPECT_EQ("@@||a.com/ok.js\na.com#@#.ad\n||a.com^$badfilter\n||b.com^\n",
+            rules.GetOverlayRules());
+}
+
+TEST(AdBlockOverlayRulesTest, OverlayCompactsPastThreshold) {
+  AdBlockOverlayRules rules(2);
+  rules.SetRules("||a.com^");
+  EXPECT_EQ(UpdateResult::kOverlayChanged, rules.AddRules({"||b.com^"}));
+  EXPECT_EQ(UpdateResult::kOverlayChanged, rules.AddRules({"||c.com^"}));
+  EXPECT_EQ(UpdateResult::kRebuildRequired, rules.AddRules({"||d.com^"}));
+  EXPECT_EQ("||a.com^\n||b.com^\n||c.com^\n||d.com^\n",
+            rules.GetBaseRules());
+  EXPECT_FALSE(rules.HasOverlay());
+}
+
+TEST(AdBlockOverlayRulesTest, OverlayMatchesRebuiltEngine) {
+  const std::string base_rules =
+      "||a.com/ad_banner.png\n"
+      "@@||b.com/allowed/\n"
+      "||c.com/tracker.js$third-party\n";
+  const std::string added_rules =
+      "||b.com/allowed/ad.js\n"
+      "||b.com/ads/\n"
+      "||d.com^$script\n";
+
+  AdBlockOverlayRules rules;
+  rules.SetRules(base_rules);
+  ASSERT_EQ(UpdateResult::kOverlayChanged,
+            rules.SetRules(base_rules + added_rules));
+  auto base_engine = std::make_unique<adblock::Engine>(rules.GetBaseRules());
+  auto overlay_engine =
+      std::make_unique<adblock::Engine>(rules.GetOverlayRules());
+  auto rebuilt_engine =
+      std::make_unique<adblock::Engine>(base_rules + added_rules);
+
+  struct {
+    const char* url;
+    const char* host;
+    bool is_third_party;
+    const char* resource_type;
+  } cases[] = {
+      {"https://a.com/ad_banner.png", "a.com", false, "image"},
+      {"https://b.com/allowed/ad.js", "b.com", true, "script"},
+      {"https://b.com/ads/banner.png", "b.com", true, "image"},
+      {"https://b.com/index.html", "b.com", true, "sub_frame"},
+      {"https://c.com/tracker.js", "c.com", true, "script"},
+      {"https://c.com/tracker.js", "c.com", false, "script"},
+      {"https://d.com/lib.js", "d.com", true, "script"},
+      {"https://d.com/logo.png", "d.com", true, "image"},
+  };
+  for (const auto& c : cases) {
+    bool explicit_cancel;
+    bool overlay_saved;
+    bool rebuilt_saved;
+    std::string mock_data_url;
+    bool overlay_match = brave_shields::MatchesWithOverlay(
+        base_engine.get(), overlay_engine.get(), c.url, c.host, "e.com",
+        c.is_third_party, c.resource_type, &explicit_cancel, &overlay_saved,
+        &mock_data_url);
+    bool rebuilt_match = rebuilt_engine->matches(
+        c.url, c.host, "e.com", c.is_third_party, c.resource_type,
+        &explicit_cancel, &rebuilt_saved, &mock_data_url);
+    EXPECT_EQ(rebuilt_match, overlay_match) << c.url;
+    EXPECT_EQ(rebuilt_saved, overlay_saved) << c.url;
+  }
+}
+
+TEST(AdBlockOverlayRulesTest, OverlayRedirectsWhatTheBaseBlocks) {
+  const std::string resources =
+      "[{\"name\": \"noop.js\", \"aliases\": [], "
+      "\"kind\": {\"mime\": \"application/javascript\"}, "
+      "\"content\": \"KGZ1bmN0aW9uKCkgewogICd1c2Ugc3RyaWN0JzsKfSkoKTsK\"}]";
+  const std::string base_rules = "||a.com/ad.js\n";
+  const std::string added_rules = "||a.com/ad.js$redirect=noop.js\n";
+
+  AdBlockOverlayRules rules;
+  rules.SetRules(base_rules);
+  ASSERT_EQ(UpdateResult::kOverlayChanged,
+            rules.SetRules(base_rules + added_rules));
+  auto base_engine = std::make_unique<adblock::Engine>(rules.GetBaseRules());
+  auto overlay_engine =
+      std::make_unique<adblock::Engine>(rules.GetOverlayRules());
+  auto rebuilt_engine =
+      std::make_unique<adblock::Engine>(base_rules + added_rules);
+  base_engine->addResources(resources);
+  overlay_engine->addResources(resources);
+  rebuilt_engine->addResources(resources);
+
+  bool explicit_cancel;
+  bool overlay_saved;
+  bool rebuilt_saved;
+  std::string overlay_mock_data_url;
+  std::string rebuilt_mock_data_url;
+  EXPECT_TRUE(brave_shields::MatchesWithOverlay(
+      base_engine.get(), overlay_engine.get(), "https://a.com/ad.js", "a.com",
+      "e.com", true, "script", &explicit_cancel, &overlay_saved,
+      &overlay_mock_data_url));
+  EXPECT_TRUE(rebuilt_engine->matches(
+      "https://a.com/ad.js", "a.com", "e.com", true, "script",
+      &explicit_cancel, &rebuilt_saved, &rebuilt_mock_data_url));
+  EXPECT_FALSE(rebuilt_mock_data_url.empty());
+  EXPECT_EQ(rebuilt_mock_data_url, overlay_mock_data_url);
+}
@@ -25,6 +25,7 @@
 #include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
 #include "components/prefs/pref_service.h"
+#include "content/public/browser/browser_thread.h"
 
 namespace brave_shields {
 
@@ -66,6 +67,13 @@ bool AdBlockRegionalService::Init() {
   return true;
 }
 
+void AdBlockRegionalService::Stop() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  Unregister();
+  CancelGetDATFileData();
+  weak_factory_.InvalidateWeakPtrs();
+}
+
 void AdBlockRegionalService::OnComponentReady(
     const std::string& component_id,
     const base::FilePath& install_dir,
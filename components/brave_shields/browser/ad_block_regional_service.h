@@ -31,6 +31,11 @@ class AdBlockRegionalService : public AdBlockBaseService {
 
   void SetCatalogEntry(const adblock::FilterList& entry);
 
+  // Unregisters the list's component and drops any load still in flight, so
+  // that nothing more is posted to the adblock task runner for this service.
+  // Called on the UI thread when the list is disabled.
+  void Stop();
+
   std::string GetUUID() const { return uuid_; }
   std::string GetTitle() const { return title_; }
 
@@ -5,15 +5,19 @@
 
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "base/bind.h"
+#include "base/bind_helpers.h"
 #include "base/strings/string_util.h"
 #include "base/task/post_task.h"
 #include "base/values.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/common/pref_names.h"
+#include "brave/components/brave_shields/browser/ad_block_base_service.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/ad_block_service_helper.h"
@@ -30,7 +34,9 @@ namespace brave_shields {
 AdBlockRegionalServiceManager::AdBlockRegionalServiceManager(
     brave_component_updater::BraveComponent::Delegate* delegate)
     : delegate_(delegate),
-      initialized_(false) {
+      initialized_(false),
+      active_regional_services_(
+          base::MakeRefCounted<ActiveRegionalServices>()) {
 }
 
 AdBlockRegionalServiceManager::~AdBlockRegionalServiceManager() {
@@ -41,7 +47,7 @@ bool AdBlockRegionalServiceManager::Init() {
   base::PostTask(
       FROM_HERE, {content::BrowserThread::UI},
       base::BindOnce(&AdBlockRegionalServiceManager::StartRegionalServices,
-                     base::Unretained(this)));
+                     weak_factory_.GetWeakPtr()));
   return true;
 }
 
@@ -84,11 +90,7 @@ void AdBlockRegionalServiceManager::StartRegionalServices() {
       auto catalog_entry = brave_shields::FindAdBlockFilterListByUUID(
           regional_catalog_, uuid);
       if (catalog_entry != regional_catalog_.end()) {
-        auto regional_service = AdBlockRegionalServiceFactory(
-            *catalog_entry, delegate_);
-        regional_service->Start();
-        regional_services_.insert(
-            std::make_pair(uuid, std::move(regional_service)));
+        StartRegionalService(*catalog_entry);
       }
     }
   }
@@ -96,6 +98,50 @@ void AdBlockRegionalServiceManager::StartRegionalServices() {
   initialized_ = true;
 }
 
+void AdBlockRegionalServiceManager::StartRegionalService(
+    const adblock::FilterList& catalog_entry) {
+  regional_services_lock_.AssertAcquired();
+  auto regional_service = AdBlockRegionalServiceFactory(
+      catalog_entry, delegate_);
+  regional_service->Start();
+  delegate_->GetTaskRunner()->PostTask(
+      FROM_HERE, base::BindOnce(&ActiveRegionalServices::Add,
+                                active_regional_services_,
+                                regional_service.get()));
+  regional_services_.insert(
+      std::make_pair(catalog_entry.uuid, std::move(regional_service)));
+}
+
+AdBlockRegionalServiceManager::ActiveRegionalServices::
+    ActiveRegionalServices() {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+AdBlockRegionalServiceManager::ActiveRegionalServices::
+    ~ActiveRegionalServices() = default;
+
+void AdBlockRegionalServiceManager::ActiveRegionalServices::Add(
+    AdBlockRegionalService* regional_service) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  services_.push_back(regional_service);
+  AdBlockBaseService::IncrementEngineGeneration();
+}
+
+void AdBlockRegionalServiceManager::ActiveRegionalServices::Remove(
+    AdBlockRegionalService* regional_service) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  auto it = std::find(services_.begin(), services_.end(), regional_service);
+  if (it != services_.end())
+    services_.erase(it);
+  AdBlockBaseService::IncrementEngineGeneration();
+}
+
+const std::vector<AdBlockRegionalService*>&
+AdBlockRegionalServiceManager::ActiveRegionalServices::services() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return services_;
+}
+
 void AdBlockRegionalServiceManager::UpdateFilterListPrefs(
     const std::string& uuid,
     bool enabled) {
@@ -130,11 +176,26 @@ bool AdBlockRegionalServiceManager::ShouldStartRequest(
     bool* matching_exception_filter,
     bool* cancel_request_explicitly,
     std::string* mock_data_url) {
-  base::AutoLock lock(regional_services_lock_);
-  for (const auto& regional_service : regional_services_) {
-    if (!regional_service.second->ShouldStartRequest(
-            url, resource_type, tab_host, matching_exception_filter,
-            cancel_request_explicitly, mock_data_url)) {
+  return ShouldStartRequestForLists(
+      url, AdBlockBaseService::ResourceTypeToString(resource_type), tab_host,
+      AdBlockBaseService::IsThirdPartyRequest(url, tab_host),
+      matching_exception_filter, cancel_request_explicitly, mock_data_url);
+}
+
+bool AdBlockRegionalServiceManager::ShouldStartRequestForLists(
+    const GURL& url,
+    const std::string& resource_type,
+    const std::string& tab_host,
+    bool is_third_party,
+    bool* matching_exception_filter,
+    bool* cancel_request_explicitly,
+    std::string* mock_data_url) {
+  DCHECK(delegate_->GetTaskRunner()->RunsTasksInCurrentSequence());
+  for (auto* regional_service : active_regional_services_->services()) {
+    if (!regional_service->ShouldStartRequestForList(
+            url, resource_type, tab_host, is_third_party,
+            matching_exception_filter, cancel_request_explicitly,
+            mock_data_url)) {
       return false;
     }
     if (matching_exception_filter && *matching_exception_filter) {
@@ -174,15 +235,24 @@ void AdBlockRegionalServiceManager::EnableFilterList(
     auto it = regional_services_.find(uuid);
     if (enabled) {
       DCHECK(it == regional_services_.end());
-      auto regional_service = AdBlockRegionalServiceFactory(
-          *catalog_entry, delegate_);
-      regional_service->Start();
-      regional_services_.insert(
-          std::make_pair(uuid, std::move(regional_service)));
+      StartRegionalService(*catalog_entry);
     } else {
       DCHECK(it != regional_services_.end());
-      it->second->Unregister();
+      std::unique_ptr<AdBlockRegionalService> regional_service =
+          std::move(it->second);
       regional_services_.erase(it);
+      regional_service->Stop();
+      // The adblock task runner may still be matching requests against the
+      // list. Take it out of the active services there first, then destroy
+      // it back here, where its weak pointers are bound.
+      AdBlockRegionalService* removed_service = regional_service.get();
+      delegate_->GetTaskRunner()->PostTaskAndReply(
+          FROM_HERE,
+          base::BindOnce(&ActiveRegionalServices::Remove,
+                         active_regional_services_, removed_service),
+          base::BindOnce(
+              base::DoNothing::Once<std::unique_ptr<AdBlockRegionalService>>(),
+              std::move(regional_service)));
     }
   }
 
@@ -191,65 +261,46 @@ void AdBlockRegionalServiceManager::EnableFilterList(
   base::PostTask(
       FROM_HERE, {content::BrowserThread::UI},
       base::BindOnce(&AdBlockRegionalServiceManager::UpdateFilterListPrefs,
-                     base::Unretained(this), uuid, enabled));
+                     weak_factory_.GetWeakPtr(), uuid, enabled));
 }
 
-base::Optional<base::Value>
+base::Optional<CosmeticResources>
 AdBlockRegionalServiceManager::UrlCosmeticResources(
         const std::string& url) {
-  base::AutoLock lock(regional_services_lock_);
-  auto it = regional_services_.begin();
-  if (it == regional_services_.end()) {
-    return base::Optional<base::Value>();
-  }
-  base::Optional<base::Value> first_value =
-      it->second->UrlCosmeticResources(url);
-
-  for ( ; it != regional_services_.end(); it++) {
-    base::Optional<base::Value> next_value =
-        it->second->UrlCosmeticResources(url);
-    if (first_value) {
-      if (next_value) {
-        MergeResourcesInto(std::move(*next_value), &*first_value, false);
-      }
+  DCHECK(delegate_->GetTaskRunner()->RunsTasksInCurrentSequence());
+  base::Optional<CosmeticResources> resources;
+  for (auto* regional_service : active_regional_services_->services()) {
+    base::Optional<CosmeticResources> next_resources =
+        regional_service->UrlCosmeticResources(url);
+    if (!next_resources) {
+      continue;
+    }
+    if (resources) {
+      resources->MergeFrom(std::move(*next_resources), false);
     } else {
-      first_value = std::move(next_value);
+      resources = std::move(next_resources);
     }
   }
 
-  return first_value;
+  return resources;
 }
 
-base::Optional<base::Value>
+std::vector<std::string>
 AdBlockRegionalServiceManager::HiddenClassIdSelectors(
         const std::vector<std::string>& classes,
         const std::vector<std::string>& ids,
         const std::vector<std::string>& exceptions) {
-  base::AutoLock lock(regional_services_lock_);
-  auto it = regional_services_.begin();
-  if (it == regional_services_.end()) {
-    return base::Optional<base::Value>();
-  }
-  base::Optional<base::Value> first_value =
-      it->second->HiddenClassIdSelectors(classes, ids, exceptions);
-
-  for ( ; it != regional_services_.end(); it++) {
-    base::Optional<base::Value> next_value =
-        it->second->HiddenClassIdSelectors(classes, ids, exceptions);
-    if (first_value && first_value->is_list()) {
-      if (next_value && next_value->is_list()) {
-        for (auto i = next_value->GetList().begin();
-                i < next_value->GetList().end();
-                i++) {
-          first_value->Append(std::move(*i));
-        }
-      }
-    } else {
-      first_value = std::move(next_value);
-    }
+  DCHECK(delegate_->GetTaskRunner()->RunsTasksInCurrentSequence());
+  std::vector<std::string> selectors;
+  for (auto* regional_service : active_regional_services_->services()) {
+    std::vector<std::string> next_selectors =
+        regional_service->HiddenClassIdSelectors(classes, ids, exceptions);
+    selectors.insert(selectors.end(),
+                     std::make_move_iterator(next_selectors.begin()),
+                     std::make_move_iterator(next_selectors.end()));
   }
 
-  return first_value;
+  return selectors;
 }
 
 void AdBlockRegionalServiceManager::SetRegionalCatalog(
@@ -12,11 +12,14 @@
 #include <vector>
 
 #include "base/macros.h"
-#include "base/memory/scoped_refptr.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
 #include "base/optional.h"
+#include "base/sequence_checker.h"
 #include "base/synchronization/lock.h"
 #include "base/values.h"
 #include "brave/components/brave_component_updater/browser/brave_component.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
 #include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
 #include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
 #include "url/gurl.h"
@@ -53,13 +56,22 @@ class AdBlockRegionalServiceManager {
                           bool* matching_exception_filter,
                           bool* cancel_request_explicitly,
                           std::string* mock_data_url);
+  // Checks the request against every enabled regional list. Runs on the
+  // adblock task runner without taking |regional_services_lock_|.
+  bool ShouldStartRequestForLists(const GURL& url,
+                                  const std::string& resource_type,
+                                  const std::string& tab_host,
+                                  bool is_third_party,
+                                  bool* matching_exception_filter,
+                                  bool* cancel_request_explicitly,
+                                  std::string* mock_data_url);
   void EnableTag(const std::string& tag, bool enabled);
   void AddResources(const std::string& resources);
   void EnableFilterList(const std::string& uuid, bool enabled);
 
-  base::Optional<base::Value> UrlCosmeticResources(
+  base::Optional<CosmeticResources> UrlCosmeticResources(
           const std::string& url);
-  base::Optional<base::Value> HiddenClassIdSelectors(
+  std::vector<std::string> HiddenClassIdSelectors(
           const std::vector<std::string>& classes,
           const std::vector<std::string>& ids,
           const std::vector<std::string>& exceptions);
@@ -69,15 +81,45 @@ class AdBlockRegionalServiceManager {
   bool Init();
   void StartRegionalServices();
   void UpdateFilterListPrefs(const std::string& uuid, bool enabled);
+  void StartRegionalService(const adblock::FilterList& catalog_entry);
+
+  // The enabled regional services as seen from the adblock task runner,
+  // which is the only sequence that reads or writes them. Services are added
+  // and removed by posting tasks to that sequence, and a disabled service is
+  // only destroyed, back on the UI thread, once it has been removed there,
+  // so the request path can walk them without locking. Ref-counted so that
+  // those tasks don't outlive what they write to.
+  class ActiveRegionalServices
+      : public base::RefCountedThreadSafe<ActiveRegionalServices> {
+   public:
+    ActiveRegionalServices();
+
+    void Add(AdBlockRegionalService* regional_service);
+    void Remove(AdBlockRegionalService* regional_service);
+
+    const std::vector<AdBlockRegionalService*>& services() const;
+
+   private:
+    friend class base::RefCountedThreadSafe<ActiveRegionalServices>;
+    ~ActiveRegionalServices();
+
+    std::vector<AdBlockRegionalService*> services_;
+
+    SEQUENCE_CHECKER(sequence_checker_);
+    DISALLOW_COPY_AND_ASSIGN(ActiveRegionalServices);
+  };
 
   brave_component_updater::BraveComponent::Delegate* delegate_;  // NOT OWNED
   bool initialized_;
   base::Lock regional_services_lock_;
   std::map<std::string, std::unique_ptr<AdBlockRegionalService>>
       regional_services_;
+  const scoped_refptr<ActiveRegionalServices> active_regional_services_;
 
   std::vector<adblock::FilterList> regional_catalog_;
 
+  base::WeakPtrFactory<AdBlockRegionalServiceManager> weak_factory_{this};
+
   DISALLOW_COPY_AND_ASSIGN(AdBlockRegionalServiceManager);
 };
 
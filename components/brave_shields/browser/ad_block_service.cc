@@ -79,9 +79,12 @@ bool AdBlockService::ShouldStartRequest(
     bool* did_match_exception,
     bool* cancel_request_explicitly,
     std::string* mock_data_url) {
+  // Derive the request attributes once and check every list with them.
+  const std::string filter_option = ResourceTypeToString(resource_type);
+  const bool is_third_party = IsThirdPartyRequest(url, tab_host);
 
-  if (!AdBlockBaseService::ShouldStartRequest(
-          url, resource_type, tab_host, did_match_exception,
+  if (!ShouldStartRequestForList(
+          url, filter_option, tab_host, is_third_party, did_match_exception,
           cancel_request_explicitly, mock_data_url)) {
     return false;
   }
@@ -89,8 +92,8 @@ bool AdBlockService::ShouldStartRequest(
     return true;
   }
 
-  if (!regional_service_manager()->ShouldStartRequest(
-          url, resource_type, tab_host, did_match_exception,
+  if (!regional_service_manager()->ShouldStartRequestForLists(
+          url, filter_option, tab_host, is_third_party, did_match_exception,
           cancel_request_explicitly, mock_data_url)) {
     return false;
   }
@@ -98,9 +101,9 @@ bool AdBlockService::ShouldStartRequest(
     return true;
   }
 
-  if (!custom_filters_service()->ShouldStartRequest(
-        url, resource_type, tab_host, did_match_exception,
-        cancel_request_explicitly, mock_data_url)) {
+  if (!custom_filters_service()->ShouldStartRequestForList(
+          url, filter_option, tab_host, is_third_party, did_match_exception,
+          cancel_request_explicitly, mock_data_url)) {
     return false;
   }
   if (did_match_exception && *did_match_exception) {
@@ -12,6 +12,7 @@
 #include "base/logging.h"
 #include "base/strings/string_util.h"
 #include "base/values.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
 
 using adblock::FilterList;
 
@@ -122,73 +123,14 @@ std::vector<FilterList> RegionalCatalogFromJSON(
 // will be moved into a possibly new field of `into` called
 // `force_hide_selectors`.
 void MergeResourcesInto(base::Value from, base::Value* into, bool force_hide) {
-  base::Value* resources_hide_selectors = nullptr;
-  if (force_hide) {
-    resources_hide_selectors = into->FindKey("force_hide_selectors");
-    if (!resources_hide_selectors || !resources_hide_selectors->is_list()) {
-        into->SetKey("force_hide_selectors", base::ListValue());
-        resources_hide_selectors = into->FindKey("force_hide_selectors");
-    }
-  } else {
-    resources_hide_selectors = into->FindKey("hide_selectors");
-  }
-  base::Value* from_resources_hide_selectors =
-      from.FindKey("hide_selectors");
-  if (resources_hide_selectors && from_resources_hide_selectors) {
-    for (auto i = from_resources_hide_selectors->GetList().begin();
-            i < from_resources_hide_selectors->GetList().end();
-            i++) {
-      resources_hide_selectors->Append(std::move(*i));
-    }
-  }
-
-  base::Value* resources_style_selectors = into->FindKey("style_selectors");
-  base::Value* from_resources_style_selectors =
-      from.FindKey("style_selectors");
-  if (resources_style_selectors && from_resources_style_selectors) {
-    for (auto i : from_resources_style_selectors->DictItems()) {
-      base::Value* resources_entry =
-          resources_style_selectors->FindKey(i.first);
-      if (resources_entry) {
-        for (auto j = i.second.GetList().begin();
-                j < i.second.GetList().end();
-                j++) {
-          resources_entry->Append(std::move(*j));
-        }
-      } else {
-        resources_style_selectors->SetKey(i.first, std::move(i.second));
-      }
-    }
-  }
-
-  base::Value* resources_exceptions = into->FindKey("exceptions");
-  base::Value* from_resources_exceptions = from.FindKey("exceptions");
-  if (resources_exceptions && from_resources_exceptions) {
-    for (auto i = from_resources_exceptions->GetList().begin();
-            i < from_resources_exceptions->GetList().end();
-            i++) {
-      resources_exceptions->Append(std::move(*i));
-    }
-  }
-
-  base::Value* resources_injected_script = into->FindKey("injected_script");
-  base::Value* from_resources_injected_script =
-      from.FindKey("injected_script");
-  if (resources_injected_script && from_resources_injected_script) {
-    *resources_injected_script = base::Value(
-            resources_injected_script->GetString()
-            + '\n'
-            + from_resources_injected_script->GetString());
-  }
-
-  base::Value* resources_generichide = into->FindKey("generichide");
-  base::Value* from_resources_generichide =
-      from.FindKey("generichide");
-  if (from_resources_generichide) {
-    if (from_resources_generichide->GetBool()) {
-      *resources_generichide = base::Value(true);
-    }
+  if (!from.is_dict() || !into->is_dict()) {
+    return;
   }
+  base::Optional<CosmeticResources> into_resources =
+      CosmeticResources::FromValue(std::move(*into));
+  into_resources->MergeFrom(
+      std::move(*CosmeticResources::FromValue(std::move(from))), force_hide);
+  *into = std::move(*into_resources).ToValue();
 }
 
 }  // namespace brave_shields
@@ -0,0 +1,121 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/blocked_events_buffer.h"
+
+#include <tuple>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/task/post_task.h"
+#include "brave/components/brave_perf_predictor/browser/buildflags.h"
+#include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/browser_thread.h"
+
+#if BUILDFLAG(ENABLE_BRAVE_PERF_PREDICTOR)
+#include "brave/components/brave_perf_predictor/browser/perf_predictor_tab_helper.h"
+#endif
+
+namespace brave_shields {
+
+namespace {
+
+// How long blocked-resource events are buffered before being dispatched.
+constexpr base::TimeDelta kDefaultFlushDelay =
+    base::TimeDelta::FromMilliseconds(200);
+
+}  // namespace
+
+bool BlockedEventsBuffer::FrameKey::operator<(const FrameKey& other) const {
+  return std::tie(frame_tree_node_id, render_process_id, render_frame_id) <
+         std::tie(other.frame_tree_node_id, other.render_process_id,
+                  other.render_frame_id);
+}
+
+// static
+BlockedEventsBuffer* BlockedEventsBuffer::GetInstance() {
+  static base::NoDestructor<BlockedEventsBuffer> instance;
+  return instance.get();
+}
+
+BlockedEventsBuffer::BlockedEventsBuffer()
+    : flush_delay_(kDefaultFlushDelay) {}
+
+BlockedEventsBuffer::~BlockedEventsBuffer() = default;
+
+void BlockedEventsBuffer::Add(int render_process_id,
+                              int render_frame_id,
+                              int frame_tree_node_id,
+                              const std::string& block_type,
+                              const std::string& subresource) {
+  const bool on_ui_thread =
+      content::BrowserThread::CurrentlyOn(content::BrowserThread::UI);
+  bool flush_now = false;
+  {
+    base::AutoLock lock(lock_);
+    pending_events_[{frame_tree_node_id, render_process_id, render_frame_id}]
+        .push_back({block_type, subresource});
+
+    if (on_ui_thread && flush_delay_.is_zero()) {
+      flush_now = true;
+    } else if (!is_flush_task_posted_) {
+      is_flush_task_posted_ = true;
+      flush_task_count_++;
+      base::PostDelayedTask(
+          FROM_HERE, {content::BrowserThread::UI},
+          base::BindOnce(&BlockedEventsBuffer::OnFlushTask,
+                         base::Unretained(this)),
+          flush_delay_);
+    }
+  }
+
+  if (flush_now)
+    Flush();
+}
+
+void BlockedEventsBuffer::Flush() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  std::map<FrameKey, std::vector<BlockedEvent>> events;
+  {
+    base::AutoLock lock(lock_);
+    events.swap(pending_events_);
+  }
+
+  for (const auto& frame_events : events) {
+    const FrameKey& key = frame_events.first;
+    BraveShieldsWebContentsObserver::DispatchBlockedEvents(
+        frame_events.second, key.render_process_id, key.render_frame_id,
+        key.frame_tree_node_id);
+
+#if BUILDFLAG(ENABLE_BRAVE_PERF_PREDICTOR)
+    for (const auto& event : frame_events.second) {
+      brave_perf_predictor::PerfPredictorTabHelper::DispatchBlockedEvent(
+          event.subresource, key.render_process_id, key.render_frame_id,
+          key.frame_tree_node_id);
+    }
+#endif
+  }
+}
+
+void BlockedEventsBuffer::SetFlushDelayForTesting(base::TimeDelta delay) {
+  base::AutoLock lock(lock_);
+  flush_delay_ = delay;
+}
+
+size_t BlockedEventsBuffer::GetFlushTaskCountForTesting() {
+  base::AutoLock lock(lock_);
+  return flush_task_count_;
+}
+
+void BlockedEventsBuffer::OnFlushTask() {
+  {
+    base::AutoLock lock(lock_);
+    is_flush_task_posted_ = false;
+  }
+  Flush();
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,78 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_BLOCKED_EVENTS_BUFFER_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_BLOCKED_EVENTS_BUFFER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/time/time.h"
+
+namespace brave_shields {
+
+struct BlockedEvent {
+  std::string block_type;
+  std::string subresource;
+};
+
+// Collects blocked-resource events from the sequences requests are handled on
+// and hands them to the UI thread in batches. At most one UI task is pending
+// at a time, however many resources are blocked meanwhile.
+class BlockedEventsBuffer {
+ public:
+  static BlockedEventsBuffer* GetInstance();
+
+  // May be called from any sequence.
+  void Add(int render_process_id,
+           int render_frame_id,
+           int frame_tree_node_id,
+           const std::string& block_type,
+           const std::string& subresource);
+
+  // Dispatches everything buffered so far. Must be called on the UI thread.
+  void Flush();
+
+  // A zero delay dispatches events added on the UI thread right away, and
+  // events added elsewhere in the next UI task.
+  void SetFlushDelayForTesting(base::TimeDelta delay);
+  // The number of UI tasks posted to flush the buffer.
+  size_t GetFlushTaskCountForTesting();
+
+ private:
+  friend class base::NoDestructor<BlockedEventsBuffer>;
+
+  struct FrameKey {
+    int frame_tree_node_id;
+    int render_process_id;
+    int render_frame_id;
+
+    bool operator<(const FrameKey& other) const;
+  };
+
+  BlockedEventsBuffer();
+  ~BlockedEventsBuffer();
+
+  void OnFlushTask();
+
+  base::Lock lock_;
+  std::map<FrameKey, std::vector<BlockedEvent>> pending_events_
+      GUARDED_BY(lock_);
+  // Set while a flush task is posted, so that no other one is.
+  bool is_flush_task_posted_ GUARDED_BY(lock_) = false;
+  base::TimeDelta flush_delay_ GUARDED_BY(lock_);
+  size_t flush_task_count_ GUARDED_BY(lock_) = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockedEventsBuffer);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_BLOCKED_EVENTS_BUFFER_H_
@@ -9,9 +9,8 @@
 
 #include "base/feature_list.h"
 #include "base/strings/string_number_conversions.h"
-#include "brave/components/brave_perf_predictor/browser/buildflags.h"
+#include "brave/components/brave_shields/browser/blocked_events_buffer.h"
 #include "brave/components/brave_shields/browser/brave_shields_p3a.h"
-#include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "brave/components/brave_shields/common/brave_shield_utils.h"
 #include "brave/components/brave_shields/common/features.h"
@@ -23,10 +22,6 @@
 #include "net/base/registry_controlled_domains/registry_controlled_domain.h"
 #include "url/gurl.h"
 
-#if BUILDFLAG(ENABLE_BRAVE_PERF_PREDICTOR)
-#include "brave/components/brave_perf_predictor/browser/perf_predictor_tab_helper.h"
-#endif
-
 using content::Referrer;
 
 namespace brave_shields {
@@ -420,16 +415,11 @@ void DispatchBlockedEvent(const GURL& request_url,
                           int render_process_id,
                           int frame_tree_node_id,
                           const std::string& block_type) {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-  BraveShieldsWebContentsObserver::DispatchBlockedEvent(
-      block_type, request_url.spec(),
-      render_process_id, render_frame_id, frame_tree_node_id);
-
-#if BUILDFLAG(ENABLE_BRAVE_PERF_PREDICTOR)
-  brave_perf_predictor::PerfPredictorTabHelper::DispatchBlockedEvent(
-      request_url.spec(), render_process_id,
-      render_frame_id, frame_tree_node_id);
-#endif
+  // Requests may be handled off the UI thread, so events are buffered on the
+  // calling sequence and reach the UI thread in batches.
+  BlockedEventsBuffer::GetInstance()->Add(render_process_id, render_frame_id,
+                                          frame_tree_node_id, block_type,
+                                          request_url.spec());
 }
 
 bool MaybeChangeReferrer(
@@ -87,6 +87,7 @@ void SetNoScriptControlType(HostContentSettingsMap* map,
 ControlType GetNoScriptControlType(HostContentSettingsMap* map,
                                    const GURL& url);
 
+// May be called from any sequence; the event is dispatched on the UI thread.
 void DispatchBlockedEvent(const GURL& request_url,
                           int render_frame_id,
                           int render_process_id,
@@ -7,6 +7,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -221,9 +222,8 @@ void BraveShieldsWebContentsObserver::AddBlockedSubresource(
 }
 
 // static
-void BraveShieldsWebContentsObserver::DispatchBlockedEvent(
-    std::string block_type,
-    std::string subresource,
+void BraveShieldsWebContentsObserver::DispatchBlockedEvents(
+    const std::vector<BlockedEvent>& events,
     int render_process_id,
     int render_frame_id,
     int frame_tree_node_id) {
@@ -231,32 +231,67 @@ void BraveShieldsWebContentsObserver::DispatchBlockedEvent(
 
   WebContents* web_contents = GetWebContents(render_process_id,
     render_frame_id, frame_tree_node_id);
-  DispatchBlockedEventForWebContents(block_type, subresource, web_contents);
+  if (!web_contents) {
+    return;
+  }
+  DispatchBlockedEventsForWebContents(events, web_contents);
 
-  if (web_contents) {
-    BraveShieldsWebContentsObserver* observer =
-        BraveShieldsWebContentsObserver::FromWebContents(web_contents);
-    if (observer &&
-        !observer->IsBlockedSubresource(subresource)) {
-      observer->AddBlockedSubresource(subresource);
-      PrefService* prefs = Profile::FromBrowserContext(
-          web_contents->GetBrowserContext())->
-          GetOriginalProfile()->
-          GetPrefs();
-
-      if (block_type == kAds) {
-        prefs->SetUint64(kAdsBlocked, prefs->GetUint64(kAdsBlocked) + 1);
-      } else if (block_type == kHTTPUpgradableResources) {
-        prefs->SetUint64(kHttpsUpgrades, prefs->GetUint64(kHttpsUpgrades) + 1);
-      } else if (block_type == kJavaScript) {
-        prefs->SetUint64(kJavascriptBlocked,
-            prefs->GetUint64(kJavascriptBlocked) + 1);
-      } else if (block_type == kFingerprintingV2) {
-        prefs->SetUint64(kFingerprintingBlocked,
-            prefs->GetUint64(kFingerprintingBlocked) + 1);
-      }
+  BraveShieldsWebContentsObserver* observer =
+      BraveShieldsWebContentsObserver::FromWebContents(web_contents);
+  if (observer) {
+    observer->CountBlockedEvents(events);
+  }
+}
+
+void BraveShieldsWebContentsObserver::CountBlockedEvents(
+    const std::vector<BlockedEvent>& events) {
+  uint64_t ads_blocked = 0;
+  uint64_t https_upgrades = 0;
+  uint64_t javascript_blocked = 0;
+  uint64_t fingerprinting_blocked = 0;
+  for (const auto& event : events) {
+    if (IsBlockedSubresource(event.subresource)) {
+      continue;
+    }
+    AddBlockedSubresource(event.subresource);
+    if (event.block_type == kAds) {
+      ads_blocked++;
+    } else if (event.block_type == kHTTPUpgradableResources) {
+      https_upgrades++;
+    } else if (event.block_type == kJavaScript) {
+      javascript_blocked++;
+    } else if (event.block_type == kFingerprintingV2) {
+      fingerprinting_blocked++;
     }
   }
+
+  if (!ads_blocked && !https_upgrades && !javascript_blocked &&
+      !fingerprinting_blocked) {
+    return;
+  }
+  PrefService* prefs = Profile::FromBrowserContext(
+      web_contents()->GetBrowserContext())->
+      GetOriginalProfile()->
+      GetPrefs();
+  if (ads_blocked) {
+    prefs->SetUint64(kAdsBlocked, prefs->GetUint64(kAdsBlocked) + ads_blocked);
+  }
+  if (https_upgrades) {
+    prefs->SetUint64(kHttpsUpgrades,
+        prefs->GetUint64(kHttpsUpgrades) + https_upgrades);
+  }
+  if (javascript_blocked) {
+    prefs->SetUint64(kJavascriptBlocked,
+        prefs->GetUint64(kJavascriptBlocked) + javascript_blocked);
+  }
+  if (fingerprinting_blocked) {
+    prefs->SetUint64(kFingerprintingBlocked,
+        prefs->GetUint64(kFingerprintingBlocked) + fingerprinting_blocked);
+  }
+}
+
+void BraveShieldsWebContentsObserver::WebContentsDestroyed() {
+  BlockedEventsBuffer::GetInstance()->Flush();
 }
 
 #if !defined(OS_ANDROID)
@@ -287,6 +322,42 @@ void BraveShieldsWebContentsObserver::DispatchBlockedEventForWebContents(
   }
 #endif
 }
+
+// static
+void BraveShieldsWebContentsObserver::DispatchBlockedEventsForWebContents(
+    const std::vector<BlockedEvent>& events,
+    WebContents* web_contents) {
+#if BUILDFLAG(ENABLE_EXTENSIONS)
+  Profile* profile =
+      Profile::FromBrowserContext(web_contents->GetBrowserContext());
+  EventRouter* event_router = EventRouter::Get(profile);
+  if (!profile || !event_router) {
+    return;
+  }
+  const int tab_id = extensions::ExtensionTabUtil::GetTabId(web_contents);
+  // The Shields panel lists each blocked subresource once, so repeats within
+  // a batch are broadcast only once.
+  std::set<std::pair<std::string, std::string>> dispatched;
+  for (const auto& blocked_event : events) {
+    if (!dispatched.emplace(blocked_event.block_type,
+                            blocked_event.subresource).second) {
+      continue;
+    }
+    extensions::api::brave_shields::OnBlocked::Details details;
+    details.tab_id = tab_id;
+    details.block_type = blocked_event.block_type;
+    details.subresource = blocked_event.subresource;
+    std::unique_ptr<base::ListValue> args(
+        extensions::api::brave_shields::OnBlocked::Create(details)
+          .release());
+    std::unique_ptr<Event> event(
+        new Event(extensions::events::BRAVE_AD_BLOCKED,
+          extensions::api::brave_shields::OnBlocked::kEventName,
+          std::move(args)));
+    event_router->BroadcastEvent(std::move(event));
+  }
+#endif
+}
 #endif
 
 bool BraveShieldsWebContentsObserver::OnMessageReceived(
@@ -339,6 +410,12 @@ void BraveShieldsWebContentsObserver::RegisterProfilePrefs(
 
 void BraveShieldsWebContentsObserver::ReadyToCommitNavigation(
     content::NavigationHandle* navigation_handle) {
+  // Report everything blocked on the outgoing page before it is replaced.
+  if (navigation_handle->IsInMainFrame() &&
+      !navigation_handle->IsSameDocument()) {
+    BlockedEventsBuffer::GetInstance()->Flush();
+  }
+
   // when the main frame navigate away
   if (navigation_handle->IsInMainFrame() &&
       !navigation_handle->IsSameDocument() &&
@@ -14,6 +14,7 @@
 #include "base/macros.h"
 #include "base/synchronization/lock.h"
 #include "base/strings/string16.h"
+#include "brave/components/brave_shields/browser/blocked_events_buffer.h"
 #include "content/public/browser/web_contents_observer.h"
 #include "content/public/browser/web_contents_user_data.h"
 
@@ -36,11 +37,11 @@ class BraveShieldsWebContentsObserver : public content::WebContentsObserver,
       const std::string& block_type,
       const std::string& subresource,
       content::WebContents* web_contents);
-  static void DispatchBlockedEvent(
-      std::string block_type,
-      std::string subresource,
-      int render_process_id,
-      int render_frame_id, int frame_tree_node_id);
+  // Dispatches and counts a batch of events blocked in one frame.
+  static void DispatchBlockedEvents(const std::vector<BlockedEvent>& events,
+                                    int render_process_id,
+                                    int render_frame_id,
+                                    int frame_tree_node_id);
   static GURL GetTabURLFromRenderFrameInfo(int render_process_id,
                                            int render_frame_id,
                                            int render_frame_tree_node_id);
@@ -74,6 +75,7 @@ class BraveShieldsWebContentsObserver : public content::WebContentsObserver,
       content::NavigationHandle* navigation_handle) override;
   void DidFinishNavigation(
       content::NavigationHandle* navigation_handle) override;
+  void WebContentsDestroyed() override;
 
   // Invoked if an IPC message is coming from a specific RenderFrameHost.
   bool OnMessageReceived(const IPC::Message& message,
@@ -94,6 +96,13 @@ class BraveShieldsWebContentsObserver : public content::WebContentsObserver,
 
  private:
   friend class content::WebContentsUserData<BraveShieldsWebContentsObserver>;
+
+  static void DispatchBlockedEventsForWebContents(
+      const std::vector<BlockedEvent>& events,
+      content::WebContents* web_contents);
+  // Adds the subresources not blocked before on this page to the stats.
+  void CountBlockedEvents(const std::vector<BlockedEvent>& events);
+
   std::vector<std::string> allowed_script_origins_;
   // We keep a set of the current page's blocked URLs in case the page
   // continually tries to load the same blocked URLs.
@@ -4,6 +4,7 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "base/json/json_reader.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources.h"
 #include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -306,5 +307,54 @@ TEST_F(CosmeticResourceMergeTest, MergeStyles) {
   CompareMergeFromStrings(a, b, false, expected);
 }
 
+TEST_F(CosmeticResourceMergeTest, TypedMerge) {
+  const std::string b = "{"
+      "\"hide_selectors\": [\"h\", \"i\"], "
+      "\"style_selectors\": {"
+          "\"c\": [\"color: #eee\"], "
+          "\"k\": [\"color: #111\"]"
+      "}, "
+      "\"exceptions\": [\"l\", \"m\"], "
+      "\"injected_script\": \"console.log('n')\", "
+      "\"generichide\": true"
+  "}";
+
+  base::Optional<CosmeticResources> typed =
+      CosmeticResources::FromJSON(NONEMPTY_RESOURCES);
+  ASSERT_TRUE(typed);
+  base::Optional<CosmeticResources> typed_b = CosmeticResources::FromJSON(b);
+  ASSERT_TRUE(typed_b);
+  typed->MergeFrom(std::move(*typed_b), false);
+  typed->MergeFrom(*CosmeticResources::FromJSON(EMPTY_RESOURCES), true);
+
+  const std::string expected = "{"
+      "\"hide_selectors\": [\"a\", \"b\", \"h\", \"i\"], "
+      "\"style_selectors\": {"
+          "\"c\": [\"color: #fff\", \"color: #eee\"], "
+          "\"d\": [\"color: #000\"], "
+          "\"k\": [\"color: #111\"]"
+      "}, "
+      "\"exceptions\": [\"e\", \"f\", \"l\", \"m\"], "
+      "\"injected_script\": \"console.log('g')\nconsole.log('n')\n\", "
+      "\"generichide\": true, "
+      "\"force_hide_selectors\": []"
+  "}";
+  const base::Optional<base::Value> expected_val =
+      base::JSONReader::Read(expected);
+  ASSERT_TRUE(expected_val);
+
+  ASSERT_EQ(std::move(*typed).ToValue(), *expected_val);
+}
+
+TEST_F(CosmeticResourceMergeTest, TypedFromJSONRejectsNonDictionary) {
+  EXPECT_FALSE(CosmeticResources::FromJSON("[]"));
+  EXPECT_FALSE(CosmeticResources::FromJSON("not json"));
+}
+
+TEST_F(CosmeticResourceMergeTest, HiddenClassIdSelectorsFromJSON) {
+  EXPECT_EQ(HiddenClassIdSelectorsFromJSON("[\".a\", \"#b\"]"),
+            std::vector<std::string>({".a", "#b"}));
+  EXPECT_TRUE(HiddenClassIdSelectorsFromJSON("null").empty());
+}
 
 }  // namespace brave_shields
@@ -6,40 +6,87 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
 #define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "base/containers/mru_cache.h"
 #include "base/synchronization/lock.h"
 
+// A thread-safe MRU cache split into independently locked shards so that
+// lookups from different threads rarely contend. Each shard evicts on its
+// own; caches too small to split usefully use a single shard and keep exact
+// LRU order.
 template <class T> class HTTPSERecentlyUsedCache {
  public:
-  explicit HTTPSERecentlyUsedCache(size_t size = 100) : data_(size) {}
+  static constexpr size_t kMinShardSize = 64;
+  static constexpr size_t kMaxShardCount = 16;
+
+  explicit HTTPSERecentlyUsedCache(size_t size = 100)
+      : shards_(std::max<size_t>(
+            1, std::min(kMaxShardCount, size / kMinShardSize))) {
+    const size_t shard_size = (size + shards_.size() - 1) / shards_.size();
+    for (auto& shard : shards_)
+      shard = std::make_unique<Shard>(shard_size);
+  }
 
   void add(const std::string& key, const T& value) {
-    base::AutoLock create(lock_);
-    data_.Put(key, value);
+    Shard* shard = GetShard(key);
+    base::AutoLock create(shard->lock);
+    shard->data.Put(key, value);
   }
 
   bool get(const std::string& key, T* value) {
-    base::AutoLock create(lock_);
-    auto it = data_.Get(key);
-    if (it != data_.end()) {
+    Shard* shard = GetShard(key);
+    base::AutoLock create(shard->lock);
+    auto it = shard->data.Get(key);
+    if (it != shard->data.end()) {
       *value = it->second;
+      hit_count_++;
       return true;
     }
+    miss_count_++;
     return false;
   }
 
   void remove(const std::string& key) {
-    base::AutoLock lock(lock_);
-    auto it = data_.Peek(key);
-    if (it != data_.end())
-      data_.Erase(it);
+    Shard* shard = GetShard(key);
+    base::AutoLock lock(shard->lock);
+    auto it = shard->data.Peek(key);
+    if (it != shard->data.end())
+      shard->data.Erase(it);
+  }
+
+  void clear() {
+    for (auto& shard : shards_) {
+      base::AutoLock lock(shard->lock);
+      shard->data.Clear();
+    }
   }
 
+  size_t shard_count() const { return shards_.size(); }
+  size_t hit_count() const { return hit_count_; }
+  size_t miss_count() const { return miss_count_; }
+
  private:
-  base::MRUCache<std::string, T> data_;
-  base::Lock lock_;
+  struct Shard {
+    explicit Shard(size_t size) : data(size) {}
+    base::MRUCache<std::string, T> data;
+    base::Lock lock;
+  };
+
+  Shard* GetShard(const std::string& key) {
+    if (shards_.size() == 1)
+      return shards_[0].get();
+    return shards_[std::hash<std::string>()(key) % shards_.size()].get();
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<size_t> hit_count_{0};
+  std::atomic<size_t> miss_count_{0};
 };
 
 #endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
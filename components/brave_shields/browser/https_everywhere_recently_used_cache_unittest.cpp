@@ -3,7 +3,9 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this file,
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "brave/components/brave_shields/browser/https_everywhere_recently_used_cache.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -28,3 +30,63 @@ TEST(HTTPSEverywhereRecentlyUsedCacheTest, Operations) {
   cache.remove("kD");
   ASSERT_FALSE(cache.get("kD", &v));
 }
+
+TEST(HTTPSEverywhereRecentlyUsedCacheTest, ShardingAndStats) {
+  using Cache = HTTPSERecentlyUsedCache<std::string>;
+  EXPECT_EQ(1u, Cache(100).shard_count());
+  EXPECT_EQ(16u, Cache(4096).shard_count());
+
+  Cache cache(4096);
+  std::string v;
+  EXPECT_FALSE(cache.get("kA", &v));
+  cache.add("kA", "vA");
+  EXPECT_TRUE(cache.get("kA", &v));
+  EXPECT_EQ("vA", v);
+  EXPECT_EQ(1u, cache.hit_count());
+  EXPECT_EQ(1u, cache.miss_count());
+
+  cache.clear();
+  EXPECT_FALSE(cache.get("kA", &v));
+}
+
+// Replays a long-tailed trace over a few thousand hosts, as a browsing
+// session would produce, and compares the old fixed 100 entry cache with the
+// default service size.
+TEST(HTTPSEverywhereRecentlyUsedCacheTest, HitRateOnHostTrace) {
+  using Cache = HTTPSERecentlyUsedCache<std::string>;
+  const size_t kHostCount = 3000;
+  const size_t kRequestCount = 50000;
+
+  // Zipf-distributed host ranks drawn with a fixed LCG so the trace is
+  // deterministic.
+  std::vector<double> cumulative_weights;
+  double total = 0;
+  for (size_t rank = 1; rank <= kHostCount; ++rank) {
+    total += 1.0 / rank;
+    cumulative_weights.push_back(total);
+  }
+  std::vector<std::string> trace;
+  uint64_t state = 42;
+  for (size_t i = 0; i < kRequestCount; ++i) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    double sample = (state >> 11) * (1.0 / (1ULL << 53)) * total;
+    size_t rank = std::upper_bound(cumulative_weights.begin(),
+                                   cumulative_weights.end(), sample) -
+                  cumulative_weights.begin();
+    trace.push_back("http://host" + std::to_string(rank) + ".com/");
+  }
+
+  auto replay = [&trace](Cache* cache) {
+    std::string v;
+    for (const auto& url : trace) {
+      if (!cache->get(url, &v))
+        cache->add(url, url);
+    }
+    return static_cast<double>(cache->hit_count()) / trace.size();
+  };
+  Cache old_cache(100);
+  Cache new_cache(4096);
+  const double old_hit_rate = replay(&old_cache);
+  const double new_hit_rate = replay(&new_cache);
+  EXPECT_GT(new_hit_rate, old_hit_rate + 0.2);
+}
@@ -0,0 +1,444 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_rule_index.h"
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+#include "base/big_endian.h"
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/hash/hash.h"
+#include "base/json/json_reader.h"
+#include "base/logging.h"
+#include "base/values.h"
+#include "third_party/re2/src/re2/re2.h"
+#include "third_party/re2/src/re2/set.h"
+
+namespace brave_shields {
+
+namespace {
+
+constexpr char kMagic[] = "HTSE";
+constexpr size_t kMagicSize = 4;
+constexpr size_t kHeaderSize = kMagicSize + 3 * sizeof(uint32_t);
+constexpr size_t kEntrySize = 4 * sizeof(uint32_t);
+
+void AppendU32(std::string* out, size_t value) {
+  DCHECK_LE(value, std::numeric_limits<uint32_t>::max());
+  char buffer[sizeof(uint32_t)];
+  base::WriteBigEndian(buffer, static_cast<uint32_t>(value));
+  out->append(buffer, sizeof(buffer));
+}
+
+void AppendString(std::string* out, const std::string& value) {
+  AppendU32(out, value.size());
+  out->append(value);
+}
+
+void AppendRulesets(std::string* out, const HTTPSERulesets& rulesets) {
+  AppendU32(out, rulesets.size());
+  for (const auto& ruleset : rulesets) {
+    AppendU32(out, ruleset.exclusions.size());
+    for (const auto& exclusion : ruleset.exclusions)
+      AppendString(out, exclusion);
+    AppendU32(out, ruleset.rules.size());
+    for (const auto& rule : ruleset.rules) {
+      out->push_back(rule.is_default ? 1 : 0);
+      if (!rule.is_default) {
+        AppendString(out, rule.from);
+        AppendString(out, rule.to);
+      }
+    }
+  }
+}
+
+bool ReadU32At(base::StringPiece data, size_t offset, uint32_t* value) {
+  if (offset > data.size() || data.size() - offset < sizeof(uint32_t))
+    return false;
+  base::ReadBigEndian(data.data() + offset, value);
+  return true;
+}
+
+bool ReadString(base::BigEndianReader* reader, base::StringPiece* value) {
+  uint32_t length;
+  return reader->ReadU32(&length) && reader->ReadPiece(value, length);
+}
+
+// Reads encoded rulesets into |builder|, which gets StartRuleset() before
+// each ruleset, then AddExclusion() and AddRule() calls with strings that
+// point into the encoded data.
+template <typename Builder>
+bool ReadRulesets(base::BigEndianReader* reader, Builder* builder) {
+  uint32_t ruleset_count;
+  if (!reader->ReadU32(&ruleset_count))
+    return false;
+  for (uint32_t i = 0; i < ruleset_count; ++i) {
+    builder->StartRuleset();
+    uint32_t exclusion_count;
+    if (!reader->ReadU32(&exclusion_count))
+      return false;
+    for (uint32_t j = 0; j < exclusion_count; ++j) {
+      base::StringPiece exclusion;
+      if (!ReadString(reader, &exclusion))
+        return false;
+      builder->AddExclusion(exclusion);
+    }
+    uint32_t rule_count;
+    if (!reader->ReadU32(&rule_count))
+      return false;
+    for (uint32_t j = 0; j < rule_count; ++j) {
+      uint8_t is_default;
+      base::StringPiece from;
+      base::StringPiece to;
+      if (!reader->ReadU8(&is_default))
+        return false;
+      if (!is_default &&
+          (!ReadString(reader, &from) || !ReadString(reader, &to)))
+        return false;
+      builder->AddRule(is_default != 0, from, to);
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+HTTPSERuleset::HTTPSERuleset() = default;
+HTTPSERuleset::HTTPSERuleset(const HTTPSERuleset& other) = default;
+HTTPSERuleset::~HTTPSERuleset() = default;
+
+HTTPSERulesets ParseHTTPSERulesets(const std::string& json) {
+  HTTPSERulesets rulesets;
+  base::Optional<base::Value> json_object = base::JSONReader::Read(json);
+  if (!json_object || !json_object->is_list())
+    return rulesets;
+
+  for (const auto& top_value : json_object->GetList()) {
+    if (!top_value.is_dict())
+      continue;
+    HTTPSERuleset ruleset;
+
+    const base::Value* exclusions = top_value.FindListKey("e");
+    if (exclusions) {
+      for (const auto& exclusion : exclusions->GetList()) {
+        if (!exclusion.is_dict())
+          continue;
+        const std::string* pattern = exclusion.FindStringKey("p");
+        if (pattern)
+          ruleset.exclusions.push_back(*pattern);
+      }
+    }
+
+    const base::Value* rules = top_value.FindListKey("r");
+    if (!rules) {
+      // Evaluation stops at a ruleset without rules, after its exclusions.
+      if (!ruleset.exclusions.empty())
+        rulesets.push_back(std::move(ruleset));
+      break;
+    }
+    for (const auto& rule_value : rules->GetList()) {
+      if (!rule_value.is_dict())
+        continue;
+      HTTPSERule rule;
+      if (rule_value.FindKey("d")) {
+        rule.is_default = true;
+      } else {
+        const std::string* from = rule_value.FindStringKey("f");
+        const std::string* to = rule_value.FindStringKey("t");
+        if (!from || !to)
+          continue;
+        rule.from = *from;
+        rule.to = *to;
+      }
+      ruleset.rules.push_back(std::move(rule));
+    }
+    rulesets.push_back(std::move(ruleset));
+  }
+  return rulesets;
+}
+
+std::string ApplyHTTPSERulesets(const std::string& url,
+                                const HTTPSERulesets& rulesets) {
+  for (const auto& ruleset : rulesets) {
+    for (const auto& exclusion : ruleset.exclusions) {
+      if (RE2::FullMatch(url, CorrectRuleForRE2(exclusion)))
+        return "";
+    }
+    for (const auto& rule : ruleset.rules) {
+      if (rule.is_default) {
+        std::string new_url(url);
+        return new_url.insert(4, "s");
+      }
+      std::string new_url(url);
+      RE2 reg_exp(rule.from);
+      if (RE2::Replace(&new_url, reg_exp, CorrectRuleForRE2(rule.to)) &&
+          new_url != url) {
+        return new_url;
+      }
+    }
+  }
+  return "";
+}
+
+std::string CorrectRuleForRE2(base::StringPiece rule) {
+  std::string corrected = rule.as_string();
+  std::replace(corrected.begin(), corrected.end(), '$', '\\');
+  return corrected;
+}
+
+struct CompiledHTTPSERulesets::Ruleset {
+  struct Rule {
+    bool is_default = false;
+    std::unique_ptr<RE2> from;
+    std::string to;
+  };
+
+  // Null when the ruleset has no valid exclusion patterns.
+  std::unique_ptr<RE2::Set> exclusions;
+  std::vector<Rule> rules;
+};
+
+// Compiles rulesets one piece at a time, in the order they are stored.
+class CompiledHTTPSERulesets::Builder {
+ public:
+  explicit Builder(CompiledHTTPSERulesets* compiled) : compiled_(compiled) {}
+
+  void StartRuleset() {
+    FinishRuleset();
+    ruleset_ = std::make_unique<Ruleset>();
+  }
+
+  void AddExclusion(base::StringPiece exclusion) {
+    // Anchoring both ends gives RE2::FullMatch semantics. Invalid patterns
+    // never match, so leaving them out of the set changes nothing.
+    if (!exclusions_) {
+      exclusions_ =
+          std::make_unique<RE2::Set>(RE2::Options(), RE2::ANCHOR_BOTH);
+    }
+    if (exclusions_->Add(CorrectRuleForRE2(exclusion), nullptr) >= 0)
+      has_exclusion_pattern_ = true;
+  }
+
+  void AddRule(bool is_default, base::StringPiece from, base::StringPiece to) {
+    Ruleset::Rule rule;
+    rule.is_default = is_default;
+    if (!rule.is_default) {
+      rule.from =
+          std::make_unique<RE2>(re2::StringPiece(from.data(), from.size()));
+      rule.to = CorrectRuleForRE2(to);
+    }
+    ruleset_->rules.push_back(std::move(rule));
+  }
+
+  // Must be called once every ruleset has been added.
+  void FinishRuleset() {
+    if (!ruleset_)
+      return;
+    if (has_exclusion_pattern_ && exclusions_->Compile())
+      ruleset_->exclusions = std::move(exclusions_);
+    exclusions_.reset();
+    has_exclusion_pattern_ = false;
+    compiled_->rulesets_.push_back(std::move(ruleset_));
+  }
+
+ private:
+  CompiledHTTPSERulesets* compiled_;
+  std::unique_ptr<Ruleset> ruleset_;
+  std::unique_ptr<RE2::Set> exclusions_;
+  bool has_exclusion_pattern_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(Builder);
+};
+
+CompiledHTTPSERulesets::CompiledHTTPSERulesets() = default;
+
+CompiledHTTPSERulesets::CompiledHTTPSERulesets(
+    const HTTPSERulesets& rulesets) {
+  Builder builder(this);
+  for (const auto& ruleset : rulesets) {
+    builder.StartRuleset();
+    for (const auto& exclusion : ruleset.exclusions)
+      builder.AddExclusion(exclusion);
+    for (const auto& rule : ruleset.rules)
+      builder.AddRule(rule.is_default, rule.from, rule.to);
+  }
+  builder.FinishRuleset();
+}
+
+// static
+std::unique_ptr<CompiledHTTPSERulesets>
+CompiledHTTPSERulesets::CreateFromEncoded(base::StringPiece encoded) {
+  // Not make_unique: the default constructor is private.
+  std::unique_ptr<CompiledHTTPSERulesets> compiled(new CompiledHTTPSERulesets);
+  Builder builder(compiled.get());
+  base::BigEndianReader reader(encoded.data(), encoded.size());
+  if (!ReadRulesets(&reader, &builder))
+    return nullptr;
+  builder.FinishRuleset();
+  return compiled;
+}
+
+CompiledHTTPSERulesets::~CompiledHTTPSERulesets() = default;
+
+std::string CompiledHTTPSERulesets::Apply(const std::string& url) const {
+  for (const auto& ruleset : rulesets_) {
+    if (ruleset->exclusions && ruleset->exclusions->Match(url, nullptr))
+      return "";
+    for (const auto& rule : ruleset->rules) {
+      if (rule.is_default) {
+        std::string new_url(url);
+        return new_url.insert(4, "s");
+      }
+      std::string new_url(url);
+      if (RE2::Replace(&new_url, *rule.from, rule.to) && new_url != url)
+        return new_url;
+    }
+  }
+  return "";
+}
+
+HTTPSEverywhereRuleIndex::HTTPSEverywhereRuleIndex() = default;
+
+HTTPSEverywhereRuleIndex::~HTTPSEverywhereRuleIndex() = default;
+
+// static
+scoped_refptr<HTTPSEverywhereRuleIndex>
+HTTPSEverywhereRuleIndex::CreateFromFile(const base::FilePath& path) {
+  auto mapped_file = std::make_unique<base::MemoryMappedFile>();
+  if (!mapped_file->Initialize(path))
+    return nullptr;
+  scoped_refptr<HTTPSEverywhereRuleIndex> index(new HTTPSEverywhereRuleIndex);
+  base::StringPiece data(reinterpret_cast<const char*>(mapped_file->data()),
+                         mapped_file->length());
+  index->mapped_file_ = std::move(mapped_file);
+  if (!index->Initialize(data)) {
+    LOG(ERROR) << "Invalid HTTPS Everywhere rule index " << path.value();
+    return nullptr;
+  }
+  return index;
+}
+
+// static
+scoped_refptr<HTTPSEverywhereRuleIndex>
+HTTPSEverywhereRuleIndex::CreateFromData(std::string data) {
+  scoped_refptr<HTTPSEverywhereRuleIndex> index(new HTTPSEverywhereRuleIndex);
+  index->owned_data_ = std::move(data);
+  if (!index->Initialize(index->owned_data_))
+    return nullptr;
+  return index;
+}
+
+// static
+std::string HTTPSEverywhereRuleIndex::Serialize(
+    const std::map<std::string, HTTPSERulesets>& rulesets) {
+  const uint32_t bucket_count =
+      static_cast<uint32_t>(std::max<size_t>(rulesets.size(), 1));
+  // (bucket, key, rulesets), ordered so each bucket's entries are adjacent.
+  std::vector<std::tuple<uint32_t, const std::string*, const HTTPSERulesets*>>
+      entries;
+  for (const auto& it : rulesets) {
+    entries.emplace_back(base::PersistentHash(it.first) % bucket_count,
+                         &it.first, &it.second);
+  }
+  // Stable so that entries within a bucket keep the map's key order and the
+  // output is deterministic.
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const auto& a, const auto& b) {
+                     return std::get<0>(a) < std::get<0>(b);
+                   });
+
+  std::string out;
+  out.append(kMagic, kMagicSize);
+  AppendU32(&out, kVersion);
+  AppendU32(&out, bucket_count);
+  AppendU32(&out, entries.size());
+
+  size_t entry = 0;
+  for (uint32_t bucket = 0; bucket <= bucket_count; ++bucket) {
+    while (entry < entries.size() && std::get<0>(entries[entry]) < bucket)
+      ++entry;
+    AppendU32(&out, entry);
+  }
+
+  const size_t data_offset = out.size() + entries.size() * kEntrySize;
+  std::string data;
+  for (const auto& it : entries) {
+    const std::string& key = *std::get<1>(it);
+    AppendU32(&out, base::PersistentHash(key));
+    AppendU32(&out, data_offset + data.size());
+    AppendU32(&out, key.size());
+    data.append(key);
+    AppendU32(&out, data_offset + data.size());
+    AppendRulesets(&data, *std::get<2>(it));
+  }
+  DCHECK_EQ(data_offset, out.size());
+  out.append(data);
+  return out;
+}
+
+bool HTTPSEverywhereRuleIndex::Initialize(base::StringPiece data) {
+  base::BigEndianReader reader(data.data(), data.size());
+  base::StringPiece magic;
+  uint32_t version;
+  if (!reader.ReadPiece(&magic, kMagicSize) || magic != kMagic ||
+      !reader.ReadU32(&version) || version != kVersion ||
+      !reader.ReadU32(&bucket_count_) || !reader.ReadU32(&entry_count_) ||
+      bucket_count_ == 0) {
+    return false;
+  }
+  const uint64_t tables_size =
+      kHeaderSize + (static_cast<uint64_t>(bucket_count_) + 1) *
+                        sizeof(uint32_t) +
+      static_cast<uint64_t>(entry_count_) * kEntrySize;
+  if (tables_size > data.size())
+    return false;
+  data_ = data;
+  return true;
+}
+
+bool HTTPSEverywhereRuleIndex::Find(const std::string& key,
+                                    base::StringPiece* rulesets) const {
+  const uint32_t hash = base::PersistentHash(key);
+  const size_t bucket_offset =
+      kHeaderSize + (hash % bucket_count_) * sizeof(uint32_t);
+  uint32_t begin;
+  uint32_t end;
+  if (!ReadU32At(data_, bucket_offset, &begin) ||
+      !ReadU32At(data_, bucket_offset + sizeof(uint32_t), &end) ||
+      end > entry_count_) {
+    return false;
+  }
+
+  const size_t entries_offset =
+      kHeaderSize + (static_cast<size_t>(bucket_count_) + 1) * sizeof(uint32_t);
+  for (uint32_t i = begin; i < end; ++i) {
+    const size_t entry_offset = entries_offset + i * kEntrySize;
+    uint32_t entry_hash;
+    uint32_t key_offset;
+    uint32_t key_length;
+    uint32_t rulesets_offset;
+    if (!ReadU32At(data_, entry_offset, &entry_hash) ||
+        !ReadU32At(data_, entry_offset + 4, &key_offset) ||
+        !ReadU32At(data_, entry_offset + 8, &key_length) ||
+        !ReadU32At(data_, entry_offset + 12, &rulesets_offset)) {
+      return false;
+    }
+    if (entry_hash != hash || key_offset > data_.size() ||
+        data_.substr(key_offset, key_length) != key) {
+      continue;
+    }
+    if (rulesets_offset > data_.size())
+      return false;
+    *rulesets = data_.substr(rulesets_offset);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,148 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULE_INDEX_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULE_INDEX_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+class FilePath;
+class MemoryMappedFile;
+}
+
+namespace brave_shields {
+
+// A single HTTPS Everywhere rewrite. Default rules just swap http for https.
+struct HTTPSERule {
+  bool is_default = false;
+  std::string from;
+  std::string to;
+};
+
+// A ruleset as stored for one lookup key: exclusion patterns that veto a
+// rewrite and the rules tried in order.
+struct HTTPSERuleset {
+  HTTPSERuleset();
+  HTTPSERuleset(const HTTPSERuleset& other);
+  ~HTTPSERuleset();
+
+  std::vector<std::string> exclusions;
+  std::vector<HTTPSERule> rules;
+};
+
+using HTTPSERulesets = std::vector<HTTPSERuleset>;
+
+// Parses the JSON value format used by the leveldb store, e.g.
+// [{"e":[{"p":"..."}],"r":[{"f":"...","t":"..."},{"d":1}]}]. Rulesets after
+// one without rules are dropped since evaluation never reaches them.
+HTTPSERulesets ParseHTTPSERulesets(const std::string& json);
+
+// Returns the rewritten |url|, or an empty string if no rule applies.
+std::string ApplyHTTPSERulesets(const std::string& url,
+                                const HTTPSERulesets& rulesets);
+
+// Rewrites "$1"-style backreferences in a rule into RE2's "\1" form.
+std::string CorrectRuleForRE2(base::StringPiece rule);
+
+// HTTPSERulesets with every pattern compiled up front, so that repeated
+// lookups against the same rulesets don't recompile them. A ruleset's
+// exclusions are combined into one RE2::Set and checked in a single pass.
+// Immutable and safe to share across threads.
+class CompiledHTTPSERulesets {
+ public:
+  explicit CompiledHTTPSERulesets(const HTTPSERulesets& rulesets);
+  ~CompiledHTTPSERulesets();
+
+  // Compiles rulesets in the encoded form returned by
+  // HTTPSEverywhereRuleIndex::Find(), reading the patterns in place instead
+  // of decoding them into HTTPSERulesets first. Returns null if |encoded| is
+  // malformed.
+  static std::unique_ptr<CompiledHTTPSERulesets> CreateFromEncoded(
+      base::StringPiece encoded);
+
+  bool empty() const { return rulesets_.empty(); }
+
+  // Same result as ApplyHTTPSERulesets() on the source rulesets.
+  std::string Apply(const std::string& url) const;
+
+ private:
+  struct Ruleset;
+  class Builder;
+
+  CompiledHTTPSERulesets();
+
+  std::vector<std::unique_ptr<Ruleset>> rulesets_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompiledHTTPSERulesets);
+};
+
+// An immutable index of HTTPS Everywhere rulesets keyed by the reversed host
+// patterns used for lookups ("com.example", "com.example.*"). The index is a
+// single file produced when the component is packaged, so it is used straight
+// from a read-only mapping: no unzip step and no database on the request
+// path. Lookups are thread-safe.
+//
+// Layout, all integers big-endian uint32 unless noted:
+//   header:  "HTSE", version, bucket count, entry count
+//   buckets: bucket count + 1 entry indices; bucket i holds entries
+//            [buckets[i], buckets[i + 1])
+//   entries: key hash, key offset, key length, ruleset offset
+//   data:    keys and rulesets. A ruleset list is a count followed by, for
+//            each ruleset, an exclusion count and strings, then a rule count
+//            and rules. A rule is a uint8 default flag and, if not default,
+//            from and to strings. Strings are a length followed by bytes.
+// Offsets are from the start of the file. Keys are hashed with
+// base::PersistentHash.
+class HTTPSEverywhereRuleIndex
+    : public base::RefCountedThreadSafe<HTTPSEverywhereRuleIndex> {
+ public:
+  static constexpr uint32_t kVersion = 1;
+
+  // Returns null if the file can't be mapped or is not a valid index.
+  static scoped_refptr<HTTPSEverywhereRuleIndex> CreateFromFile(
+      const base::FilePath& path);
+  static scoped_refptr<HTTPSEverywhereRuleIndex> CreateFromData(
+      std::string data);
+
+  // Serializes |rulesets| into the index format. Used by the component
+  // packaging step and tests.
+  static std::string Serialize(
+      const std::map<std::string, HTTPSERulesets>& rulesets);
+
+  // Returns true and points |rulesets| at the encoded rulesets stored under
+  // |key| if it is in the index. The view is only valid while the index is;
+  // compile it with CompiledHTTPSERulesets::CreateFromEncoded().
+  bool Find(const std::string& key, base::StringPiece* rulesets) const;
+
+ private:
+  friend class base::RefCountedThreadSafe<HTTPSEverywhereRuleIndex>;
+
+  HTTPSEverywhereRuleIndex();
+  ~HTTPSEverywhereRuleIndex();
+
+  bool Initialize(base::StringPiece data);
+
+  std::unique_ptr<base::MemoryMappedFile> mapped_file_;
+  std::string owned_data_;
+  base::StringPiece data_;
+  uint32_t bucket_count_ = 0;
+  uint32_t entry_count_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSEverywhereRuleIndex);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULE_INDEX_H_
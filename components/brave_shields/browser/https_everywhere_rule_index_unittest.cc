@@ -0,0 +1,141 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "brave/components/brave_shields/browser/https_everywhere_rule_index.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using brave_shields::ApplyHTTPSERulesets;
+using brave_shields::CompiledHTTPSERulesets;
+using brave_shields::HTTPSERulesets;
+using brave_shields::HTTPSEverywhereRuleIndex;
+using brave_shields::ParseHTTPSERulesets;
+
+namespace {
+
+const char kExampleRules[] =
+    R"([{"e":[{"p":"^http://www\\.example\\.com/plain/.*"}],)"
+    R"("r":[{"f":"^http://www\\.example\\.com/",)"
+    R"("t":"https://example.com/"}]}])";
+const char kDefaultRules[] = R"([{"r":[{"d":1}]}])";
+
+std::map<std::string, HTTPSERulesets> GetTestRulesets() {
+  return {
+      {"com.example.*", ParseHTTPSERulesets(kExampleRules)},
+      {"org.default", ParseHTTPSERulesets(kDefaultRules)},
+  };
+}
+
+}  // namespace
+
+TEST(HTTPSEverywhereRuleIndexTest, ParseAndApply) {
+  HTTPSERulesets rulesets = ParseHTTPSERulesets(kExampleRules);
+  ASSERT_EQ(1u, rulesets.size());
+  EXPECT_EQ(1u, rulesets[0].exclusions.size());
+  ASSERT_EQ(1u, rulesets[0].rules.size());
+  EXPECT_FALSE(rulesets[0].rules[0].is_default);
+
+  EXPECT_EQ("https://example.com/a.js",
+            ApplyHTTPSERulesets("http://www.example.com/a.js", rulesets));
+  EXPECT_EQ("",
+            ApplyHTTPSERulesets("http://www.example.com/plain/a", rulesets));
+  EXPECT_EQ("https://default.org/",
+            ApplyHTTPSERulesets("http://default.org/",
+                                ParseHTTPSERulesets(kDefaultRules)));
+  EXPECT_TRUE(ParseHTTPSERulesets("not json").empty());
+}
+
+TEST(HTTPSEverywhereRuleIndexTest, FindMatchesSource) {
+  auto source = GetTestRulesets();
+  scoped_refptr<HTTPSEverywhereRuleIndex> index =
+      HTTPSEverywhereRuleIndex::CreateFromData(
+          HTTPSEverywhereRuleIndex::Serialize(source));
+  ASSERT_TRUE(index);
+
+  base::StringPiece encoded_rulesets;
+  ASSERT_TRUE(index->Find("com.example.*", &encoded_rulesets));
+  std::unique_ptr<CompiledHTTPSERulesets> compiled =
+      CompiledHTTPSERulesets::CreateFromEncoded(encoded_rulesets);
+  ASSERT_TRUE(compiled);
+  for (const char* url : {"http://www.example.com/a.js",
+                          "http://www.example.com/plain/a",
+                          "http://example.com/"}) {
+    EXPECT_EQ(ApplyHTTPSERulesets(url, source["com.example.*"]),
+              compiled->Apply(url))
+        << url;
+  }
+  EXPECT_EQ("https://example.com/a.js",
+            compiled->Apply("http://www.example.com/a.js"));
+
+  ASSERT_TRUE(index->Find("org.default", &encoded_rulesets));
+  compiled = CompiledHTTPSERulesets::CreateFromEncoded(encoded_rulesets);
+  ASSERT_TRUE(compiled);
+  EXPECT_EQ("https://default.org/", compiled->Apply("http://default.org/"));
+
+  EXPECT_FALSE(index->Find("com.example", &encoded_rulesets));
+  EXPECT_FALSE(index->Find("org.default.*", &encoded_rulesets));
+}
+
+TEST(HTTPSEverywhereRuleIndexTest, ManyKeys) {
+  std::map<std::string, HTTPSERulesets> source;
+  for (int i = 0; i < 1000; ++i)
+    source["com.host" + base::NumberToString(i)] =
+        ParseHTTPSERulesets(kDefaultRules);
+  scoped_refptr<HTTPSEverywhereRuleIndex> index =
+      HTTPSEverywhereRuleIndex::CreateFromData(
+          HTTPSEverywhereRuleIndex::Serialize(source));
+  ASSERT_TRUE(index);
+
+  base::StringPiece encoded_rulesets;
+  for (const auto& it : source)
+    EXPECT_TRUE(index->Find(it.first, &encoded_rulesets)) << it.first;
+  EXPECT_FALSE(index->Find("com.host1000", &encoded_rulesets));
+}
+
+TEST(HTTPSEverywhereRuleIndexTest, RejectsInvalidData) {
+  const std::string data =
+      HTTPSEverywhereRuleIndex::Serialize(GetTestRulesets());
+  EXPECT_FALSE(HTTPSEverywhereRuleIndex::CreateFromData(""));
+  EXPECT_FALSE(
+      HTTPSEverywhereRuleIndex::CreateFromData("XXXX" + data.substr(4)));
+  EXPECT_FALSE(HTTPSEverywhereRuleIndex::CreateFromData(data.substr(0, 20)));
+
+  // A truncated data section fails to compile rather than reading past the
+  // end.
+  scoped_refptr<HTTPSEverywhereRuleIndex> index =
+      HTTPSEverywhereRuleIndex::CreateFromData(
+          data.substr(0, data.size() - 8));
+  ASSERT_TRUE(index);
+  bool compiled_all = true;
+  for (const char* key : {"org.default", "com.example.*"}) {
+    base::StringPiece encoded_rulesets;
+    compiled_all = compiled_all && index->Find(key, &encoded_rulesets) &&
+                   CompiledHTTPSERulesets::CreateFromEncoded(encoded_rulesets);
+  }
+  EXPECT_FALSE(compiled_all);
+}
+
+TEST(HTTPSEverywhereRuleIndexTest, CompiledRulesetsMatchApply) {
+  const HTTPSERulesets rulesets = ParseHTTPSERulesets(
+      R"([{"e":[{"p":"^http://a\\.com/skip/.*"},{"p":"(invalid"}],)"
+      R"("r":[{"f":"^http://a\\.com/(\\w+)\\.js","t":"https://a.com/$1.js"}]},)"
+      R"({"e":[{"p":"^http://a\\.com/other/.*"}],"r":[{"d":1}]}])");
+  const CompiledHTTPSERulesets compiled(rulesets);
+
+  const char* urls[] = {
+      "http://a.com/lib.js",   "http://a.com/skip/lib.js",
+      "http://a.com/page",     "http://a.com/other/page",
+      "http://b.com/lib.js",
+  };
+  for (const char* url : urls)
+    EXPECT_EQ(ApplyHTTPSERulesets(url, rulesets), compiled.Apply(url)) << url;
+  EXPECT_EQ("https://a.com/lib.js", compiled.Apply("http://a.com/lib.js"));
+  EXPECT_EQ("", compiled.Apply("http://a.com/other/page"));
+}
@@ -12,21 +12,23 @@
 
 #include "base/base_paths.h"
 #include "base/bind.h"
-#include "base/json/json_reader.h"
+#include "base/files/file_util.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/scoped_blocking_call.h"
-#include "base/values.h"
 #include "third_party/leveldatabase/src/include/leveldb/db.h"
-#include "third_party/re2/src/re2/re2.h"
 #include "third_party/zlib/google/zip.h"
 
 #define DAT_FILE "httpse.leveldb.zip"
+#define RULE_INDEX_FILE "httpse.index"
 #define DAT_FILE_VERSION "6.0"
 #define HTTPSE_URLS_REDIRECTS_COUNT_QUEUE   1
 #define HTTPSE_URL_MAX_REDIRECTS_COUNT      5
+#define HTTPSE_RECENTLY_USED_CACHE_SIZE     4096
+#define HTTPSE_COMPILED_RULESETS_CACHE_SIZE 1024
+#define HTTPSE_MISSING_RULESETS_CACHE_SIZE  256
 
 namespace {
 
@@ -97,10 +99,20 @@ std::string
 HTTPSEverywhereService::g_https_everywhere_component_base64_public_key_(
     kHTTPSEverywhereComponentBase64PublicKey);
 
+HTTPSEverywhereService::CompiledRulesetsCache::CompiledRulesetsCache()
+    : rulesets(HTTPSE_COMPILED_RULESETS_CACHE_SIZE),
+      missing_keys(HTTPSE_MISSING_RULESETS_CACHE_SIZE) {}
+
+HTTPSEverywhereService::CompiledRulesetsCache::~CompiledRulesetsCache() =
+    default;
+
 HTTPSEverywhereService::HTTPSEverywhereService(
     BraveComponent::Delegate* delegate)
     : BaseBraveShieldsService(delegate),
-      level_db_(nullptr) {
+      recently_used_cache_(HTTPSE_RECENTLY_USED_CACHE_SIZE),
+      level_db_(nullptr),
+      compiled_rulesets_cache_(
+          base::MakeRefCounted<CompiledRulesetsCache>()) {
   DETACH_FROM_SEQUENCE(sequence_checker_);
 }
 
@@ -117,6 +129,22 @@ bool HTTPSEverywhereService::Init() {
 
 void HTTPSEverywhereService::InitDB(const base::FilePath& install_dir) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  // Prefer the precompiled index, which is mapped as is. Older components
+  // only ship the zipped leveldb store.
+  base::FilePath rule_index_path =
+      install_dir.AppendASCII(DAT_FILE_VERSION).AppendASCII(RULE_INDEX_FILE);
+  if (base::PathExists(rule_index_path)) {
+    scoped_refptr<const HTTPSEverywhereRuleIndex> rule_index =
+        HTTPSEverywhereRuleIndex::CreateFromFile(rule_index_path);
+    if (rule_index) {
+      CloseDatabase();
+      base::AutoLock auto_lock(rule_index_lock_);
+      rule_index_ = std::move(rule_index);
+      compiled_rulesets_cache_ = base::MakeRefCounted<CompiledRulesetsCache>();
+      return;
+    }
+  }
+
   base::FilePath zip_db_file_path =
       install_dir.AppendASCII(DAT_FILE_VERSION).AppendASCII(DAT_FILE);
   base::FilePath unzipped_level_db_path = zip_db_file_path.RemoveExtension();
@@ -128,6 +156,13 @@ void HTTPSEverywhereService::InitDB(const base::FilePath& install_dir) {
   }
 
   CloseDatabase();
+  {
+    // Rules from an earlier component that shipped an index must not
+    // outlive the update.
+    base::AutoLock auto_lock(rule_index_lock_);
+    rule_index_ = nullptr;
+    compiled_rulesets_cache_ = base::MakeRefCounted<CompiledRulesetsCache>();
+  }
 
   leveldb::Options options;
   leveldb::Status status =
@@ -163,9 +198,57 @@ bool HTTPSEverywhereService::GetHTTPSURL(
   if (!url->is_valid())
     return false;
 
-  if (!IsInitialized() || !level_db_ || url->scheme() == url::kHttpsScheme) {
+  scoped_refptr<CompiledRulesetsCache> compiled_rulesets_cache;
+  scoped_refptr<const HTTPSEverywhereRuleIndex> rule_index =
+      GetRules(&compiled_rulesets_cache);
+  if (!IsInitialized() || (!level_db_ && !rule_index) ||
+      url->scheme() == url::kHttpsScheme) {
     return false;
   }
+  return FindHTTPSURL(url, request_identifier, rule_index.get(),
+                      compiled_rulesets_cache.get(), new_url);
+}
+
+bool HTTPSEverywhereService::HasRuleIndex() {
+  return !!GetRuleIndex();
+}
+
+bool HTTPSEverywhereService::GetHTTPSURLFromIndex(
+    const GURL* url,
+    const uint64_t& request_identifier,
+    std::string* new_url) {
+  if (!url->is_valid())
+    return false;
+
+  scoped_refptr<CompiledRulesetsCache> compiled_rulesets_cache;
+  scoped_refptr<const HTTPSEverywhereRuleIndex> rule_index =
+      GetRules(&compiled_rulesets_cache);
+  if (!IsInitialized() || !rule_index || url->scheme() == url::kHttpsScheme) {
+    return false;
+  }
+  return FindHTTPSURL(url, request_identifier, rule_index.get(),
+                      compiled_rulesets_cache.get(), new_url);
+}
+
+scoped_refptr<const HTTPSEverywhereRuleIndex>
+HTTPSEverywhereService::GetRuleIndex() {
+  base::AutoLock auto_lock(rule_index_lock_);
+  return rule_index_;
+}
+
+scoped_refptr<const HTTPSEverywhereRuleIndex> HTTPSEverywhereService::GetRules(
+    scoped_refptr<CompiledRulesetsCache>* compiled_rulesets_cache) {
+  base::AutoLock auto_lock(rule_index_lock_);
+  *compiled_rulesets_cache = compiled_rulesets_cache_;
+  return rule_index_;
+}
+
+bool HTTPSEverywhereService::FindHTTPSURL(
+    const GURL* url,
+    const uint64_t& request_identifier,
+    const HTTPSEverywhereRuleIndex* rule_index,
+    CompiledRulesetsCache* compiled_rulesets_cache,
+    std::string* new_url) {
   if (!ShouldHTTPSERedirect(request_identifier)) {
     return false;
   }
@@ -184,15 +267,16 @@ bool HTTPSEverywhereService::GetHTTPSURL(
 
   const std::vector<std::string> domains =
       ExpandDomainForLookup(candidate_url.host());
-  for (auto domain : domains) {
-    std::string value = leveldbGet(level_db_, domain);
-    if (!value.empty()) {
-      *new_url = ApplyHTTPSRule(candidate_url.spec(), value);
-      if (0 != new_url->length()) {
-        recently_used_cache_.add(candidate_url.spec(), *new_url);
-        AddHTTPSEUrlToRedirectList(request_identifier);
-        return true;
-      }
+  for (const auto& domain : domains) {
+    std::shared_ptr<const CompiledHTTPSERulesets> rulesets =
+        GetCompiledRulesets(domain, rule_index, compiled_rulesets_cache);
+    if (!rulesets)
+      continue;
+    *new_url = rulesets->Apply(candidate_url.spec());
+    if (0 != new_url->length()) {
+      recently_used_cache_.add(candidate_url.spec(), *new_url);
+      AddHTTPSEUrlToRedirectList(request_identifier);
+      return true;
     }
   }
   recently_used_cache_.remove(candidate_url.spec());
@@ -220,6 +304,42 @@ bool HTTPSEverywhereService::GetHTTPSURLFromCacheOnly(
   return false;
 }
 
+std::shared_ptr<const CompiledHTTPSERulesets>
+HTTPSEverywhereService::GetCompiledRulesets(
+    const std::string& key,
+    const HTTPSEverywhereRuleIndex* rule_index,
+    CompiledRulesetsCache* compiled_rulesets_cache) {
+  std::shared_ptr<const CompiledHTTPSERulesets> compiled;
+  if (compiled_rulesets_cache->rulesets.get(key, &compiled))
+    return compiled;
+  bool missing;
+  if (compiled_rulesets_cache->missing_keys.get(key, &missing))
+    return nullptr;
+
+  if (rule_index) {
+    // Compiled straight from the mapped index, without decoding a copy.
+    base::StringPiece encoded_rulesets;
+    if (rule_index->Find(key, &encoded_rulesets)) {
+      compiled =
+          CompiledHTTPSERulesets::CreateFromEncoded(encoded_rulesets);
+    }
+  } else {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    std::string value = leveldbGet(level_db_, key);
+    HTTPSERulesets rulesets;
+    if (!value.empty())
+      rulesets = ParseHTTPSERulesets(value);
+    if (!rulesets.empty())
+      compiled = std::make_shared<CompiledHTTPSERulesets>(rulesets);
+  }
+  if (!compiled || compiled->empty()) {
+    compiled_rulesets_cache->missing_keys.add(key, true);
+    return nullptr;
+  }
+  compiled_rulesets_cache->rulesets.add(key, compiled);
+  return compiled;
+}
+
 bool HTTPSEverywhereService::ShouldHTTPSERedirect(
     const uint64_t& request_identifier) {
   base::AutoLock auto_lock(httpse_get_urls_redirects_count_mutex_);
@@ -265,113 +385,12 @@ void HTTPSEverywhereService::AddHTTPSEUrlToRedirectList(
 std::string HTTPSEverywhereService::ApplyHTTPSRule(
     const std::string& originalUrl,
     const std::string& rule) {
-  base::Optional<base::Value> json_object = base::JSONReader::Read(rule);
-  if (base::nullopt == json_object || !json_object->is_list()) {
-    return "";
-  }
-
-  base::Value::ConstListView topValues = json_object->GetList();
-  for (auto it = topValues.cbegin(); it != topValues.cend(); ++it) {
-    if (!it->is_dict()) {
-      continue;
-    }
-    const base::DictionaryValue* childTopDictionary = nullptr;
-    it->GetAsDictionary(&childTopDictionary);
-    if (nullptr == childTopDictionary) {
-      continue;
-    }
-
-    const base::Value* exclusion = nullptr;
-    if (childTopDictionary->Get("e", &exclusion)) {
-      const base::ListValue* eValues = nullptr;
-      exclusion->GetAsList(&eValues);
-      if (nullptr != eValues) {
-        for (size_t j = 0; j < eValues->GetSize(); ++j) {
-          const base::Value* pValue = nullptr;
-          if (!eValues->Get(j, &pValue)) {
-            continue;
-          }
-          const base::DictionaryValue* pDictionary = nullptr;
-          pValue->GetAsDictionary(&pDictionary);
-          if (nullptr == pDictionary) {
-            continue;
-          }
-          const base::Value* patternValue = nullptr;
-          if (!pDictionary->Get("p", &patternValue)) {
-            continue;
-          }
-          std::string pattern;
-          if (!patternValue->GetAsString(&pattern)) {
-            continue;
-          }
-          pattern = CorrecttoRuleToRE2Engine(pattern);
-          if (RE2::FullMatch(originalUrl, pattern)) {
-            return "";
-          }
-        }
-      }
-    }
-
-    const base::Value* rules = nullptr;
-    if (!childTopDictionary->Get("r", &rules)) {
-      return "";
-    }
-    const base::ListValue* rValues = nullptr;
-    rules->GetAsList(&rValues);
-    if (nullptr == rValues) {
-      return "";
-    }
-
-    for (size_t j = 0; j < rValues->GetSize(); ++j) {
-      const base::Value* pValue = nullptr;
-      if (!rValues->Get(j, &pValue)) {
-        continue;
-      }
-      const base::DictionaryValue* pDictionary = nullptr;
-      pValue->GetAsDictionary(&pDictionary);
-      if (nullptr == pDictionary) {
-        continue;
-      }
-      const base::Value* patternValue = nullptr;
-      if (pDictionary->Get("d", &patternValue)) {
-        std::string newUrl(originalUrl);
-        return newUrl.insert(4, "s");
-      }
-
-      const base::Value* from_value = nullptr;
-      const base::Value* to_value = nullptr;
-      if (!pDictionary->Get("f", &from_value) ||
-          !pDictionary->Get("t", &to_value)) {
-        continue;
-      }
-      std::string from, to;
-      if (!from_value->GetAsString(&from) ||
-          !to_value->GetAsString(&to)) {
-        continue;
-      }
-
-      to = CorrecttoRuleToRE2Engine(to);
-      std::string newUrl(originalUrl);
-      RE2 regExp(from);
-
-      if (RE2::Replace(&newUrl, regExp, to) && newUrl != originalUrl) {
-        return newUrl;
-      }
-    }
-  }
-  return "";
+  return ApplyHTTPSERulesets(originalUrl, ParseHTTPSERulesets(rule));
 }
 
 std::string HTTPSEverywhereService::CorrecttoRuleToRE2Engine(
     const std::string& to) {
-  std::string correctedto(to);
-  size_t pos = to.find("$");
-  while (std::string::npos != pos) {
-    correctedto[pos] = '\\';
-    pos = correctedto.find("$");
-  }
-
-  return correctedto;
+  return CorrectRuleForRE2(to);
 }
 
 void HTTPSEverywhereService::CloseDatabase() {
@@ -11,11 +11,13 @@
 #include <vector>
 
 #include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
 #include "base/synchronization/lock.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
 #include "brave/components/brave_shields/browser/https_everywhere_recently_used_cache.h"
+#include "brave/components/brave_shields/browser/https_everywhere_rule_index.h"
 
 namespace leveldb {
 class DB;
@@ -54,6 +56,12 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
   bool GetHTTPSURLFromCacheOnly(const GURL* url,
                                 const uint64_t& request_id,
                                 std::string* cached_url);
+  // Whether the precompiled rule index is loaded. When it is, lookups can be
+  // answered with GetHTTPSURLFromIndex() on any thread.
+  bool HasRuleIndex();
+  bool GetHTTPSURLFromIndex(const GURL* url,
+                            const uint64_t& request_id,
+                            std::string* new_url);
 
  protected:
   bool Init() override;
@@ -79,12 +87,52 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
 
   void CloseDatabase();
 
+  // The rulesets compiled from one version of the rules. Replaced together
+  // with the rules when the component updates, so that lookups still running
+  // against the old rules can't fill the new cache with stale rulesets.
+  struct CompiledRulesetsCache
+      : public base::RefCountedThreadSafe<CompiledRulesetsCache> {
+    CompiledRulesetsCache();
+
+    HTTPSERecentlyUsedCache<std::shared_ptr<const CompiledHTTPSERulesets>>
+        rulesets;
+    // Lookup keys without rules. Most keys have none, so they are kept apart,
+    // in a smaller cache, rather than evicting compiled rulesets.
+    HTTPSERecentlyUsedCache<bool> missing_keys;
+
+   private:
+    friend class base::RefCountedThreadSafe<CompiledRulesetsCache>;
+    ~CompiledRulesetsCache();
+  };
+
   void InitDB(const base::FilePath& install_dir);
+  scoped_refptr<const HTTPSEverywhereRuleIndex> GetRuleIndex();
+  // Returns the rule index, or null when the rules are in the leveldb store,
+  // and sets |compiled_rulesets_cache| to the cache that goes with them.
+  scoped_refptr<const HTTPSEverywhereRuleIndex> GetRules(
+      scoped_refptr<CompiledRulesetsCache>* compiled_rulesets_cache);
+  // Looks |url| up in |rule_index|, or in the leveldb store when it's null.
+  bool FindHTTPSURL(const GURL* url,
+                    const uint64_t& request_id,
+                    const HTTPSEverywhereRuleIndex* rule_index,
+                    CompiledRulesetsCache* compiled_rulesets_cache,
+                    std::string* new_url);
+  // Returns the rulesets stored under lookup |key|, compiled, or null if there
+  // are none.
+  std::shared_ptr<const CompiledHTTPSERulesets> GetCompiledRulesets(
+      const std::string& key,
+      const HTTPSEverywhereRuleIndex* rule_index,
+      CompiledRulesetsCache* compiled_rulesets_cache);
 
   base::Lock httpse_get_urls_redirects_count_mutex_;
   std::vector<HTTPSE_REDIRECTS_COUNT_ST> httpse_urls_redirects_count_;
   HTTPSERecentlyUsedCache<std::string> recently_used_cache_;
   leveldb::DB* level_db_;
+  // Guards |rule_index_| and |compiled_rulesets_cache_|, which are replaced
+  // together.
+  base::Lock rule_index_lock_;
+  scoped_refptr<const HTTPSEverywhereRuleIndex> rule_index_;
+  scoped_refptr<CompiledRulesetsCache> compiled_rulesets_cache_;
 
   SEQUENCE_CHECKER(sequence_checker_);
   DISALLOW_COPY_AND_ASSIGN(HTTPSEverywhereService);
@@ -0,0 +1,161 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/query_filter_service.h"
+
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/json/json_reader.h"
+#include "base/logging.h"
+#include "base/no_destructor.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/task_runner_util.h"
+#include "base/values.h"
+#include "brave/components/brave_component_updater/browser/dat_file_util.h"
+#include "brave/components/brave_component_updater/browser/local_data_files_service.h"
+
+namespace brave_shields {
+
+const char kQueryFilterConfigFile[] = "QueryFilter.json";
+const char kQueryFilterConfigFileVersion[] = "1";
+
+namespace {
+
+bool IsValidTracker(const std::string& name) {
+  return !name.empty() && base::IsStringASCII(name) &&
+         name.find_first_of("&=#") == std::string::npos;
+}
+
+// Whether |pair| is "tracker=value" with a non-empty value.
+bool IsTrackerPair(base::StringPiece pair, const QueryTrackers& trackers) {
+  const size_t equals = pair.find('=');
+  if (equals == base::StringPiece::npos || equals + 1 == pair.size())
+    return false;
+  return trackers.count(base::ToLowerASCII(pair.substr(0, equals))) > 0;
+}
+
+}  // namespace
+
+QueryFilterService::QueryFilterService(
+    LocalDataFilesService* local_data_files_service)
+    : LocalDataFilesObserver(local_data_files_service),
+      trackers_(base::MakeRefCounted<SharedQueryTrackers>(
+          GetDefaultTrackers())) {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+QueryFilterService::~QueryFilterService() = default;
+
+// static
+const QueryTrackers& QueryFilterService::GetDefaultTrackers() {
+  static const base::NoDestructor<QueryTrackers> trackers(QueryTrackers(
+      {// https://github.com/brave/brave-browser/issues/4239
+       "fbclid", "gclid", "msclkid", "mc_eid",
+       // https://github.com/brave/brave-browser/issues/9879
+       "dclid",
+       // https://github.com/brave/brave-browser/issues/11579
+       "_openstat",
+       // https://github.com/brave/brave-browser/issues/11817
+       "vero_conv", "vero_id",
+       // https://github.com/brave/brave-browser/issues/11578
+       "yclid",
+       // https://github.com/brave/brave-browser/issues/9019
+       "_hsenc", "__hssc", "__hstc", "__hsfp", "hsctatracking"}));
+  return *trackers;
+}
+
+// static
+base::Optional<QueryTrackers> QueryFilterService::ParseTrackers(
+    const std::string& json) {
+  base::Optional<base::Value> root = base::JSONReader::Read(json);
+  if (!root || !root->is_list())
+    return base::nullopt;
+
+  std::vector<std::string> trackers;
+  for (const auto& value : root->GetList()) {
+    if (!value.is_string() || !IsValidTracker(value.GetString()))
+      return base::nullopt;
+    trackers.push_back(base::ToLowerASCII(value.GetString()));
+  }
+  return QueryTrackers(std::move(trackers));
+}
+
+// static
+base::Optional<std::string> QueryFilterService::FilterQuery(
+    base::StringPiece query,
+    const QueryTrackers& trackers) {
+  if (query.empty())
+    return base::nullopt;
+  std::vector<base::StringPiece> pairs = base::SplitStringPiece(
+      query, "&", base::KEEP_WHITESPACE, base::SPLIT_WANT_ALL);
+
+  // Every pair after the first is dropped with the "&" before it.
+  std::vector<base::StringPiece> kept;
+  kept.reserve(pairs.size());
+  kept.push_back(pairs[0]);
+  for (size_t i = 1; i < pairs.size(); ++i) {
+    if (!IsTrackerPair(pairs[i], trackers))
+      kept.push_back(pairs[i]);
+  }
+  // The first pair is dropped with the "&" after it, if any.
+  const bool drop_first = IsTrackerPair(kept[0], trackers);
+  if (!drop_first && kept.size() == pairs.size())
+    return base::nullopt;
+
+  if (drop_first)
+    kept.erase(kept.begin());
+  return base::JoinString(kept, "&");
+}
+
+scoped_refptr<const SharedQueryTrackers> QueryFilterService::trackers()
+    const {
+  base::AutoLock lock(lock_);
+  return trackers_;
+}
+
+void QueryFilterService::OnComponentReady(const std::string& component_id,
+                                          const base::FilePath& install_dir,
+                                          const std::string& manifest) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  base::FilePath dat_file_path =
+      install_dir.AppendASCII(kQueryFilterConfigFileVersion)
+          .AppendASCII(kQueryFilterConfigFile);
+  base::PostTaskAndReplyWithResult(
+      local_data_files_service()->GetTaskRunner().get(), FROM_HERE,
+      base::BindOnce(&brave_component_updater::GetDATFileAsString,
+                     dat_file_path),
+      base::BindOnce(&QueryFilterService::OnDATFileDataReady,
+                     weak_factory_.GetWeakPtr()));
+}
+
+void QueryFilterService::OnDATFileDataReady(const std::string& contents) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (contents.empty()) {
+    // Older components don't ship the list; keep the built-in one.
+    return;
+  }
+  base::Optional<QueryTrackers> trackers = ParseTrackers(contents);
+  if (!trackers) {
+    LOG(ERROR) << "Failed to parse query filter configuration";
+    return;
+  }
+  auto shared_trackers =
+      base::MakeRefCounted<SharedQueryTrackers>(std::move(*trackers));
+  base::AutoLock lock(lock_);
+  trackers_ = std::move(shared_trackers);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// The factory
+std::unique_ptr<QueryFilterService> QueryFilterServiceFactory(
+    LocalDataFilesService* local_data_files_service) {
+  return std::make_unique<QueryFilterService>(local_data_files_service);
+}
+
+}  // namespace brave_shields
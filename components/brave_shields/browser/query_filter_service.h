@@ -0,0 +1,85 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_QUERY_FILTER_SERVICE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_QUERY_FILTER_SERVICE_H_
+
+#include <memory>
+#include <string>
+
+#include "base/containers/flat_set.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/optional.h"
+#include "base/sequence_checker.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "brave/components/brave_component_updater/browser/local_data_files_observer.h"
+
+using brave_component_updater::LocalDataFilesObserver;
+using brave_component_updater::LocalDataFilesService;
+
+namespace brave_shields {
+
+extern const char kQueryFilterConfigFile[];
+extern const char kQueryFilterConfigFileVersion[];
+
+// Lowercased names of query string parameters used only for cross-site
+// tracking, e.g. "fbclid".
+using QueryTrackers = base::flat_set<std::string>;
+using SharedQueryTrackers = base::RefCountedData<QueryTrackers>;
+
+// Keeps the list of tracking query parameters stripped from cross-site
+// navigations. Starts with a built-in list, which is replaced by the list in
+// the local data files component once it is loaded, so new trackers can ship
+// without a browser update.
+class QueryFilterService : public LocalDataFilesObserver {
+ public:
+  explicit QueryFilterService(LocalDataFilesService* local_data_files_service);
+  ~QueryFilterService() override;
+
+  static const QueryTrackers& GetDefaultTrackers();
+
+  // Parses a component list, a JSON list of parameter names. Returns nullopt
+  // if the list is malformed.
+  static base::Optional<QueryTrackers> ParseTrackers(const std::string& json);
+
+  // Returns |query| with every "tracker=value" pair removed, or nullopt if
+  // nothing was removed. Pairs with an empty value are kept, names match
+  // case-insensitively, and separators are dropped together with the pairs
+  // they precede or follow. The query is tokenized once, so the cost doesn't
+  // grow with the number of trackers.
+  static base::Optional<std::string> FilterQuery(base::StringPiece query,
+                                                 const QueryTrackers& trackers);
+
+  // The current list. Safe to call from any sequence; the list that is
+  // returned doesn't change, a component update swaps in a new one.
+  scoped_refptr<const SharedQueryTrackers> trackers() const;
+
+  // implementation of LocalDataFilesObserver
+  void OnComponentReady(const std::string& component_id,
+                        const base::FilePath& install_dir,
+                        const std::string& manifest) override;
+
+ private:
+  void OnDATFileDataReady(const std::string& contents);
+
+  mutable base::Lock lock_;
+  scoped_refptr<const SharedQueryTrackers> trackers_ GUARDED_BY(lock_);
+
+  SEQUENCE_CHECKER(sequence_checker_);
+  base::WeakPtrFactory<QueryFilterService> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(QueryFilterService);
+};
+
+// Creates the QueryFilterService
+std::unique_ptr<QueryFilterService> QueryFilterServiceFactory(
+    LocalDataFilesService* local_data_files_service);
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_QUERY_FILTER_SERVICE_H_
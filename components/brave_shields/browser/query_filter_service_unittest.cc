@@ -0,0 +1,107 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <string>
+#include <vector>
+
+#include "base/optional.h"
+#include "base/strings/string_util.h"
+#include "brave/components/brave_shields/browser/query_filter_service.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/re2/src/re2/re2.h"
+
+using brave_shields::QueryFilterService;
+using brave_shields::QueryTrackers;
+
+namespace {
+
+// The regex based filter that QueryFilterService::FilterQuery replaced, kept
+// as the reference for its behaviour.
+base::Optional<std::string> RegexFilterQuery(const std::string& query,
+                                             const QueryTrackers& trackers) {
+  const std::string alternation = base::JoinString(
+      std::vector<std::string>(trackers.begin(), trackers.end()), "|");
+  re2::RE2::Options options;
+  options.set_case_sensitive(false);
+  const re2::RE2 tracker_only("^(" + alternation + ")=[^&]+$", options);
+  const re2::RE2 tracker_first("^(" + alternation + ")=[^&]+&", options);
+  const re2::RE2 tracker_appended("&(" + alternation + ")=[^&]+", options);
+
+  std::string new_query = query;
+  const int replacement_count =
+      re2::RE2::GlobalReplace(&new_query, tracker_appended, "") +
+      re2::RE2::GlobalReplace(&new_query, tracker_first, "") +
+      re2::RE2::GlobalReplace(&new_query, tracker_only, "");
+  if (replacement_count == 0)
+    return base::nullopt;
+  return new_query;
+}
+
+}  // namespace
+
+TEST(QueryFilterServiceTest, MatchesRegexFilter) {
+  const char* queries[] = {
+      "",
+      "+%20",
+      "foo=1",
+      "foo=1&bar=2",
+      "file=https%3A%2F%2Fexample.com%2Ftest.pdf",
+      "foo=1&&bar=2",
+      "foo&bar=&",
+      "foo=1&fbcid=no&gcid=no&mc_cid=no&bar=&",
+      "fbclid=&gclid&=mc_eid&msclkid=",
+      "value=fbclid=1&not-gclid=2&foo+mc_eid=3",
+      "+fbclid=1",
+      "%20fbclid=1",
+      "fbclid=1234",
+      "fbclid=1234&",
+      "&fbclid=1234",
+      "&&fbclid=1234&&",
+      "FBCLID=1&GClid=2",
+      "hsCtaTracking=1&HSCTATRACKING=2&foo=3",
+      "fbclid=0&gclid=1&msclkid=a&mc_eid=a1",
+      "fbclid=&foo=1&bar=2&gclid=abc",
+      "fbclid=&foo=1&gclid=1234&bar=2",
+      "foo=1&fbclid=abcd",
+      "fbclid&foo&&gclid=2&bar=&%20",
+      "fbclid=1&1==2&=msclkid&foo=bar&&a=b=c&",
+      "fbclid=1&=2&?foo=yes&bar=2+",
+      "fbclid=1&a+b+c=some%20thing&1%202=3+4",
+      "fbclid==&gclid=a=b",
+      "fbclid=1&fbclid=2&fbclid=3",
+      "fbclidx=1&xfbclid=2&_hsenc=3&__hssc=4",
+      "a=1&fbclid=1&b=2&gclid=2&c=3&yclid=3",
+  };
+  const QueryTrackers& trackers = QueryFilterService::GetDefaultTrackers();
+  for (const char* query : queries) {
+    EXPECT_EQ(RegexFilterQuery(query, trackers),
+              QueryFilterService::FilterQuery(query, trackers))
+        << query;
+  }
+}
+
+TEST(QueryFilterServiceTest, FilterQuery) {
+  const QueryTrackers& trackers = QueryFilterService::GetDefaultTrackers();
+  EXPECT_EQ(base::nullopt, QueryFilterService::FilterQuery("foo=1", trackers));
+  EXPECT_EQ("", QueryFilterService::FilterQuery("fbclid=1", trackers));
+  EXPECT_EQ("foo=1&bar=2",
+            QueryFilterService::FilterQuery("gclid=1&foo=1&mc_eid=2&bar=2",
+                                            trackers));
+}
+
+TEST(QueryFilterServiceTest, ParseTrackers) {
+  base::Optional<QueryTrackers> trackers =
+      QueryFilterService::ParseTrackers(R"(["fbclid", "New_Tracker"])");
+  ASSERT_TRUE(trackers);
+  EXPECT_EQ(QueryTrackers({"fbclid", "new_tracker"}), *trackers);
+  EXPECT_EQ("a=1",
+            QueryFilterService::FilterQuery("NEW_TRACKER=2&a=1", *trackers));
+
+  EXPECT_FALSE(QueryFilterService::ParseTrackers("not json"));
+  EXPECT_FALSE(QueryFilterService::ParseTrackers(R"({"fbclid": 1})"));
+  EXPECT_FALSE(QueryFilterService::ParseTrackers(R"(["fbclid", 1])"));
+  EXPECT_FALSE(QueryFilterService::ParseTrackers(R"(["a=b"])"));
+  EXPECT_FALSE(QueryFilterService::ParseTrackers(R"([""])"));
+}
@@ -0,0 +1,133 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/shields_settings_snapshot.h"
+
+#include <string>
+#include <utility>
+
+#include "base/memory/ptr_util.h"
+#include "base/supports_user_data.h"
+#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
+#include "chrome/browser/profiles/profile.h"
+#include "components/content_settings/core/browser/content_settings_observer.h"
+#include "components/content_settings/core/browser/host_content_settings_map.h"
+#include "content/public/browser/browser_context.h"
+#include "content/public/browser/browser_thread.h"
+
+namespace brave_shields {
+
+namespace {
+
+const void* const kShieldsSettingsCacheUserDataKey =
+    &kShieldsSettingsCacheUserDataKey;
+
+}  // namespace
+
+ShieldsSettingsSnapshot::ShieldsSettingsSnapshot(HostContentSettingsMap* map,
+                                                 const GURL& url)
+    : brave_shields_enabled(GetBraveShieldsEnabled(map, url)),
+      ad_control(GetAdControlType(map, url)),
+      https_everywhere_enabled(GetHTTPSEverywhereEnabled(map, url)),
+      allow_referrers(AllowReferrers(map, url)) {}
+
+ShieldsSettingsSnapshot::~ShieldsSettingsSnapshot() = default;
+
+// Ties the cache to its profile and drops its snapshots when shields settings
+// change. Lives on the UI thread, like the map's observers.
+class ShieldsSettingsCache::Holder : public base::SupportsUserData::Data,
+                                     public content_settings::Observer {
+ public:
+  explicit Holder(scoped_refptr<ShieldsSettingsCache> cache)
+      : cache_(std::move(cache)) {
+    cache_->map_->AddObserver(this);
+  }
+
+  ~Holder() override {
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    cache_->map_->RemoveObserver(this);
+  }
+
+  ShieldsSettingsCache* cache() const { return cache_.get(); }
+
+  // content_settings::Observer overrides:
+  void OnContentSettingChanged(
+      const ContentSettingsPattern& primary_pattern,
+      const ContentSettingsPattern& secondary_pattern,
+      ContentSettingsType content_type,
+      const std::string& resource_identifier) override {
+    if (content_type == ContentSettingsType::PLUGINS)
+      cache_->Invalidate();
+  }
+
+ private:
+  scoped_refptr<ShieldsSettingsCache> cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(Holder);
+};
+
+ShieldsSettingsCache::ShieldsSettingsCache(
+    scoped_refptr<HostContentSettingsMap> map)
+    : map_(std::move(map)), snapshots_(kMaxEntries) {}
+
+ShieldsSettingsCache::~ShieldsSettingsCache() = default;
+
+// static
+scoped_refptr<ShieldsSettingsCache> ShieldsSettingsCache::FromBrowserContext(
+    content::BrowserContext* context) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  auto* holder = static_cast<Holder*>(
+      context->GetUserData(kShieldsSettingsCacheUserDataKey));
+  if (!holder) {
+    holder = new Holder(base::WrapRefCounted(
+        new ShieldsSettingsCache(base::WrapRefCounted(
+            HostContentSettingsMapFactory::GetForProfile(
+                Profile::FromBrowserContext(context))))));
+    context->SetUserData(kShieldsSettingsCacheUserDataKey,
+                         base::WrapUnique(holder));
+  }
+  return holder->cache();
+}
+
+scoped_refptr<const ShieldsSettingsSnapshot> ShieldsSettingsCache::Get(
+    const GURL& first_party_url) {
+  url::Origin first_party_origin = url::Origin::Create(first_party_url);
+  // Opaque origins are unique, they would never be found again.
+  if (first_party_origin.opaque()) {
+    return base::MakeRefCounted<ShieldsSettingsSnapshot>(map_.get(),
+                                                         first_party_url);
+  }
+  return Get(first_party_origin);
+}
+
+scoped_refptr<const ShieldsSettingsSnapshot> ShieldsSettingsCache::Get(
+    const url::Origin& first_party_origin) {
+  DCHECK(!first_party_origin.opaque());
+  uint64_t generation;
+  {
+    base::AutoLock lock(lock_);
+    auto it = snapshots_.Get(first_party_origin);
+    if (it != snapshots_.end())
+      return it->second;
+    generation = generation_;
+  }
+
+  // The map takes its own locks, don't hold ours meanwhile.
+  auto snapshot = base::MakeRefCounted<ShieldsSettingsSnapshot>(
+      map_.get(), first_party_origin.GetURL());
+
+  base::AutoLock lock(lock_);
+  if (generation == generation_)
+    snapshots_.Put(first_party_origin, snapshot);
+  return snapshot;
+}
+
+void ShieldsSettingsCache::Invalidate() {
+  base::AutoLock lock(lock_);
+  ++generation_;
+  snapshots_.Clear();
+}
+
+}  // namespace brave_shields
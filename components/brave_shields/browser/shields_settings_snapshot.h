@@ -0,0 +1,93 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_SHIELDS_SETTINGS_SNAPSHOT_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_SHIELDS_SETTINGS_SNAPSHOT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "url/gurl.h"
+#include "url/origin.h"
+
+class HostContentSettingsMap;
+
+namespace content {
+class BrowserContext;
+}
+
+namespace brave_shields {
+
+// The shields settings of a first-party site that request handling reads,
+// read from the content settings map together. Immutable, so it can be shared
+// across sequences.
+struct ShieldsSettingsSnapshot
+    : public base::RefCountedThreadSafe<ShieldsSettingsSnapshot> {
+  ShieldsSettingsSnapshot(HostContentSettingsMap* map, const GURL& url);
+
+  const bool brave_shields_enabled;
+  const ControlType ad_control;
+  const bool https_everywhere_enabled;
+  const bool allow_referrers;
+
+ private:
+  friend class base::RefCountedThreadSafe<ShieldsSettingsSnapshot>;
+  ~ShieldsSettingsSnapshot();
+
+  DISALLOW_COPY_AND_ASSIGN(ShieldsSettingsSnapshot);
+};
+
+// Keeps a ShieldsSettingsSnapshot per first-party site of a profile, so that
+// requests read plain fields instead of walking the content settings rules
+// under their locks. All snapshots are dropped whenever a shields setting
+// changes. Lookups are safe from any sequence.
+class ShieldsSettingsCache
+    : public base::RefCountedThreadSafe<ShieldsSettingsCache> {
+ public:
+  static constexpr size_t kMaxEntries = 100;
+
+  // Must be called on the UI thread.
+  static scoped_refptr<ShieldsSettingsCache> FromBrowserContext(
+      content::BrowserContext* context);
+
+  // Returns the settings of |first_party_url|, reading them from the map the
+  // first time they are asked for. Settings of URLs without an origin, like
+  // empty ones, are read every time.
+  scoped_refptr<const ShieldsSettingsSnapshot> Get(
+      const GURL& first_party_url);
+  // Same, by the origin of the first-party site, which needs no GURL for a
+  // site whose settings are cached.
+  scoped_refptr<const ShieldsSettingsSnapshot> Get(
+      const url::Origin& first_party_origin);
+
+  void Invalidate();
+
+ private:
+  friend class base::RefCountedThreadSafe<ShieldsSettingsCache>;
+  class Holder;
+
+  explicit ShieldsSettingsCache(scoped_refptr<HostContentSettingsMap> map);
+  ~ShieldsSettingsCache();
+
+  const scoped_refptr<HostContentSettingsMap> map_;
+
+  base::Lock lock_;
+  base::MRUCache<url::Origin, scoped_refptr<const ShieldsSettingsSnapshot>>
+      snapshots_ GUARDED_BY(lock_);
+  // Bumped by Invalidate(), so snapshots read while it ran are not cached.
+  uint64_t generation_ GUARDED_BY(lock_) = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ShieldsSettingsCache);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_SHIELDS_SETTINGS_SNAPSHOT_H_
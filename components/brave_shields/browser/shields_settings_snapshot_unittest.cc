@@ -0,0 +1,79 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/shields_settings_snapshot.h"
+
+#include <memory>
+
+#include "base/macros.h"
+#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
+#include "chrome/test/base/testing_profile.h"
+#include "components/content_settings/core/browser/host_content_settings_map.h"
+#include "content/public/test/browser_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+#include "url/origin.h"
+
+using brave_shields::ControlType;
+using brave_shields::ShieldsSettingsCache;
+using brave_shields::ShieldsSettingsSnapshot;
+
+class ShieldsSettingsCacheTest : public testing::Test {
+ public:
+  ShieldsSettingsCacheTest() = default;
+  ~ShieldsSettingsCacheTest() override = default;
+
+  void SetUp() override { profile_ = std::make_unique<TestingProfile>(); }
+
+  TestingProfile* profile() { return profile_.get(); }
+  HostContentSettingsMap* map() {
+    return HostContentSettingsMapFactory::GetForProfile(profile());
+  }
+
+ private:
+  content::BrowserTaskEnvironment task_environment_;
+  std::unique_ptr<TestingProfile> profile_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShieldsSettingsCacheTest);
+};
+
+TEST_F(ShieldsSettingsCacheTest, MatchesContentSettings) {
+  const GURL url("https://brave.com");
+  brave_shields::SetAdControlType(map(), ControlType::ALLOW, url);
+  brave_shields::SetHTTPSEverywhereEnabled(map(), false, url);
+
+  auto cache = ShieldsSettingsCache::FromBrowserContext(profile());
+  auto settings = cache->Get(url);
+  EXPECT_TRUE(settings->brave_shields_enabled);
+  EXPECT_EQ(ControlType::ALLOW, settings->ad_control);
+  EXPECT_FALSE(settings->https_everywhere_enabled);
+
+  settings = cache->Get(GURL("https://example.com"));
+  EXPECT_EQ(ControlType::BLOCK, settings->ad_control);
+  EXPECT_TRUE(settings->https_everywhere_enabled);
+}
+
+TEST_F(ShieldsSettingsCacheTest, SharedPerProfile) {
+  auto cache = ShieldsSettingsCache::FromBrowserContext(profile());
+  EXPECT_EQ(cache, ShieldsSettingsCache::FromBrowserContext(profile()));
+
+  const GURL url("https://brave.com");
+  EXPECT_EQ(cache->Get(url), cache->Get(url));
+  EXPECT_EQ(cache->Get(url), cache->Get(url::Origin::Create(url)));
+  EXPECT_EQ(cache->Get(url), cache->Get(GURL("https://brave.com/path")));
+}
+
+TEST_F(ShieldsSettingsCacheTest, SettingChangeInvalidates) {
+  const GURL url("https://brave.com");
+  auto cache = ShieldsSettingsCache::FromBrowserContext(profile());
+  scoped_refptr<const ShieldsSettingsSnapshot> before = cache->Get(url);
+  EXPECT_TRUE(before->brave_shields_enabled);
+
+  brave_shields::SetBraveShieldsEnabled(map(), false, url);
+
+  scoped_refptr<const ShieldsSettingsSnapshot> after = cache->Get(url);
+  EXPECT_NE(before, after);
+  EXPECT_FALSE(after->brave_shields_enabled);
+}
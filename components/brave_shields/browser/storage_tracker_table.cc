@@ -0,0 +1,261 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/storage_tracker_table.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "base/files/file_path.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/stl_util.h"
+#include "base/sys_byteorder.h"
+#include "brave/components/brave_component_updater/browser/dat_file_util.h"
+
+namespace brave_shields {
+
+namespace {
+
+constexpr char kMagic[4] = {'B', 'S', 'T', 'P'};
+constexpr uint32_t kVersion = 1;
+// The magic and six fields.
+constexpr size_t kHeaderSize = 7 * sizeof(uint32_t);
+constexpr size_t kSlotSize = 2 * sizeof(uint32_t);
+
+// Average number of hosts per bucket. More makes the table smaller and the
+// build slower.
+constexpr uint32_t kHostsPerBucket = 4;
+constexpr uint32_t kMaxDisplacement = 1 << 16;
+constexpr uint32_t kMaxSeeds = 16;
+constexpr uint32_t kEmptySlot = std::numeric_limits<uint32_t>::max();
+
+// Seeded 64-bit FNV-1a with a final mix, so that all bits depend on the
+// seed. Tables are built ahead of time, so this must never change without
+// bumping kVersion.
+uint64_t Hash(base::StringPiece key, uint64_t seed) {
+  uint64_t hash = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+  for (char c : key) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+uint32_t BucketOf(base::StringPiece host, uint32_t seed, uint32_t buckets) {
+  return Hash(host, seed) % buckets;
+}
+
+uint32_t SlotOf(base::StringPiece host,
+                uint32_t seed,
+                uint32_t displacement,
+                uint32_t slots) {
+  return Hash(host, (uint64_t{displacement} + 1) << 32 | seed) % slots;
+}
+
+uint32_t ReadUint32(const uint8_t* data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return base::ByteSwapToLE32(value);
+}
+
+void AppendUint32(uint32_t value, std::string* data) {
+  value = base::ByteSwapToLE32(value);
+  data->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+}  // namespace
+
+StorageTrackerTable::StorageTrackerTable() = default;
+
+StorageTrackerTable::~StorageTrackerTable() = default;
+
+// static
+std::string StorageTrackerTable::Build(std::vector<std::string> hosts) {
+  base::EraseIf(hosts, [](const std::string& host) { return host.empty(); });
+  std::sort(hosts.begin(), hosts.end());
+  hosts.erase(std::unique(hosts.begin(), hosts.end()), hosts.end());
+
+  uint64_t strings_size = 0;
+  for (const auto& host : hosts)
+    strings_size += host.size();
+  if (strings_size > std::numeric_limits<uint32_t>::max())
+    return std::string();
+
+  const uint32_t host_count = hosts.size();
+  const uint32_t bucket_count =
+      std::max<uint32_t>(1, (host_count + kHostsPerBucket - 1) /
+                                kHostsPerBucket);
+  const uint32_t slot_count =
+      std::max<uint32_t>(1, host_count + host_count / 4);
+
+  for (uint32_t seed = 0; seed < kMaxSeeds; ++seed) {
+    std::vector<std::vector<uint32_t>> buckets(bucket_count);
+    for (uint32_t i = 0; i < host_count; ++i)
+      buckets[BucketOf(hosts[i], seed, bucket_count)].push_back(i);
+
+    // Place the fullest buckets first, while most slots are free.
+    std::vector<uint32_t> order(bucket_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&buckets](uint32_t a, uint32_t b) {
+                       return buckets[a].size() > buckets[b].size();
+                     });
+
+    std::vector<uint32_t> displacements(bucket_count, 0);
+    std::vector<uint32_t> slot_hosts(slot_count, kEmptySlot);
+    std::vector<uint32_t> candidate_slots;
+    bool placed_all = true;
+    for (uint32_t bucket : order) {
+      const auto& members = buckets[bucket];
+      if (members.empty())
+        break;
+      bool placed = false;
+      for (uint32_t displacement = 0;
+           !placed && displacement < kMaxDisplacement; ++displacement) {
+        candidate_slots.clear();
+        placed = true;
+        for (uint32_t host : members) {
+          const uint32_t slot =
+              SlotOf(hosts[host], seed, displacement, slot_count);
+          if (slot_hosts[slot] != kEmptySlot ||
+              base::Contains(candidate_slots, slot)) {
+            placed = false;
+            break;
+          }
+          candidate_slots.push_back(slot);
+        }
+        if (placed) {
+          displacements[bucket] = displacement;
+          for (size_t i = 0; i < members.size(); ++i)
+            slot_hosts[candidate_slots[i]] = members[i];
+        }
+      }
+      if (!placed) {
+        placed_all = false;
+        break;
+      }
+    }
+    if (!placed_all)
+      continue;
+
+    std::string data(kMagic, sizeof(kMagic));
+    data.reserve(kHeaderSize + bucket_count * sizeof(uint32_t) +
+                 slot_count * kSlotSize + strings_size);
+    AppendUint32(kVersion, &data);
+    AppendUint32(seed, &data);
+    AppendUint32(bucket_count, &data);
+    AppendUint32(slot_count, &data);
+    AppendUint32(host_count, &data);
+    AppendUint32(strings_size, &data);
+    for (uint32_t displacement : displacements)
+      AppendUint32(displacement, &data);
+    uint32_t offset = 0;
+    for (uint32_t host : slot_hosts) {
+      const uint32_t length = host == kEmptySlot ? 0 : hosts[host].size();
+      AppendUint32(length ? offset : 0, &data);
+      AppendUint32(length, &data);
+      offset += length;
+    }
+    for (uint32_t host : slot_hosts) {
+      if (host != kEmptySlot)
+        data.append(hosts[host]);
+    }
+    return data;
+  }
+
+  LOG(ERROR) << "No perfect hash found for " << host_count << " hosts";
+  return std::string();
+}
+
+// static
+std::unique_ptr<StorageTrackerTable> StorageTrackerTable::FromString(
+    std::string data) {
+  auto table = base::WrapUnique(new StorageTrackerTable());
+  table->owned_data_ = std::move(data);
+  if (!table->Init(
+          reinterpret_cast<const uint8_t*>(table->owned_data_.data()),
+          table->owned_data_.size())) {
+    return nullptr;
+  }
+  return table;
+}
+
+// static
+std::unique_ptr<StorageTrackerTable> StorageTrackerTable::FromFile(
+    const base::FilePath& path) {
+  auto table = base::WrapUnique(new StorageTrackerTable());
+  table->mapped_file_ = brave_component_updater::MappedDATFile::Open(path);
+  if (!table->mapped_file_)
+    return nullptr;
+  if (!table->Init(table->mapped_file_->data(),
+                   table->mapped_file_->length())) {
+    LOG(ERROR) << "StorageTrackerTable: invalid table " << path;
+    return nullptr;
+  }
+  return table;
+}
+
+bool StorageTrackerTable::Init(const uint8_t* data, size_t length) {
+  if (length < kHeaderSize || memcmp(data, kMagic, sizeof(kMagic)) != 0 ||
+      ReadUint32(data + 4) != kVersion) {
+    return false;
+  }
+  seed_ = ReadUint32(data + 8);
+  bucket_count_ = ReadUint32(data + 12);
+  slot_count_ = ReadUint32(data + 16);
+  host_count_ = ReadUint32(data + 20);
+  strings_size_ = ReadUint32(data + 24);
+  if (!bucket_count_ || !slot_count_)
+    return false;
+
+  const uint64_t expected_length = kHeaderSize +
+                                   uint64_t{bucket_count_} * sizeof(uint32_t) +
+                                   uint64_t{slot_count_} * kSlotSize +
+                                   strings_size_;
+  if (expected_length != length)
+    return false;
+
+  displacements_ = data + kHeaderSize;
+  slots_ = displacements_ + bucket_count_ * sizeof(uint32_t);
+  strings_ = reinterpret_cast<const char*>(slots_ + slot_count_ * kSlotSize);
+
+  // Check every slot once here, so lookups need no bounds checks.
+  uint32_t hosts = 0;
+  for (uint32_t slot = 0; slot < slot_count_; ++slot) {
+    const uint32_t offset = ReadUint32(slots_ + slot * kSlotSize);
+    const uint32_t host_length = ReadUint32(slots_ + slot * kSlotSize + 4);
+    if (uint64_t{offset} + host_length > strings_size_)
+      return false;
+    if (host_length)
+      ++hosts;
+  }
+  return hosts == host_count_;
+}
+
+base::StringPiece StorageTrackerTable::HostAt(uint32_t slot) const {
+  const uint8_t* entry = slots_ + slot * kSlotSize;
+  return base::StringPiece(strings_ + ReadUint32(entry), ReadUint32(entry + 4));
+}
+
+bool StorageTrackerTable::Contains(base::StringPiece host) const {
+  if (host.empty())
+    return false;
+  const uint32_t bucket = BucketOf(host, seed_, bucket_count_);
+  const uint32_t displacement =
+      ReadUint32(displacements_ + bucket * sizeof(uint32_t));
+  return HostAt(SlotOf(host, seed_, displacement, slot_count_)) == host;
+}
+
+}  // namespace brave_shields
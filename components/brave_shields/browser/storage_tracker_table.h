@@ -0,0 +1,87 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_STORAGE_TRACKER_TABLE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_STORAGE_TRACKER_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+class FilePath;
+}
+
+namespace brave_component_updater {
+class MappedDATFile;
+}
+
+namespace brave_shields {
+
+// A read-only set of first-party storage tracker hosts, stored as a minimal
+// perfect hash table in a flat binary format:
+//
+//   header        "BSTP", version, seed, bucket count, slot count,
+//                 host count, strings size (little-endian uint32s)
+//   displacements one uint32 per bucket
+//   slots         offset and length (uint32s) of a host in |strings|, or
+//                 zero length for an empty slot
+//   strings       the hosts, back to back
+//
+// A host hashes to a bucket, whose displacement picks its slot, so a lookup
+// is two hashes and one string compare. The table can be built ahead of
+// time and shipped with the component, then used straight from a read-only
+// mapping of the file.
+class StorageTrackerTable {
+ public:
+  ~StorageTrackerTable();
+
+  // Returns the serialized table for |hosts|, or an empty string if no
+  // perfect hash could be found for them.
+  static std::string Build(std::vector<std::string> hosts);
+
+  // Returns null if |data| is not a valid table.
+  static std::unique_ptr<StorageTrackerTable> FromString(std::string data);
+  // Maps |path| and uses the table in place. Returns null if it can't be
+  // mapped or isn't a valid table.
+  static std::unique_ptr<StorageTrackerTable> FromFile(
+      const base::FilePath& path);
+
+  bool Contains(base::StringPiece host) const;
+
+  size_t size() const { return host_count_; }
+  bool empty() const { return host_count_ == 0; }
+
+ private:
+  StorageTrackerTable();
+
+  bool Init(const uint8_t* data, size_t length);
+  base::StringPiece HostAt(uint32_t slot) const;
+
+  // Hold the table's memory: only one of them is used.
+  std::string owned_data_;
+  std::unique_ptr<brave_component_updater::MappedDATFile> mapped_file_;
+
+  uint32_t seed_ = 0;
+  uint32_t bucket_count_ = 0;
+  uint32_t slot_count_ = 0;
+  uint32_t host_count_ = 0;
+  const uint8_t* displacements_ = nullptr;
+  const uint8_t* slots_ = nullptr;
+  const char* strings_ = nullptr;
+  uint32_t strings_size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(StorageTrackerTable);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_STORAGE_TRACKER_TABLE_H_
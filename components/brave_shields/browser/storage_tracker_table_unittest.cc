@@ -0,0 +1,87 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/storage_tracker_table.h"
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using brave_shields::StorageTrackerTable;
+
+namespace {
+
+std::vector<std::string> MakeHosts(int count) {
+  std::vector<std::string> hosts;
+  for (int i = 0; i < count; ++i)
+    hosts.push_back("tracker" + base::NumberToString(i) + ".example.com");
+  return hosts;
+}
+
+}  // namespace
+
+TEST(StorageTrackerTableTest, ContainsOnlyBuiltHosts) {
+  for (int count : {0, 1, 2, 10, 5000}) {
+    const std::vector<std::string> hosts = MakeHosts(count);
+    auto table =
+        StorageTrackerTable::FromString(StorageTrackerTable::Build(hosts));
+    ASSERT_TRUE(table) << count;
+    EXPECT_EQ(static_cast<size_t>(count), table->size());
+    for (const auto& host : hosts)
+      EXPECT_TRUE(table->Contains(host)) << host;
+    EXPECT_FALSE(table->Contains(""));
+    EXPECT_FALSE(table->Contains("example.com"));
+    EXPECT_FALSE(table->Contains("tracker1.example.co"));
+    EXPECT_FALSE(table->Contains("www.tracker1.example.com"));
+  }
+}
+
+TEST(StorageTrackerTableTest, SkipsDuplicateAndEmptyHosts) {
+  auto table = StorageTrackerTable::FromString(
+      StorageTrackerTable::Build({"a.com", "", "b.com", "a.com"}));
+  ASSERT_TRUE(table);
+  EXPECT_EQ(2u, table->size());
+  EXPECT_TRUE(table->Contains("a.com"));
+  EXPECT_TRUE(table->Contains("b.com"));
+}
+
+TEST(StorageTrackerTableTest, RejectsInvalidData) {
+  const std::string data = StorageTrackerTable::Build(MakeHosts(10));
+  ASSERT_FALSE(data.empty());
+
+  EXPECT_FALSE(StorageTrackerTable::FromString(std::string()));
+  EXPECT_FALSE(StorageTrackerTable::FromString("a.com,b.com"));
+  EXPECT_FALSE(
+      StorageTrackerTable::FromString(data.substr(0, data.size() - 1)));
+  EXPECT_FALSE(StorageTrackerTable::FromString(data + "x"));
+
+  std::string bad_magic = data;
+  bad_magic[0] = 'X';
+  EXPECT_FALSE(StorageTrackerTable::FromString(bad_magic));
+}
+
+TEST(StorageTrackerTableTest, FromFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath path = temp_dir.GetPath().AppendASCII("trackers.table");
+
+  const std::vector<std::string> hosts = MakeHosts(100);
+  const std::string data = StorageTrackerTable::Build(hosts);
+  ASSERT_TRUE(base::WriteFile(path, data));
+
+  auto table = StorageTrackerTable::FromFile(path);
+  ASSERT_TRUE(table);
+  for (const auto& host : hosts)
+    EXPECT_TRUE(table->Contains(host)) << host;
+  EXPECT_FALSE(table->Contains("brave.com"));
+
+  EXPECT_FALSE(
+      StorageTrackerTable::FromFile(temp_dir.GetPath().AppendASCII("none")));
+}
@@ -9,16 +9,17 @@
 
 #include "base/bind.h"
 #include "base/command_line.h"
-#include "base/task/post_task.h"
 #include "base/task_runner_util.h"
 #include "brave/common/brave_switches.h"
 #include "brave/components/brave_component_updater/browser/local_data_files_service.h"
-#include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
 
 #if BUILDFLAG(BRAVE_STP_ENABLED)
+#include "base/files/file_util.h"
+#include "base/hash/hash.h"
 #include "base/strings/string_split.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "brave/components/brave_shields/browser/storage_tracker_table.h"
 #include "brave/components/brave_shields/browser/tracking_protection_helper.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "components/content_settings/core/browser/host_content_settings_map.h"
@@ -31,13 +32,18 @@ namespace brave_shields {
 #if BUILDFLAG(BRAVE_STP_ENABLED)
 const char kDatFileVersion[] = "1";
 const char kStorageTrackersFile[] = "StorageTrackingProtection.dat";
+// The same list, prebuilt as a StorageTrackerTable.
+const char kStorageTrackersTableFile[] = "StorageTrackingProtection.table";
 #endif
 
 TrackingProtectionService::TrackingProtectionService(
     LocalDataFilesService* local_data_files_service)
     : LocalDataFilesObserver(local_data_files_service),
-      weak_factory_(this),
-      weak_factory_io_thread_(this) {
+#if BUILDFLAG(BRAVE_STP_ENABLED)
+      first_party_storage_trackers_(nullptr,
+                                    base::OnTaskRunnerDeleter(nullptr)),
+#endif
+      weak_factory_(this) {
 }
 
 TrackingProtectionService::~TrackingProtectionService() {
@@ -76,22 +82,27 @@ bool TrackingProtectionService::RenderFrameIdKey::operator==(
          frame_routing_id == other.frame_routing_id;
 }
 
+size_t TrackingProtectionService::RenderFrameIdKey::Hash::operator()(
+    const RenderFrameIdKey& key) const {
+  return base::HashInts(key.render_process_id, key.frame_routing_id);
+}
+
 void TrackingProtectionService::SetStartingSiteForRenderFrame(
     GURL starting_site,
     int render_process_id,
     int render_frame_id) {
-  DCHECK_CURRENTLY_ON(BrowserThread::IO);
-  const RenderFrameIdKey key(render_process_id, render_frame_id);
-  render_frame_key_to_starting_site_url[key] = starting_site;
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  starting_sites_[RenderFrameIdKey(render_process_id, render_frame_id)] =
+      std::move(starting_site);
 }
 
 GURL TrackingProtectionService::GetStartingSiteForRenderFrame(
     int render_process_id,
     int render_frame_id) const {
   DCHECK_CURRENTLY_ON(BrowserThread::UI);
-  const RenderFrameIdKey key(render_process_id, render_frame_id);
-  auto iter = render_frame_key_to_starting_site_url.find(key);
-  if (iter != render_frame_key_to_starting_site_url.end()) {
+  auto iter =
+      starting_sites_.find(RenderFrameIdKey(render_process_id, render_frame_id));
+  if (iter != starting_sites_.end()) {
     return iter->second;
   }
   return {};
@@ -101,22 +112,22 @@ void TrackingProtectionService::ModifyRenderFrameKey(int old_render_process_id,
                                                      int old_render_frame_id,
                                                      int new_render_process_id,
                                                      int new_render_frame_id) {
-  DCHECK_CURRENTLY_ON(BrowserThread::IO);
-  const RenderFrameIdKey old_key(old_render_process_id, old_render_frame_id);
-  auto iter = render_frame_key_to_starting_site_url.find(old_key);
-  if (iter != render_frame_key_to_starting_site_url.end()) {
-    const RenderFrameIdKey new_key(new_render_process_id, new_render_frame_id);
-    render_frame_key_to_starting_site_url.insert(
-        std::pair<RenderFrameIdKey, GURL>(new_key, iter->second));
-    render_frame_key_to_starting_site_url.erase(old_key);
-  }
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  auto iter = starting_sites_.find(
+      RenderFrameIdKey(old_render_process_id, old_render_frame_id));
+  if (iter == starting_sites_.end())
+    return;
+  GURL starting_site = std::move(iter->second);
+  starting_sites_.erase(iter);
+  starting_sites_.emplace(
+      RenderFrameIdKey(new_render_process_id, new_render_frame_id),
+      std::move(starting_site));
 }
 
 void TrackingProtectionService::DeleteRenderFrameKey(int render_process_id,
                                                      int render_frame_id) {
-  DCHECK_CURRENTLY_ON(BrowserThread::IO);
-  const RenderFrameIdKey key(render_process_id, render_frame_id);
-  render_frame_key_to_starting_site_url.erase(key);
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  starting_sites_.erase(RenderFrameIdKey(render_process_id, render_frame_id));
 }
 
 bool TrackingProtectionService::ShouldStoreState(HostContentSettingsMap* map,
@@ -128,7 +139,8 @@ bool TrackingProtectionService::ShouldStoreState(HostContentSettingsMap* map,
     return true;
   }
 
-  if (first_party_storage_trackers_.empty()) {
+  if (!first_party_storage_trackers_ ||
+      first_party_storage_trackers_->empty()) {
     LOG(INFO) << "First party storage trackers list is empty";
     return true;
   }
@@ -152,36 +164,55 @@ bool TrackingProtectionService::ShouldStoreState(HostContentSettingsMap* map,
     return true;
 
   // deny storage if host is found in the tracker list
-  return first_party_storage_trackers_.find(host) ==
-         first_party_storage_trackers_.end();
+  return !first_party_storage_trackers_->Contains(host);
 }
 
-void TrackingProtectionService::OnGetSTPDATFileData(std::string contents) {
-  if (contents.empty()) {
+// static
+std::unique_ptr<StorageTrackerTable>
+TrackingProtectionService::LoadStorageTrackerTable(
+    const base::FilePath& dat_dir) {
+  const base::FilePath table_path =
+      dat_dir.AppendASCII(kStorageTrackersTableFile);
+  if (base::PathExists(table_path))
+    return StorageTrackerTable::FromFile(table_path);
+
+  const auto contents = brave_component_updater::MappedDATFile::Open(
+      dat_dir.AppendASCII(kStorageTrackersFile));
+  if (!contents) {
     LOG(ERROR) << "Could not obtain first party trackers data";
-    return;
+    return nullptr;
   }
 
   std::vector<std::string> storage_trackers =
-      base::SplitString(base::StringPiece(contents.data(), contents.size()),
-                        ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+      base::SplitString(contents->AsStringPiece(), ",",
+                        base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
 
   if (storage_trackers.empty()) {
     LOG(ERROR) << "No first party trackers found";
-    return;
+    return nullptr;
   }
 
-  base::PostTask(
-      FROM_HERE, {BrowserThread::IO},
-      base::BindOnce(
-          &TrackingProtectionService::UpdateFirstPartyStorageTrackers,
-          weak_factory_io_thread_.GetWeakPtr(), std::move(storage_trackers)));
+  return StorageTrackerTable::FromString(
+      StorageTrackerTable::Build(std::move(storage_trackers)));
+}
+
+void TrackingProtectionService::OnStorageTrackerTableLoaded(
+    std::unique_ptr<StorageTrackerTable> table) {
+  // The reply to OnComponentReady(), so already on the UI thread.
+  if (!table)
+    return;
+
+  UpdateFirstPartyStorageTrackers(
+      std::unique_ptr<StorageTrackerTable, base::OnTaskRunnerDeleter>(
+          table.release(),
+          base::OnTaskRunnerDeleter(
+              local_data_files_service()->GetTaskRunner())));
 }
 
 void TrackingProtectionService::UpdateFirstPartyStorageTrackers(
-    std::vector<std::string> storage_trackers) {
-  first_party_storage_trackers_ =
-      base::flat_set<std::string>(std::move(storage_trackers));
+    std::unique_ptr<StorageTrackerTable, base::OnTaskRunnerDeleter> table) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  first_party_storage_trackers_ = std::move(table);
 }
 
 #else  // !BUILDFLAG(BRAVE_STP_ENABLED)
@@ -216,16 +247,12 @@ void TrackingProtectionService::OnComponentReady(
   if (!IsSmartTrackingProtectionEnabled()) {
     return;
   }
-  base::FilePath storage_tracking_protection_path = install_dir
-      .AppendASCII(kDatFileVersion)
-      .AppendASCII(kStorageTrackersFile);
-
   base::PostTaskAndReplyWithResult(
       local_data_files_service()->GetTaskRunner().get(),
       FROM_HERE,
-      base::BindOnce(&brave_component_updater::GetDATFileAsString,
-                     storage_tracking_protection_path),
-      base::BindOnce(&TrackingProtectionService::OnGetSTPDATFileData,
+      base::BindOnce(&TrackingProtectionService::LoadStorageTrackerTable,
+                     install_dir.AppendASCII(kDatFileVersion)),
+      base::BindOnce(&TrackingProtectionService::OnStorageTrackerTableLoaded,
                      weak_factory_.GetWeakPtr()));
 #endif
 }
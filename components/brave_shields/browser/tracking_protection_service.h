@@ -9,10 +9,10 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
-#include "base/containers/flat_set.h"
 #include "base/files/file_path.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequenced_task_runner.h"
@@ -31,6 +31,8 @@ using brave_component_updater::LocalDataFilesService;
 
 namespace brave_shields {
 
+class StorageTrackerTable;
+
 // The brave shields service in charge of tracking protection and init.
 class TrackingProtectionService : public LocalDataFilesObserver {
  public:
@@ -75,10 +77,13 @@ class TrackingProtectionService : public LocalDataFilesObserver {
 
  protected:
 #if BUILDFLAG(BRAVE_STP_ENABLED)
-  // ParseStorageTrackersData parses the storage trackers list provided by
-  // the offline-crawler
-  void OnGetSTPDATFileData(std::string contents);
-  void UpdateFirstPartyStorageTrackers(std::vector<std::string>);
+  // Loads the storage trackers list provided by the offline-crawler, from
+  // its prebuilt table if the component has one, or else from its CSV.
+  static std::unique_ptr<StorageTrackerTable> LoadStorageTrackerTable(
+      const base::FilePath& dat_dir);
+  void OnStorageTrackerTableLoaded(std::unique_ptr<StorageTrackerTable> table);
+  void UpdateFirstPartyStorageTrackers(
+      std::unique_ptr<StorageTrackerTable, base::OnTaskRunnerDeleter> table);
 
   // For Smart Tracking Protection, we need to keep track of the starting site
   // that initiated the redirects. We use RenderFrameIdKey to determine the
@@ -92,13 +97,23 @@ class TrackingProtectionService : public LocalDataFilesObserver {
 
     bool operator<(const RenderFrameIdKey& other) const;
     bool operator==(const RenderFrameIdKey& other) const;
+
+    struct Hash {
+      size_t operator()(const RenderFrameIdKey& key) const;
+    };
   };
 #endif
 
  private:
 #if BUILDFLAG(BRAVE_STP_ENABLED)
-  base::flat_set<std::string> first_party_storage_trackers_;
-  std::map<RenderFrameIdKey, GURL> render_frame_key_to_starting_site_url;
+  // Only used on the UI thread, where storage access is checked. Unmapped on
+  // the files task runner, which may block.
+  std::unique_ptr<StorageTrackerTable, base::OnTaskRunnerDeleter>
+      first_party_storage_trackers_;
+  // The starting site of each render frame. Only used on the UI thread, by
+  // TrackingProtectionHelper and storage access checks.
+  std::unordered_map<RenderFrameIdKey, GURL, RenderFrameIdKey::Hash>
+      starting_sites_;
 #endif
 
   std::vector<std::string> third_party_base_hosts_;
@@ -106,7 +121,6 @@ class TrackingProtectionService : public LocalDataFilesObserver {
   base::Lock third_party_hosts_lock_;
 
   base::WeakPtrFactory<TrackingProtectionService> weak_factory_;
-  base::WeakPtrFactory<TrackingProtectionService> weak_factory_io_thread_;
   DISALLOW_COPY_AND_ASSIGN(TrackingProtectionService);
 };
 
@@ -14,5 +14,17 @@ const base::Feature kBraveAdblockCosmeticFiltering{
     "BraveAdblockCosmeticFiltering",
     base::FEATURE_ENABLED_BY_DEFAULT};
 
+// Caches recent adblock verdicts so repeated subresource URLs skip the
+// engines.
+const base::Feature kBraveAdblockDecisionCache{
+    "BraveAdblockDecisionCache",
+    base::FEATURE_DISABLED_BY_DEFAULT};
+
+// Runs the shields request pipeline for URLLoaders on a dedicated sequence,
+// so it doesn't compete with the UI thread during page loads.
+const base::Feature kBraveRequestsOffUIThread{
+    "BraveRequestsOffUIThread",
+    base::FEATURE_DISABLED_BY_DEFAULT};
+
 }  // namespace features
 }  // namespace brave_shields
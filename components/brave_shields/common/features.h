@@ -13,6 +13,8 @@ struct Feature;
 namespace brave_shields {
 namespace features {
 extern const base::Feature kBraveAdblockCosmeticFiltering;
+extern const base::Feature kBraveAdblockDecisionCache;
+extern const base::Feature kBraveRequestsOffUIThread;
 }  // namespace features
 }  // namespace brave_shields
 
@@ -5,16 +5,21 @@
 
 #include "brave/components/content_settings/core/browser/brave_content_settings_pref_provider.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
+#include "base/auto_reset.h"
 #include "base/bind.h"
+#include "base/no_destructor.h"
 #include "base/optional.h"
 #include "base/task/post_task.h"
+#include "base/threading/thread_local.h"
 #include "brave/common/network_constants.h"
 #include "brave/common/pref_names.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "brave/components/content_settings/core/browser/brave_content_settings_utils.h"
+#include "brave/components/content_settings/core/browser/brave_cookie_rule_index.h"
 #include "components/content_settings/core/browser/content_settings_pref.h"
 #include "components/content_settings/core/browser/website_settings_registry.h"
 #include "components/content_settings/core/common/content_settings_pattern.h"
@@ -24,6 +29,7 @@
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "url/gurl.h"
 
 namespace content_settings {
 
@@ -32,6 +38,25 @@ namespace {
 constexpr char kGoogleAuthPattern[] = "https://accounts.google.com/*";
 constexpr char kFirebasePattern[] = "https://[*.]firebaseapp.com/*";
 
+// The groups of cookie rules, in order of precedence.
+enum CookieRuleGroup : size_t {
+  kGoogleLoginRules,
+  kChromiumCookieRules,
+  kBraveCookieRules,
+  kShieldsDownRules,
+};
+
+// Shields and Brave cookie settings are kept in an index of their own.
+constexpr size_t kSettingsGroup = 0;
+
+base::ThreadLocalPointer<const BravePrefProvider::ScopedCookieLookup>&
+CurrentCookieLookup() {
+  static base::NoDestructor<
+      base::ThreadLocalPointer<const BravePrefProvider::ScopedCookieLookup>>
+      lookup;
+  return *lookup;
+}
+
 Rule CloneRule(const Rule& rule, bool reverse_patterns = false) {
   // brave plugin rules incorrectly use first party url as primary
   auto primary_pattern = reverse_patterns ? rule.secondary_pattern
@@ -58,6 +83,32 @@ Rule CloneRule(const Rule& rule, bool reverse_patterns = false) {
               rule.expiration, rule.session_model);
 }
 
+// Whether settings of this type make up the cookie rules.
+bool AffectsCookieRules(ContentSettingsType content_type,
+                        const std::string& resource_identifier) {
+  return content_type == ContentSettingsType::COOKIES ||
+         (content_type == ContentSettingsType::PLUGINS &&
+          (resource_identifier == brave_shields::kCookies ||
+           resource_identifier == brave_shields::kBraveShields));
+}
+
+Rule ShieldsDownRule(const ContentSettingsPattern& site_pattern) {
+  return Rule(ContentSettingsPattern::Wildcard(), site_pattern,
+              base::Value::FromUniquePtrValue(
+                  ContentSettingToValue(CONTENT_SETTING_ALLOW)),
+              base::Time(), SessionModel::Durable);
+}
+
+// Sets |rule| in |group| of |index| or, if it has no value, removes the rule
+// with its patterns. Returns whether the setting changed.
+bool SetOrRemove(BraveCookieRuleIndex* index, size_t group, Rule rule) {
+  if (rule.value.is_none()) {
+    return index->Remove(group, rule.primary_pattern,
+                         rule.secondary_pattern);
+  }
+  return index->Set(group, std::move(rule));
+}
+
 class BraveShieldsRuleIterator : public RuleIterator {
  public:
   explicit BraveShieldsRuleIterator(std::vector<Rule> rules)
@@ -70,19 +121,20 @@ class BraveShieldsRuleIterator : public RuleIterator {
   }
 
   Rule Next() override {
-    return CloneRule(*(iterator_++));
+    return std::move(*(iterator_++));
   }
 
  private:
+  // Copied from the provider, which changes its rules in place.
   std::vector<Rule> rules_;
-  std::vector<Rule>::const_iterator iterator_;
+  std::vector<Rule>::iterator iterator_;
 
   DISALLOW_COPY_AND_ASSIGN(BraveShieldsRuleIterator);
 };
 
 
 bool IsActive(const Rule& cookie_rule,
-              const std::vector<Rule>& shield_rules) {
+              const BraveCookieRuleIndex& shield_rules) {
   // don't include default rules in the iterator
   if (cookie_rule.primary_pattern == ContentSettingsPattern::Wildcard() &&
       (cookie_rule.secondary_pattern == ContentSettingsPattern::Wildcard() ||
@@ -92,16 +144,12 @@ bool IsActive(const Rule& cookie_rule,
   }
 
   bool default_value = true;
-  for (const auto& shield_rule : shield_rules) {
-    auto primary_compare =
-        shield_rule.primary_pattern.Compare(cookie_rule.primary_pattern);
-    // TODO(bridiver) - verify that SUCCESSOR is correct and not PREDECESSOR
-    if (primary_compare == ContentSettingsPattern::IDENTITY ||
-        primary_compare == ContentSettingsPattern::SUCCESSOR) {
-      // TODO(bridiver) - move this logic into shields_util for allow/block
-      return
-          ValueToContentSetting(&shield_rule.value) != CONTENT_SETTING_BLOCK;
-    }
+  // TODO(bridiver) - verify that SUCCESSOR is correct and not PREDECESSOR
+  const Rule* shield_rule =
+      shield_rules.FindFirstCovering(cookie_rule.primary_pattern);
+  if (shield_rule) {
+    // TODO(bridiver) - move this logic into shields_util for allow/block
+    return ValueToContentSetting(&shield_rule->value) != CONTENT_SETTING_BLOCK;
   }
 
   return default_value;
@@ -109,11 +157,32 @@ bool IsActive(const Rule& cookie_rule,
 
 }  // namespace
 
+BravePrefProvider::ScopedCookieLookup::ScopedCookieLookup(
+    const GURL& primary_url,
+    const GURL& secondary_url)
+    : primary_url_(primary_url),
+      secondary_url_(secondary_url),
+      outer_(CurrentCookieLookup().Get()) {
+  CurrentCookieLookup().Set(this);
+}
+
+BravePrefProvider::ScopedCookieLookup::~ScopedCookieLookup() {
+  DCHECK_EQ(this, CurrentCookieLookup().Get());
+  CurrentCookieLookup().Set(outer_);
+}
+
+// static
+const BravePrefProvider::ScopedCookieLookup*
+BravePrefProvider::ScopedCookieLookup::Get() {
+  return CurrentCookieLookup().Get();
+}
+
 BravePrefProvider::BravePrefProvider(PrefService* prefs,
                                      bool off_the_record,
                                      bool store_last_modified,
                                      bool restore_session)
     : PrefProvider(prefs, off_the_record, store_last_modified, restore_session),
+      patching_cookie_rules_(false),
       initialized_(false),
       weak_factory_(this) {
   brave_pref_change_registrar_.Init(prefs_);
@@ -249,16 +318,22 @@ bool BravePrefProvider::SetWebsiteSetting(
 
   // handle changes to brave cookie settings from chromium cookie settings UI
   if (content_type == ContentSettingsType::COOKIES) {
-    auto* value = in_value.get();
-    auto match = std::find_if(
-        brave_cookie_rules_[off_the_record_].begin(),
-        brave_cookie_rules_[off_the_record_].end(),
-        [primary_pattern, secondary_pattern, value](const auto& rule) {
-          return rule.primary_pattern == primary_pattern &&
-                 rule.secondary_pattern == secondary_pattern &&
-                 ValueToContentSetting(&rule.value) !=
-                    ValueToContentSetting(value); });
-    if (match != brave_cookie_rules_[off_the_record_].end()) {
+    bool is_brave_rule = false;
+    {
+      base::AutoLock lock(cookie_rules_lock_);
+      const auto& rules = *cookie_rules_.at(off_the_record_);
+      for (size_t group :
+           {kGoogleLoginRules, kBraveCookieRules, kShieldsDownRules}) {
+        const Rule* rule =
+            rules.Find(group, primary_pattern, secondary_pattern);
+        if (rule && ValueToContentSetting(&rule->value) !=
+                        ValueToContentSetting(in_value.get())) {
+          is_brave_rule = true;
+          break;
+        }
+      }
+    }
+    if (is_brave_rule) {
       // swap primary/secondary pattern - see CloneRule
       auto plugin_primary_pattern = secondary_pattern;
       auto plugin_secondary_pattern = primary_pattern;
@@ -270,16 +345,46 @@ bool BravePrefProvider::SetWebsiteSetting(
       }
 
       // change to type PLUGINS
-      return PrefProvider::SetWebsiteSetting(
+      return WriteWebsiteSetting(
           plugin_primary_pattern, plugin_secondary_pattern,
           ContentSettingsType::PLUGINS, brave_shields::kCookies,
           std::move(in_value), constraints);
     }
   }
 
-  return PrefProvider::SetWebsiteSetting(primary_pattern, secondary_pattern,
-                                         content_type, resource_identifier,
-                                         std::move(in_value), constraints);
+  return WriteWebsiteSetting(primary_pattern, secondary_pattern, content_type,
+                             resource_identifier, std::move(in_value),
+                             constraints);
+}
+
+bool BravePrefProvider::WriteWebsiteSetting(
+    const ContentSettingsPattern& primary_pattern,
+    const ContentSettingsPattern& secondary_pattern,
+    ContentSettingsType content_type,
+    const ResourceIdentifier& resource_identifier,
+    std::unique_ptr<base::Value>&& in_value,
+    const ContentSettingConstraints& constraints) {
+  if (!AffectsCookieRules(content_type, resource_identifier)) {
+    return PrefProvider::SetWebsiteSetting(primary_pattern, secondary_pattern,
+                                           content_type, resource_identifier,
+                                           std::move(in_value), constraints);
+  }
+
+  // Patch the cookie rules with the one setting that changed rather than
+  // rebuild them when the write notifies us.
+  base::Value value = in_value ? in_value->Clone() : base::Value();
+  bool written;
+  {
+    base::AutoReset<bool> patching(&patching_cookie_rules_, true);
+    written = PrefProvider::SetWebsiteSetting(
+        primary_pattern, secondary_pattern, content_type, resource_identifier,
+        std::move(in_value), constraints);
+  }
+  if (written) {
+    PatchCookieRules(primary_pattern, secondary_pattern, content_type,
+                     resource_identifier, std::move(value), constraints);
+  }
+  return written;
 }
 
 std::unique_ptr<RuleIterator> BravePrefProvider::GetRuleIterator(
@@ -287,13 +392,20 @@ std::unique_ptr<RuleIterator> BravePrefProvider::GetRuleIterator(
       const ResourceIdentifier& resource_identifier,
       bool incognito) const {
   if (content_type == ContentSettingsType::COOKIES) {
+    const ScopedCookieLookup* lookup = ScopedCookieLookup::Get();
     std::vector<Rule> rules;
-    for (auto i = cookie_rules_.at(incognito).begin();
-         i != cookie_rules_.at(incognito).end();
-         ++i) {
-      rules.emplace_back(CloneRule(*i));
+    {
+      base::AutoLock lock(cookie_rules_lock_);
+      const auto& cookie_rules = *cookie_rules_.at(incognito);
+      if (lookup) {
+        const Rule* rule = cookie_rules.FindFirstMatch(
+            lookup->primary_url(), lookup->secondary_url());
+        if (rule)
+          rules.push_back(CloneRule(*rule));
+      } else {
+        rules = cookie_rules.CloneRules();
+      }
     }
-
     return std::make_unique<BraveShieldsRuleIterator>(std::move(rules));
   }
 
@@ -309,11 +421,7 @@ std::unique_ptr<RuleIterator> BravePrefProvider::GetRuleIterator(
 
 void BravePrefProvider::UpdateCookieRules(ContentSettingsType content_type,
                                           bool incognito) {
-  auto& rules = cookie_rules_[incognito];
-  auto old_rules = std::move(brave_cookie_rules_[incognito]);
-
-  rules.clear();
-  brave_cookie_rules_[incognito].clear();
+  auto rules = std::make_unique<BraveCookieRuleIndex>();
 
   // kGoogleLoginControlType preference adds an exception for
   // accounts.google.com to access cookies in 3p context to allow login using
@@ -332,8 +440,7 @@ void BravePrefProvider::UpdateCookieRules(ContentSettingsType content_type,
         base::Value::FromUniquePtrValue(
                          ContentSettingToValue(CONTENT_SETTING_ALLOW)),
                      base::Time(), SessionModel::Durable);
-    rules.emplace_back(CloneRule(google_auth_rule));
-    brave_cookie_rules_[incognito].emplace_back(CloneRule(google_auth_rule));
+    rules->Add(kGoogleLoginRules, CloneRule(google_auth_rule));
 
     const auto firebase_rule = Rule(
         ContentSettingsPattern::FromString(kFirebasePattern),
@@ -341,8 +448,7 @@ void BravePrefProvider::UpdateCookieRules(ContentSettingsType content_type,
         base::Value::FromUniquePtrValue(
             ContentSettingToValue(CONTENT_SETTING_ALLOW)),
         base::Time(), SessionModel::Durable);
-    rules.emplace_back(CloneRule(firebase_rule));
-    brave_cookie_rules_[incognito].emplace_back(CloneRule(firebase_rule));
+    rules->Add(kGoogleLoginRules, CloneRule(firebase_rule));
   }
   // non-pref based exceptions should go in the cookie_settings_base.cc
   // chromium_src override
@@ -353,7 +459,8 @@ void BravePrefProvider::UpdateCookieRules(ContentSettingsType content_type,
       "",
       incognito);
   while (chromium_cookies_iterator && chromium_cookies_iterator->HasNext()) {
-    rules.emplace_back(CloneRule(chromium_cookies_iterator->Next()));
+    rules->Add(kChromiumCookieRules,
+               CloneRule(chromium_cookies_iterator->Next()));
   }
   chromium_cookies_iterator.reset();
 
@@ -363,9 +470,10 @@ void BravePrefProvider::UpdateCookieRules(ContentSettingsType content_type,
       incognito);
 
   // collect shield rules
-  std::vector<Rule> shield_rules;
+  auto shield_rules = std::make_unique<BraveCookieRuleIndex>();
   while (brave_shields_iterator && brave_shields_iterator->HasNext()) {
-    shield_rules.emplace_back(CloneRule(brave_shields_iterator->Next()));
+    shield_rules->Add(kSettingsGroup,
+                      CloneRule(brave_shields_iterator->Next()));
   }
 
   brave_shields_iterator.reset();
@@ -377,84 +485,144 @@ void BravePrefProvider::UpdateCookieRules(ContentSettingsType content_type,
       incognito);
 
   // Matching cookie rules against shield rules.
+  auto brave_cookie_settings = std::make_unique<BraveCookieRuleIndex>();
   while (brave_cookies_iterator && brave_cookies_iterator->HasNext()) {
     auto rule = brave_cookies_iterator->Next();
-    if (IsActive(rule, shield_rules)) {
-      rules.emplace_back(CloneRule(rule, true));
-      brave_cookie_rules_[incognito].emplace_back(CloneRule(rule, true));
-    }
+    if (IsActive(rule, *shield_rules))
+      rules->Add(kBraveCookieRules, CloneRule(rule, true));
+    brave_cookie_settings->Add(kSettingsGroup, std::move(rule));
   }
 
   // Adding shields down rules (they always override cookie rules).
-  for (const auto& shield_rule : shield_rules) {
+  shield_rules->ForEachRule([&rules](size_t group, const Rule& shield_rule) {
     // There is no global shields rule
     if (shield_rule.primary_pattern.MatchesAllHosts())
       NOTREACHED();
 
     // Shields down.
     if (ValueToContentSetting(&shield_rule.value) == CONTENT_SETTING_BLOCK) {
-      rules.emplace_back(
-          Rule(ContentSettingsPattern::Wildcard(),
-               shield_rule.primary_pattern,
-               base::Value::FromUniquePtrValue(
-                   ContentSettingToValue(CONTENT_SETTING_ALLOW)),
-               base::Time(), SessionModel::Durable));
-      brave_cookie_rules_[incognito].emplace_back(
-          Rule(ContentSettingsPattern::Wildcard(),
-               shield_rule.primary_pattern,
-               base::Value::FromUniquePtrValue(
-                   ContentSettingToValue(CONTENT_SETTING_ALLOW)),
-               base::Time(), SessionModel::Durable));
+      rules->Add(kShieldsDownRules,
+                 ShieldsDownRule(shield_rule.primary_pattern));
     }
-  }
+  });
 
-  // get the list of changes
   std::vector<Rule> brave_cookie_updates;
-  for (const auto& new_rule : brave_cookie_rules_[incognito]) {
-    auto match = std::find_if(
-        old_rules.begin(),
-        old_rules.end(),
-        [&new_rule](const auto& old_rule) {
-          // we want an exact match here because any change to the rule
-          // is an update
-          return new_rule.primary_pattern == old_rule.primary_pattern &&
-                 new_rule.secondary_pattern == old_rule.secondary_pattern &&
-                 ValueToContentSetting(&new_rule.value) ==
-                    ValueToContentSetting(&old_rule.value);
-        });
-    if (match == old_rules.end()) {
-      brave_cookie_updates.emplace_back(CloneRule(new_rule));
+  {
+    base::AutoLock lock(cookie_rules_lock_);
+    auto& old_rules = cookie_rules_[incognito];
+    if (old_rules) {
+      // get the list of changes
+      rules->ForEachRule([&](size_t group, const Rule& new_rule) {
+        if (group == kChromiumCookieRules)
+          return;
+        // we want an exact match here because any change to the rule
+        // is an update
+        const Rule* old_rule = old_rules->Find(
+            group, new_rule.primary_pattern, new_rule.secondary_pattern);
+        if (!old_rule || ValueToContentSetting(&old_rule->value) !=
+                             ValueToContentSetting(&new_rule.value)) {
+          brave_cookie_updates.push_back(CloneRule(new_rule));
+        }
+      });
+
+      // find any removed rules
+      old_rules->ForEachRule([&](size_t group, const Rule& old_rule) {
+        if (group == kChromiumCookieRules)
+          return;
+        if (!rules->Find(group, old_rule.primary_pattern,
+                         old_rule.secondary_pattern)) {
+          brave_cookie_updates.emplace_back(
+              old_rule.primary_pattern, old_rule.secondary_pattern,
+              base::Value(), old_rule.expiration, old_rule.session_model);
+        }
+      });
     }
+    old_rules = std::move(rules);
   }
+  shield_rules_[incognito] = std::move(shield_rules);
+  brave_cookie_settings_[incognito] = std::move(brave_cookie_settings);
 
-  // find any removed rules
-  for (const auto& old_rule : old_rules) {
-    auto match = std::find_if(
-        brave_cookie_rules_[incognito].begin(),
-        brave_cookie_rules_[incognito].end(),
-        [&old_rule](const auto& new_rule) {
-          // we only care about the patterns here because we're looking
-          // for deleted rules, not changed rules
-          return new_rule.primary_pattern == old_rule.primary_pattern &&
-                 new_rule.secondary_pattern == old_rule.secondary_pattern;
-        });
-    if (match == brave_cookie_rules_[incognito].end()) {
-      brave_cookie_updates.emplace_back(
-          Rule(old_rule.primary_pattern, old_rule.secondary_pattern,
-               base::Value(), old_rule.expiration, old_rule.session_model));
+  // Notify brave cookie changes as ContentSettingsType::COOKIES
+  if (initialized_ && content_type == ContentSettingsType::PLUGINS)
+    PostNotifyChanges(std::move(brave_cookie_updates), incognito);
+}
+
+void BravePrefProvider::PatchCookieRules(
+    const ContentSettingsPattern& primary_pattern,
+    const ContentSettingsPattern& secondary_pattern,
+    ContentSettingsType content_type,
+    const ResourceIdentifier& resource_identifier,
+    base::Value value,
+    const ContentSettingConstraints& constraints) {
+  // Settings are only written to this provider's own mode.
+  const bool incognito = off_the_record_;
+  const Rule setting(primary_pattern, secondary_pattern, std::move(value),
+                     constraints.expiration, constraints.session_model);
+
+  base::AutoLock lock(cookie_rules_lock_);
+  BraveCookieRuleIndex* rules = cookie_rules_[incognito].get();
+  if (content_type == ContentSettingsType::COOKIES) {
+    SetOrRemove(rules, kChromiumCookieRules, CloneRule(setting));
+    return;
+  }
+
+  BraveCookieRuleIndex* shield_rules = shield_rules_[incognito].get();
+  BraveCookieRuleIndex* brave_cookie_settings =
+      brave_cookie_settings_[incognito].get();
+  std::vector<Rule> brave_cookie_updates;
+
+  // Updates the rule made from |cookie_setting|, which only applies while the
+  // shields rules let it and it hasn't been |removed|.
+  auto update_brave_cookie_rule = [&](const Rule& cookie_setting,
+                                      bool removed) {
+    Rule cookie_rule = CloneRule(cookie_setting, true);
+    if (removed || !IsActive(cookie_setting, *shield_rules))
+      cookie_rule.value = base::Value();
+    if (SetOrRemove(rules, kBraveCookieRules, CloneRule(cookie_rule)))
+      brave_cookie_updates.push_back(std::move(cookie_rule));
+  };
+
+  if (resource_identifier == brave_shields::kCookies) {
+    SetOrRemove(brave_cookie_settings, kSettingsGroup, CloneRule(setting));
+    update_brave_cookie_rule(setting, setting.value.is_none());
+  } else {
+    DCHECK_EQ(brave_shields::kBraveShields, resource_identifier);
+    SetOrRemove(shield_rules, kSettingsGroup, CloneRule(setting));
+
+    Rule shields_down_rule = ShieldsDownRule(setting.primary_pattern);
+    if (setting.value.is_none() ||
+        ValueToContentSetting(&setting.value) != CONTENT_SETTING_BLOCK) {
+      shields_down_rule.value = base::Value();
     }
+    if (SetOrRemove(rules, kShieldsDownRules, CloneRule(shields_down_rule)))
+      brave_cookie_updates.push_back(std::move(shields_down_rule));
+
+    // Only the Brave cookie settings for the sites the shields rule covers
+    // can change.
+    brave_cookie_settings->ForEachRule(
+        [&](size_t group, const Rule& cookie_setting) {
+          auto relation =
+              setting.primary_pattern.Compare(cookie_setting.primary_pattern);
+          if (relation == ContentSettingsPattern::IDENTITY ||
+              relation == ContentSettingsPattern::SUCCESSOR) {
+            update_brave_cookie_rule(cookie_setting, false);
+          }
+        });
   }
 
   // Notify brave cookie changes as ContentSettingsType::COOKIES
-  if (initialized_ && content_type == ContentSettingsType::PLUGINS) {
-    // PostTask here to avoid content settings autolock DCHECK
-    base::PostTask(
-        FROM_HERE,
-        {content::BrowserThread::UI, base::TaskPriority::USER_VISIBLE},
-        base::BindOnce(&BravePrefProvider::NotifyChanges,
-                       weak_factory_.GetWeakPtr(),
-                       std::move(brave_cookie_updates), incognito));
-  }
+  if (initialized_)
+    PostNotifyChanges(std::move(brave_cookie_updates), incognito);
+}
+
+void BravePrefProvider::PostNotifyChanges(std::vector<Rule> rules,
+                                          bool incognito) {
+  // PostTask here to avoid content settings autolock DCHECK
+  base::PostTask(
+      FROM_HERE,
+      {content::BrowserThread::UI, base::TaskPriority::USER_VISIBLE},
+      base::BindOnce(&BravePrefProvider::NotifyChanges,
+                     weak_factory_.GetWeakPtr(), std::move(rules), incognito));
 }
 
 void BravePrefProvider::NotifyChanges(const std::vector<Rule>& rules,
@@ -483,12 +651,11 @@ void BravePrefProvider::OnContentSettingChanged(
     const ContentSettingsPattern& secondary_pattern,
     ContentSettingsType content_type,
     const std::string& resource_identifier) {
-  if (content_type == ContentSettingsType::COOKIES ||
-      (content_type == ContentSettingsType::PLUGINS &&
-          (resource_identifier == brave_shields::kCookies ||
-           resource_identifier == brave_shields::kBraveShields))) {
+  // Our own writes patch the cookie rules once written.
+  if (patching_cookie_rules_)
+    return;
+  if (AffectsCookieRules(content_type, resource_identifier))
     OnCookieSettingsChanged(content_type);
-  }
 }
 
 }  // namespace content_settings
@@ -11,13 +11,21 @@
 #include <string>
 #include <vector>
 
+#include "base/macros.h"
 #include "base/memory/weak_ptr.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/values.h"
 #include "components/content_settings/core/browser/content_settings_observer.h"
 #include "components/content_settings/core/browser/content_settings_pref_provider.h"
 #include "components/prefs/pref_change_registrar.h"
 
+class GURL;
+
 namespace content_settings {
 
+class BraveCookieRuleIndex;
+
 // With this subclass, shields configuration is persisted across sessions.
 // Its content type is |ContentSettingsType::PLUGIN| and its storage option is
 // ephemeral because chromium want that flash configuration shouldn't be
@@ -34,6 +42,29 @@ class BravePrefProvider : public PrefProvider,
                     bool restore_session);
   ~BravePrefProvider() override;
 
+  // While one is in scope, cookie rule iterators created on its thread only
+  // return the first rule matching its URLs, found through the index, instead
+  // of every cookie rule. HostContentSettingsMap looks cookie settings up for
+  // every cookie access within one, see the chromium_src override.
+  class ScopedCookieLookup {
+   public:
+    ScopedCookieLookup(const GURL& primary_url, const GURL& secondary_url);
+    ~ScopedCookieLookup();
+
+    // The innermost lookup in scope on this thread, if any.
+    static const ScopedCookieLookup* Get();
+
+    const GURL& primary_url() const { return primary_url_; }
+    const GURL& secondary_url() const { return secondary_url_; }
+
+   private:
+    const GURL& primary_url_;
+    const GURL& secondary_url_;
+    const ScopedCookieLookup* const outer_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedCookieLookup);
+  };
+
   static void RegisterProfilePrefs(user_prefs::PrefRegistrySyncable* registry);
 
   // content_settings::PrefProvider overrides:
@@ -54,12 +85,31 @@ class BravePrefProvider : public PrefProvider,
   FRIEND_TEST_ALL_PREFIXES(BravePrefProviderTest, TestShieldsSettingsMigration);
   FRIEND_TEST_ALL_PREFIXES(BravePrefProviderTest,
                            TestShieldsSettingsMigrationVersion);
+  FRIEND_TEST_ALL_PREFIXES(BravePrefProviderTest,
+                           CookieRulesPatchedAsRebuilt);
   void MigrateShieldsSettings(bool incognito);
   void MigrateShieldsSettingsV1ToV2();
   void MigrateShieldsSettingsV1ToV2ForOneType(ContentSettingsType content_type,
                                               const std::string& resource_id);
+  // Writes a setting like SetWebsiteSetting() once Brave cookie settings
+  // changed through the cookies type have been redirected.
+  bool WriteWebsiteSetting(const ContentSettingsPattern& primary_pattern,
+                           const ContentSettingsPattern& secondary_pattern,
+                           ContentSettingsType content_type,
+                           const ResourceIdentifier& resource_identifier,
+                           std::unique_ptr<base::Value>&& value,
+                           const ContentSettingConstraints& constraints);
   void UpdateCookieRules(ContentSettingsType content_type, bool incognito);
+  // Applies a change to one cookie, Brave cookie or shields setting to the
+  // cookie rules instead of rebuilding them.
+  void PatchCookieRules(const ContentSettingsPattern& primary_pattern,
+                        const ContentSettingsPattern& secondary_pattern,
+                        ContentSettingsType content_type,
+                        const ResourceIdentifier& resource_identifier,
+                        base::Value value,
+                        const ContentSettingConstraints& constraints);
   void OnCookieSettingsChanged(ContentSettingsType content_type);
+  void PostNotifyChanges(std::vector<Rule> rules, bool incognito);
   void NotifyChanges(const std::vector<Rule>& rules, bool incognito);
 
   // content_settings::Observer overrides:
@@ -72,8 +122,19 @@ class BravePrefProvider : public PrefProvider,
   // PrefProvider::pref_change_registrar_ alreay has plugin type.
   PrefChangeRegistrar brave_pref_change_registrar_;
 
-  std::map<bool /* is_incognito */, std::vector<Rule>> cookie_rules_;
-  std::map<bool /* is_incognito */, std::vector<Rule>> brave_cookie_rules_;
+  // Cookie rules are read from any thread and changed on the UI thread.
+  mutable base::Lock cookie_rules_lock_;
+  std::map<bool /* is_incognito */, std::unique_ptr<BraveCookieRuleIndex>>
+      cookie_rules_ GUARDED_BY(cookie_rules_lock_);
+  // The shields and Brave cookie settings the Brave cookie rules are made
+  // from, only used on the UI thread.
+  std::map<bool /* is_incognito */, std::unique_ptr<BraveCookieRuleIndex>>
+      shield_rules_;
+  std::map<bool /* is_incognito */, std::unique_ptr<BraveCookieRuleIndex>>
+      brave_cookie_settings_;
+  // Set while SetWebsiteSetting() writes a setting it then patches the
+  // cookie rules with.
+  bool patching_cookie_rules_;
 
   bool initialized_;
 
@@ -4,7 +4,10 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include <memory>
+#include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "base/macros.h"
 #include "base/optional.h"
@@ -337,4 +340,77 @@ TEST_F(BravePrefProviderTest, TestShieldsSettingsMigrationVersion) {
   provider.ShutdownOnUIThread();
 }
 
+TEST_F(BravePrefProviderTest, CookieRulesPatchedAsRebuilt) {
+  BravePrefProvider provider(
+      testing_profile()->GetPrefs(), false /* incognito */,
+      true /* store_last_modified */, false /* restore_session */);
+
+  auto set = [&provider](const std::string& primary_pattern,
+                         const std::string& secondary_pattern,
+                         ContentSettingsType content_type,
+                         const std::string& resource_identifier,
+                         ContentSetting setting) {
+    provider.SetWebsiteSetting(
+        ContentSettingsPattern::FromString(primary_pattern),
+        ContentSettingsPattern::FromString(secondary_pattern), content_type,
+        resource_identifier, ContentSettingToValue(setting), {});
+  };
+  auto cookie_rules = [&provider]() {
+    std::vector<std::tuple<ContentSettingsPattern, ContentSettingsPattern,
+                           ContentSetting>>
+        rules;
+    auto iterator = provider.GetRuleIterator(ContentSettingsType::COOKIES,
+                                             std::string(), false);
+    while (iterator->HasNext()) {
+      auto rule = iterator->Next();
+      rules.emplace_back(rule.primary_pattern, rule.secondary_pattern,
+                         ValueToContentSetting(&rule.value));
+    }
+    return rules;
+  };
+
+  set("[*.]brave.com", "*", ContentSettingsType::COOKIES, "",
+      CONTENT_SETTING_BLOCK);
+  set("*", "[*.]brave.com", ContentSettingsType::PLUGINS,
+      brave_shields::kCookies, CONTENT_SETTING_ALLOW);
+  set("[*.]example.com", "https://firstParty/*", ContentSettingsType::PLUGINS,
+      brave_shields::kCookies, CONTENT_SETTING_BLOCK);
+  set("[*.]example.com", "*", ContentSettingsType::PLUGINS,
+      brave_shields::kBraveShields, CONTENT_SETTING_BLOCK);
+  set("[*.]brave.com", "*", ContentSettingsType::PLUGINS,
+      brave_shields::kBraveShields, CONTENT_SETTING_BLOCK);
+  set("[*.]example.com", "*", ContentSettingsType::PLUGINS,
+      brave_shields::kBraveShields, CONTENT_SETTING_ALLOW);
+  set("[*.]brave.com", "*", ContentSettingsType::COOKIES, "",
+      CONTENT_SETTING_DEFAULT);
+
+  const auto patched_rules = cookie_rules();
+  EXPECT_FALSE(patched_rules.empty());
+
+  provider.OnCookieSettingsChanged(ContentSettingsType::PLUGINS);
+  EXPECT_EQ(patched_rules, cookie_rules());
+
+  // Looking up the rule for a pair of URLs finds what walking every rule does.
+  const std::vector<std::pair<GURL, GURL>> urls = {
+      {GURL("https://brave.com"), GURL("https://brave.com")},
+      {GURL("https://a.brave.com"), GURL("https://example.com")},
+      {GURL("https://example.com"), GURL("https://a.example.com")},
+      {GURL("https://tracker.com"), GURL("https://example.com")},
+      {GURL("https://tracker.com"), GURL("https://brave.com")},
+  };
+  for (const auto& url_pair : urls) {
+    const ContentSetting setting = TestUtils::GetContentSetting(
+        &provider, url_pair.first, url_pair.second,
+        ContentSettingsType::COOKIES, std::string(), false);
+    BravePrefProvider::ScopedCookieLookup lookup(url_pair.first,
+                                                 url_pair.second);
+    EXPECT_EQ(setting, TestUtils::GetContentSetting(
+                           &provider, url_pair.first, url_pair.second,
+                           ContentSettingsType::COOKIES, std::string(), false))
+        << url_pair.first << " " << url_pair.second;
+  }
+
+  provider.ShutdownOnUIThread();
+}
+
 }  //  namespace content_settings
@@ -0,0 +1,223 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/content_settings/core/browser/brave_cookie_rule_index.h"
+
+#include <tuple>
+#include <utility>
+
+#include "url/gurl.h"
+
+namespace content_settings {
+
+namespace {
+
+// Whether |pattern| only matches a host and, with a domain wildcard, its
+// subdomains.
+bool IsHostSpecific(const ContentSettingsPattern& pattern) {
+  return !pattern.GetHost().empty();
+}
+
+base::StringPiece TrimTrailingDot(base::StringPiece host) {
+  if (host.ends_with("."))
+    host.remove_suffix(1);
+  return host;
+}
+
+}  // namespace
+
+BraveCookieRuleIndex::Entry::Entry(size_t group, Rule rule)
+    : group(group), rule(std::move(rule)) {}
+
+BraveCookieRuleIndex::Entry::Entry(Entry&& other) = default;
+
+BraveCookieRuleIndex::Entry::~Entry() = default;
+
+// static
+BraveCookieRuleIndex::EntryLess::Key BraveCookieRuleIndex::EntryLess::KeyOf(
+    const Entry& entry) {
+  return {entry.group, entry.rule.primary_pattern,
+          entry.rule.secondary_pattern};
+}
+
+// static
+bool BraveCookieRuleIndex::EntryLess::Less(const Key& lhs, const Key& rhs) {
+  if (lhs.group != rhs.group)
+    return lhs.group < rhs.group;
+  // Reversed, as in OriginIdentifierValueMap, so that patterns with higher
+  // precedence come first.
+  return std::tie(rhs.primary_pattern, rhs.secondary_pattern) <
+         std::tie(lhs.primary_pattern, lhs.secondary_pattern);
+}
+
+BraveCookieRuleIndex::BraveCookieRuleIndex() = default;
+
+BraveCookieRuleIndex::~BraveCookieRuleIndex() = default;
+
+void BraveCookieRuleIndex::Add(size_t group, Rule rule) {
+  if (Find(group, rule.primary_pattern, rule.secondary_pattern))
+    return;
+  Insert(Entry(group, std::move(rule)));
+}
+
+bool BraveCookieRuleIndex::Set(size_t group, Rule rule) {
+  auto it = entries_.find(EntryLess::Key{group, rule.primary_pattern,
+                                         rule.secondary_pattern});
+  bool changed = true;
+  if (it != entries_.end()) {
+    changed = it->rule.value != rule.value;
+    Erase(it);
+  }
+  Insert(Entry(group, std::move(rule)));
+  return changed;
+}
+
+bool BraveCookieRuleIndex::Remove(
+    size_t group,
+    const ContentSettingsPattern& primary_pattern,
+    const ContentSettingsPattern& secondary_pattern) {
+  auto it =
+      entries_.find(EntryLess::Key{group, primary_pattern, secondary_pattern});
+  if (it == entries_.end())
+    return false;
+  Erase(it);
+  return true;
+}
+
+void BraveCookieRuleIndex::Clear() {
+  by_primary_host_.clear();
+  by_secondary_host_.clear();
+  any_host_.clear();
+  entries_.clear();
+}
+
+std::vector<Rule> BraveCookieRuleIndex::CloneRules() const {
+  std::vector<Rule> rules;
+  rules.reserve(entries_.size());
+  for (const Entry& entry : entries_) {
+    rules.emplace_back(entry.rule.primary_pattern,
+                       entry.rule.secondary_pattern, entry.rule.value.Clone(),
+                       entry.rule.expiration, entry.rule.session_model);
+  }
+  return rules;
+}
+
+void BraveCookieRuleIndex::Insert(Entry entry) {
+  auto it = entries_.insert(std::move(entry)).first;
+  EntrySetFor(it->rule).insert(&*it);
+}
+
+void BraveCookieRuleIndex::Erase(Entries::const_iterator it) {
+  const Rule& rule = it->rule;
+  if (IsHostSpecific(rule.primary_pattern)) {
+    auto host = by_primary_host_.find(
+        TrimTrailingDot(rule.primary_pattern.GetHost()).as_string());
+    host->second.erase(&*it);
+    if (host->second.empty())
+      by_primary_host_.erase(host);
+  } else if (IsHostSpecific(rule.secondary_pattern)) {
+    auto host = by_secondary_host_.find(
+        TrimTrailingDot(rule.secondary_pattern.GetHost()).as_string());
+    host->second.erase(&*it);
+    if (host->second.empty())
+      by_secondary_host_.erase(host);
+  } else {
+    any_host_.erase(&*it);
+  }
+  entries_.erase(it);
+}
+
+BraveCookieRuleIndex::EntrySet& BraveCookieRuleIndex::EntrySetFor(
+    const Rule& rule) {
+  if (IsHostSpecific(rule.primary_pattern)) {
+    return by_primary_host_[TrimTrailingDot(rule.primary_pattern.GetHost())
+                                .as_string()];
+  }
+  if (IsHostSpecific(rule.secondary_pattern)) {
+    return by_secondary_host_[TrimTrailingDot(
+                                  rule.secondary_pattern.GetHost())
+                                  .as_string()];
+  }
+  return any_host_;
+}
+
+// static
+template <typename Visitor>
+void BraveCookieRuleIndex::VisitHost(const HostIndex& index,
+                                     base::StringPiece host,
+                                     Visitor visit) {
+  if (index.empty())
+    return;
+  host = TrimTrailingDot(host);
+  while (!host.empty()) {
+    auto it = index.find(host.as_string());
+    if (it != index.end())
+      visit(it->second);
+    const size_t dot = host.find('.');
+    if (dot == base::StringPiece::npos)
+      break;
+    host.remove_prefix(dot + 1);
+  }
+}
+
+const Rule* BraveCookieRuleIndex::Find(
+    size_t group,
+    const ContentSettingsPattern& primary_pattern,
+    const ContentSettingsPattern& secondary_pattern) const {
+  auto it =
+      entries_.find(EntryLess::Key{group, primary_pattern, secondary_pattern});
+  return it != entries_.end() ? &it->rule : nullptr;
+}
+
+const Rule* BraveCookieRuleIndex::FindFirstMatch(
+    const GURL& primary_url,
+    const GURL& secondary_url) const {
+  const Entry* first = nullptr;
+  auto visit = [&](const EntrySet& entries) {
+    for (const Entry* entry : entries) {
+      if (first && !EntryLess()(entry, first))
+        return;
+      if (entry->rule.primary_pattern.Matches(primary_url) &&
+          entry->rule.secondary_pattern.Matches(secondary_url)) {
+        first = entry;
+        return;
+      }
+    }
+  };
+  // A rule can only match if its primary pattern is for the primary URL's
+  // host or one of its parent domains, or, if its primary pattern matches any
+  // host, the same holds for its secondary pattern and the secondary URL.
+  VisitHost(by_primary_host_, primary_url.host_piece(), visit);
+  VisitHost(by_secondary_host_, secondary_url.host_piece(), visit);
+  visit(any_host_);
+  return first ? &first->rule : nullptr;
+}
+
+const Rule* BraveCookieRuleIndex::FindFirstCovering(
+    const ContentSettingsPattern& primary_pattern) const {
+  const Entry* first = nullptr;
+  auto visit = [&](const EntrySet& entries) {
+    for (const Entry* entry : entries) {
+      if (first && !EntryLess()(entry, first))
+        return;
+      auto relation = entry->rule.primary_pattern.Compare(primary_pattern);
+      if (relation == ContentSettingsPattern::IDENTITY ||
+          relation == ContentSettingsPattern::SUCCESSOR) {
+        first = entry;
+        return;
+      }
+    }
+  };
+  // A pattern tied to a host is only covered by patterns for the same host,
+  // one of its parent domains, or any host.
+  if (IsHostSpecific(primary_pattern))
+    VisitHost(by_primary_host_, primary_pattern.GetHost(), visit);
+  for (const auto& host : by_secondary_host_)
+    visit(host.second);
+  visit(any_host_);
+  return first ? &first->rule : nullptr;
+}
+
+}  // namespace content_settings
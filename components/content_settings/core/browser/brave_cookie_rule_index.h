@@ -0,0 +1,140 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_CONTENT_SETTINGS_CORE_BROWSER_BRAVE_COOKIE_RULE_INDEX_H_
+#define BRAVE_COMPONENTS_CONTENT_SETTINGS_CORE_BROWSER_BRAVE_COOKIE_RULE_INDEX_H_
+
+#include <stddef.h>
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "components/content_settings/core/browser/content_settings_rule.h"
+#include "components/content_settings/core/common/content_settings_pattern.h"
+
+class GURL;
+
+namespace content_settings {
+
+// An ordered set of rules, indexed by the hosts of their patterns, so that
+// cookie access and cookie rule updates only compare the few rules that can
+// apply to a site instead of every rule. Rules are ordered by the |group|
+// they were added to, then, as in a PrefProvider, most specific patterns
+// first, and a group holds at most one rule per pair of patterns. Where
+// several rules apply, the first one in that order wins, as for a
+// RuleIterator. Rules can be changed one at a time; callers synchronize
+// access.
+class BraveCookieRuleIndex {
+ public:
+  BraveCookieRuleIndex();
+  ~BraveCookieRuleIndex();
+
+  // Adds |rule| to |group| unless the group already has a rule with the same
+  // patterns.
+  void Add(size_t group, Rule rule);
+  // Adds |rule| to |group|, replacing any rule with the same patterns there.
+  // Returns whether the group's setting for those patterns changed.
+  bool Set(size_t group, Rule rule);
+  // Removes the rule with these patterns from |group|. Returns whether there
+  // was one.
+  bool Remove(size_t group,
+              const ContentSettingsPattern& primary_pattern,
+              const ContentSettingsPattern& secondary_pattern);
+  void Clear();
+
+  size_t size() const { return entries_.size(); }
+
+  // Calls |visit| with the group of each rule and the rule, in order.
+  template <typename Visitor>
+  void ForEachRule(Visitor visit) const {
+    for (const Entry& entry : entries_)
+      visit(entry.group, entry.rule);
+  }
+
+  // Returns copies of the rules, in order.
+  std::vector<Rule> CloneRules() const;
+
+  // Returns the rule in |group| with exactly these patterns, or nullptr.
+  const Rule* Find(size_t group,
+                   const ContentSettingsPattern& primary_pattern,
+                   const ContentSettingsPattern& secondary_pattern) const;
+
+  // Returns the first rule whose patterns match |primary_url| and
+  // |secondary_url|, or nullptr.
+  const Rule* FindFirstMatch(const GURL& primary_url,
+                             const GURL& secondary_url) const;
+
+  // Returns the first rule whose primary pattern is |primary_pattern| or a
+  // less specific pattern that covers it, or nullptr.
+  const Rule* FindFirstCovering(
+      const ContentSettingsPattern& primary_pattern) const;
+
+ private:
+  struct Entry {
+    Entry(size_t group, Rule rule);
+    Entry(Entry&& other);
+    ~Entry();
+
+    size_t group;
+    Rule rule;
+  };
+
+  // Orders entries by group, then most specific patterns first. Transparent,
+  // so that entries can be looked up by group and patterns.
+  struct EntryLess {
+    using is_transparent = void;
+    struct Key {
+      size_t group;
+      const ContentSettingsPattern& primary_pattern;
+      const ContentSettingsPattern& secondary_pattern;
+    };
+    static Key KeyOf(const Entry& entry);
+    static const Key& KeyOf(const Key& key) { return key; }
+
+    template <typename Lhs, typename Rhs>
+    bool operator()(const Lhs& lhs, const Rhs& rhs) const {
+      return Less(KeyOf(lhs), KeyOf(rhs));
+    }
+    bool operator()(const Entry* lhs, const Entry* rhs) const {
+      return Less(KeyOf(*lhs), KeyOf(*rhs));
+    }
+    static bool Less(const Key& lhs, const Key& rhs);
+  };
+
+  using Entries = std::set<Entry, EntryLess>;
+  // Entries in |entries_|, which keeps them at a stable address.
+  using EntrySet = std::set<const Entry*, EntryLess>;
+  using HostIndex = std::unordered_map<std::string, EntrySet>;
+
+  void Insert(Entry entry);
+  void Erase(Entries::const_iterator it);
+  // Where the entry for |rule| is indexed.
+  EntrySet& EntrySetFor(const Rule& rule);
+
+  // Calls |visit| with the entries keyed by |host| or one of its parent
+  // domains.
+  template <typename Visitor>
+  static void VisitHost(const HostIndex& index,
+                        base::StringPiece host,
+                        Visitor visit);
+
+  Entries entries_;
+  HostIndex by_primary_host_;
+  // Entries whose primary pattern isn't tied to a host, like shields down
+  // rules, by the host of their secondary pattern.
+  HostIndex by_secondary_host_;
+  // Entries whose patterns aren't tied to a host.
+  EntrySet any_host_;
+
+  DISALLOW_COPY_AND_ASSIGN(BraveCookieRuleIndex);
+};
+
+}  // namespace content_settings
+
+#endif  // BRAVE_COMPONENTS_CONTENT_SETTINGS_CORE_BROWSER_BRAVE_COOKIE_RULE_INDEX_H_
@@ -0,0 +1,255 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/content_settings/core/browser/brave_cookie_rule_index.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/timer/elapsed_timer.h"
+#include "components/content_settings/core/common/content_settings.h"
+#include "components/content_settings/core/common/content_settings_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace content_settings {
+
+namespace {
+
+Rule MakeRule(const std::string& primary_pattern,
+              const std::string& secondary_pattern,
+              ContentSetting setting) {
+  return Rule(ContentSettingsPattern::FromString(primary_pattern),
+              ContentSettingsPattern::FromString(secondary_pattern),
+              base::Value::FromUniquePtrValue(ContentSettingToValue(setting)),
+              base::Time(), SessionModel::Durable);
+}
+
+ContentSetting SettingOf(const Rule* rule) {
+  return rule ? ValueToContentSetting(&rule->value) : CONTENT_SETTING_DEFAULT;
+}
+
+// What HostContentSettingsMap does with a RuleIterator over every rule.
+ContentSetting FindFirstMatchLinearly(const std::vector<Rule>& rules,
+                                      const GURL& primary_url,
+                                      const GURL& secondary_url) {
+  for (const auto& rule : rules) {
+    if (rule.primary_pattern.Matches(primary_url) &&
+        rule.secondary_pattern.Matches(secondary_url))
+      return ValueToContentSetting(&rule.value);
+  }
+  return CONTENT_SETTING_DEFAULT;
+}
+
+// What UpdateCookieRules did for each cookie rule before the shields rules
+// were indexed.
+ContentSetting FindFirstCoveringLinearly(
+    const std::vector<Rule>& rules,
+    const ContentSettingsPattern& primary_pattern) {
+  for (const auto& rule : rules) {
+    auto relation = rule.primary_pattern.Compare(primary_pattern);
+    if (relation == ContentSettingsPattern::IDENTITY ||
+        relation == ContentSettingsPattern::SUCCESSOR)
+      return ValueToContentSetting(&rule.value);
+  }
+  return CONTENT_SETTING_DEFAULT;
+}
+
+// Cookie rules as a user with |sites| site exceptions has them: cookie
+// settings for some sites, shields down rules for others and the default
+// rules.
+void AddCookieRules(BraveCookieRuleIndex* index, int sites) {
+  for (int i = 0; i < sites; ++i) {
+    const std::string site = "site" + base::NumberToString(i) + ".com";
+    if (i % 3 == 0) {
+      index->Add(1, MakeRule("https://[*.]" + site + ":443/*", "*",
+                             CONTENT_SETTING_BLOCK));
+    } else if (i % 3 == 1) {
+      index->Add(2, MakeRule("*", "https://[*.]" + site + ":443/*",
+                             CONTENT_SETTING_ALLOW));
+    } else {
+      index->Add(3, MakeRule("*", "[*.]" + site, CONTENT_SETTING_ALLOW));
+    }
+  }
+  index->Add(2, MakeRule("*", "*", CONTENT_SETTING_SESSION_ONLY));
+}
+
+// Cookie accesses, by sites with and without rules, from first and third
+// party contexts.
+std::vector<std::pair<GURL, GURL>> MakeCookieAccesses(int sites) {
+  std::vector<std::pair<GURL, GURL>> urls;
+  for (int i = 0; i < 1000; ++i) {
+    const std::string site = base::NumberToString((i * 7919) % (2 * sites));
+    const std::string top = base::NumberToString((i * 104729) % (2 * sites));
+    urls.emplace_back(GURL("https://www.site" + site + ".com/"),
+                      GURL("https://site" + top + ".com/"));
+  }
+  return urls;
+}
+
+}  // namespace
+
+TEST(BraveCookieRuleIndexTest, EarlierGroupsWin) {
+  BraveCookieRuleIndex index;
+  index.Add(1, MakeRule("a.brave.com", "*", CONTENT_SETTING_ALLOW));
+  index.Add(0, MakeRule("[*.]brave.com", "*", CONTENT_SETTING_BLOCK));
+  index.Add(2, MakeRule("*", "*", CONTENT_SETTING_SESSION_ONLY));
+
+  EXPECT_EQ(CONTENT_SETTING_BLOCK,
+            SettingOf(index.FindFirstMatch(GURL("https://a.brave.com"),
+                                           GURL("https://a.brave.com"))));
+  EXPECT_EQ(CONTENT_SETTING_SESSION_ONLY,
+            SettingOf(index.FindFirstMatch(GURL("https://example.com"),
+                                           GURL("https://example.com"))));
+}
+
+TEST(BraveCookieRuleIndexTest, MoreSpecificPatternsWinWithinAGroup) {
+  BraveCookieRuleIndex index;
+  index.Add(0, MakeRule("[*.]brave.com", "*", CONTENT_SETTING_BLOCK));
+  index.Add(0, MakeRule("a.brave.com", "*", CONTENT_SETTING_ALLOW));
+
+  EXPECT_EQ(CONTENT_SETTING_ALLOW,
+            SettingOf(index.FindFirstMatch(GURL("https://a.brave.com"),
+                                           GURL("https://a.brave.com"))));
+  EXPECT_EQ(CONTENT_SETTING_BLOCK,
+            SettingOf(index.FindFirstMatch(GURL("https://b.brave.com"),
+                                           GURL("https://b.brave.com"))));
+}
+
+TEST(BraveCookieRuleIndexTest, FindFirstMatch) {
+  BraveCookieRuleIndex index;
+  index.Add(0, MakeRule("[*.]brave.com", "[*.]example.com",
+                        CONTENT_SETTING_BLOCK));
+  // A shields down rule.
+  index.Add(1, MakeRule("*", "[*.]example.com", CONTENT_SETTING_ALLOW));
+  index.Add(1, MakeRule("*", "*", CONTENT_SETTING_SESSION_ONLY));
+
+  EXPECT_EQ(CONTENT_SETTING_BLOCK,
+            SettingOf(index.FindFirstMatch(GURL("https://a.brave.com"),
+                                           GURL("https://example.com"))));
+  EXPECT_EQ(CONTENT_SETTING_ALLOW,
+            SettingOf(index.FindFirstMatch(GURL("https://a.brave.com"),
+                                           GURL("https://a.example.com"))));
+  EXPECT_EQ(CONTENT_SETTING_SESSION_ONLY,
+            SettingOf(index.FindFirstMatch(GURL("https://a.brave.com"),
+                                           GURL("https://brave.com"))));
+}
+
+TEST(BraveCookieRuleIndexTest, FindFirstCovering) {
+  BraveCookieRuleIndex index;
+  index.Add(0, MakeRule("[*.]sub.brave.com", "*", CONTENT_SETTING_ALLOW));
+  index.Add(0, MakeRule("[*.]brave.com", "*", CONTENT_SETTING_BLOCK));
+
+  EXPECT_EQ(CONTENT_SETTING_BLOCK,
+            SettingOf(index.FindFirstCovering(
+                ContentSettingsPattern::FromString("[*.]brave.com"))));
+  EXPECT_EQ(CONTENT_SETTING_ALLOW,
+            SettingOf(index.FindFirstCovering(
+                ContentSettingsPattern::FromString("a.sub.brave.com"))));
+  EXPECT_EQ(nullptr, index.FindFirstCovering(
+                         ContentSettingsPattern::FromString("example.com")));
+  EXPECT_EQ(nullptr, index.FindFirstCovering(
+                         ContentSettingsPattern::Wildcard()));
+}
+
+TEST(BraveCookieRuleIndexTest, AddKeepsTheFirstRule) {
+  BraveCookieRuleIndex index;
+  index.Add(0, MakeRule("[*.]brave.com", "*", CONTENT_SETTING_ALLOW));
+  index.Add(0, MakeRule("[*.]brave.com", "*", CONTENT_SETTING_BLOCK));
+  index.Add(1, MakeRule("[*.]brave.com", "*", CONTENT_SETTING_BLOCK));
+
+  EXPECT_EQ(2u, index.size());
+  EXPECT_EQ(CONTENT_SETTING_ALLOW,
+            SettingOf(index.Find(
+                0, ContentSettingsPattern::FromString("[*.]brave.com"),
+                ContentSettingsPattern::Wildcard())));
+  EXPECT_EQ(CONTENT_SETTING_BLOCK,
+            SettingOf(index.Find(
+                1, ContentSettingsPattern::FromString("[*.]brave.com"),
+                ContentSettingsPattern::Wildcard())));
+  EXPECT_EQ(nullptr, index.Find(0, ContentSettingsPattern::Wildcard(),
+                                ContentSettingsPattern::Wildcard()));
+}
+
+TEST(BraveCookieRuleIndexTest, SetAndRemove) {
+  BraveCookieRuleIndex index;
+  const auto brave = ContentSettingsPattern::FromString("[*.]brave.com");
+  const auto any = ContentSettingsPattern::Wildcard();
+
+  EXPECT_TRUE(index.Set(0, MakeRule("[*.]brave.com", "*",
+                                    CONTENT_SETTING_ALLOW)));
+  EXPECT_FALSE(index.Set(0, MakeRule("[*.]brave.com", "*",
+                                     CONTENT_SETTING_ALLOW)));
+  EXPECT_TRUE(index.Set(0, MakeRule("[*.]brave.com", "*",
+                                    CONTENT_SETTING_BLOCK)));
+  EXPECT_EQ(1u, index.size());
+  EXPECT_EQ(CONTENT_SETTING_BLOCK,
+            SettingOf(index.FindFirstMatch(GURL("https://brave.com"),
+                                           GURL("https://brave.com"))));
+
+  EXPECT_FALSE(index.Remove(1, brave, any));
+  EXPECT_TRUE(index.Remove(0, brave, any));
+  EXPECT_FALSE(index.Remove(0, brave, any));
+  EXPECT_EQ(0u, index.size());
+  EXPECT_EQ(nullptr, index.FindFirstMatch(GURL("https://brave.com"),
+                                          GURL("https://brave.com")));
+}
+
+// Finding the rule for each cookie access, and the shields rule covering each
+// cookie rule, through the index gives the same results as walking the rules
+// in order.
+TEST(BraveCookieRuleIndexTest, FindsAsWalkingTheRules) {
+  BraveCookieRuleIndex index;
+  AddCookieRules(&index, 300);
+  const std::vector<Rule> rules = index.CloneRules();
+
+  for (const auto& urls : MakeCookieAccesses(300)) {
+    EXPECT_EQ(FindFirstMatchLinearly(rules, urls.first, urls.second),
+              SettingOf(index.FindFirstMatch(urls.first, urls.second)))
+        << urls.first << " " << urls.second;
+    const auto pattern = ContentSettingsPattern::FromURL(urls.first);
+    EXPECT_EQ(FindFirstCoveringLinearly(rules, pattern),
+              SettingOf(index.FindFirstCovering(pattern)))
+        << pattern.ToString();
+  }
+}
+
+// Compares looking up the rule for a cookie access through the index against
+// walking every rule in order, as HostContentSettingsMap did, at 10, 1,000
+// and 10,000 sites with rules. Disabled as it only measures; run with
+// --gtest_also_run_disabled_tests --v=1 to see the timings.
+TEST(BraveCookieRuleIndexTest, DISABLED_CookieAccessBenchmark) {
+  for (int sites : {10, 1000, 10000}) {
+    BraveCookieRuleIndex index;
+    AddCookieRules(&index, sites);
+    const std::vector<Rule> rules = index.CloneRules();
+    const auto cookie_accesses = MakeCookieAccesses(sites);
+
+    std::vector<ContentSetting> expected;
+    base::ElapsedTimer linear_timer;
+    for (const auto& urls : cookie_accesses) {
+      expected.push_back(
+          FindFirstMatchLinearly(rules, urls.first, urls.second));
+    }
+    const base::TimeDelta linear_time = linear_timer.Elapsed();
+
+    std::vector<ContentSetting> actual;
+    base::ElapsedTimer index_timer;
+    for (const auto& urls : cookie_accesses)
+      actual.push_back(SettingOf(index.FindFirstMatch(urls.first,
+                                                      urls.second)));
+    const base::TimeDelta index_time = index_timer.Elapsed();
+
+    EXPECT_EQ(expected, actual) << sites << " sites";
+    VLOG(1) << index.size() << " cookie rules, " << cookie_accesses.size()
+            << " cookie accesses: linear " << linear_time.InMicroseconds()
+            << "us, indexed " << index_time.InMicroseconds() << "us";
+  }
+}
+
+}  // namespace content_settings
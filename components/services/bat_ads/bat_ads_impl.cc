@@ -94,6 +94,10 @@ void BatAdsImpl::OnBackground() {
   ads_->OnBackground();
 }
 
+void BatAdsImpl::Flush() {
+  ads_->Flush();
+}
+
 void BatAdsImpl::OnMediaPlaying(
     const int32_t tab_id) {
   ads_->OnMediaPlaying(tab_id);
@@ -58,6 +58,7 @@ class BatAdsImpl :
 
   void OnForeground() override;
   void OnBackground() override;
+  void Flush() override;
 
   void OnMediaPlaying(
       const int32_t tab_id) override;
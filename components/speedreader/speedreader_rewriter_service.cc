@@ -11,6 +11,7 @@
 #include "base/files/file_util.h"
 #include "base/logging.h"
 #include "base/task/post_task.h"
+#include "brave/components/brave_component_updater/browser/dat_file_util.h"
 #include "brave/components/speedreader/rust/ffi/speedreader.h"
 #include "brave/components/speedreader/speedreader_component.h"
 #include "components/grit/brave_components_resources.h"
@@ -69,7 +70,8 @@ void SpeedreaderRewriterService::OnWhitelistReady(const base::FilePath& path) {
   base::PostTaskAndReplyWithResult(
       FROM_HERE, {base::ThreadPool(), base::MayBlock()},
       base::BindOnce(
-          &brave_component_updater::LoadDATFileData<speedreader::SpeedReader>,
+          &brave_component_updater::LoadMappedDATFileData<
+              speedreader::SpeedReader>,
           path),
       base::BindOnce(&SpeedreaderRewriterService::OnLoadDATFileData,
                      weak_factory_.GetWeakPtr()));
@@ -102,10 +104,10 @@ void SpeedreaderRewriterService::OnLoadStylesheet(std::string stylesheet) {
 }
 
 void SpeedreaderRewriterService::OnLoadDATFileData(
-    GetDATFileDataResult result) {
+    std::unique_ptr<speedreader::SpeedReader> speedreader) {
   VLOG(2) << "Speedreader loaded from DAT file";
-  if (result.first)
-    speedreader_ = std::move(result.first);
+  if (speedreader)
+    speedreader_ = std::move(speedreader);
 }
 
 }  // namespace speedreader
@@ -11,7 +11,6 @@
 
 #include "base/memory/weak_ptr.h"
 #include "brave/components/brave_component_updater/browser/brave_component.h"
-#include "brave/components/brave_component_updater/browser/dat_file_util.h"
 #include "brave/components/speedreader/speedreader_component.h"
 
 namespace base {
@@ -47,10 +46,7 @@ class SpeedreaderRewriterService : public SpeedreaderComponent::Observer {
   const std::string& GetContentStylesheet();
 
  private:
-  using GetDATFileDataResult =
-      brave_component_updater::LoadDATFileDataResult<speedreader::SpeedReader>;
-
-  void OnLoadDATFileData(GetDATFileDataResult result);
+  void OnLoadDATFileData(std::unique_ptr<speedreader::SpeedReader> speedreader);
   void OnLoadStylesheet(std::string stylesheet);
 
   std::string content_stylesheet_;
@@ -0,0 +1,157 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/test/base/scoped_allocation_counter.h"
+
+#if BUILDFLAG(USE_ALLOCATOR_SHIM)
+
+#include <atomic>
+
+#include "base/allocator/allocator_shim.h"
+#include "base/threading/platform_thread.h"
+
+namespace {
+
+using base::allocator::AllocatorDispatch;
+
+std::atomic<bool> g_counting{false};
+base::PlatformThreadId g_counting_thread;
+size_t g_allocations = 0;
+
+void CountAllocation() {
+  if (g_counting.load(std::memory_order_relaxed) &&
+      base::PlatformThread::CurrentId() == g_counting_thread) {
+    ++g_allocations;
+  }
+}
+
+void* CountingAlloc(const AllocatorDispatch* self,
+                    size_t size,
+                    void* context) {
+  CountAllocation();
+  return self->next->alloc_function(self->next, size, context);
+}
+
+void* CountingAllocZeroInitialized(const AllocatorDispatch* self,
+                                   size_t n,
+                                   size_t size,
+                                   void* context) {
+  CountAllocation();
+  return self->next->alloc_zero_initialized_function(self->next, n, size,
+                                                     context);
+}
+
+void* CountingAllocAligned(const AllocatorDispatch* self,
+                           size_t alignment,
+                           size_t size,
+                           void* context) {
+  CountAllocation();
+  return self->next->alloc_aligned_function(self->next, alignment, size,
+                                            context);
+}
+
+void* CountingRealloc(const AllocatorDispatch* self,
+                      void* address,
+                      size_t size,
+                      void* context) {
+  CountAllocation();
+  return self->next->realloc_function(self->next, address, size, context);
+}
+
+void CountingFree(const AllocatorDispatch* self,
+                  void* address,
+                  void* context) {
+  self->next->free_function(self->next, address, context);
+}
+
+size_t CountingGetSizeEstimate(const AllocatorDispatch* self,
+                               void* address,
+                               void* context) {
+  return self->next->get_size_estimate_function(self->next, address, context);
+}
+
+unsigned CountingBatchMalloc(const AllocatorDispatch* self,
+                             size_t size,
+                             void** results,
+                             unsigned num_requested,
+                             void* context) {
+  CountAllocation();
+  return self->next->batch_malloc_function(self->next, size, results,
+                                           num_requested, context);
+}
+
+void CountingBatchFree(const AllocatorDispatch* self,
+                       void** to_be_freed,
+                       unsigned num_to_be_freed,
+                       void* context) {
+  self->next->batch_free_function(self->next, to_be_freed, num_to_be_freed,
+                                  context);
+}
+
+void CountingFreeDefiniteSize(const AllocatorDispatch* self,
+                              void* address,
+                              size_t size,
+                              void* context) {
+  self->next->free_definite_size_function(self->next, address, size, context);
+}
+
+void* CountingAlignedMalloc(const AllocatorDispatch* self,
+                            size_t size,
+                            size_t alignment,
+                            void* context) {
+  CountAllocation();
+  return self->next->aligned_malloc_function(self->next, size, alignment,
+                                             context);
+}
+
+void* CountingAlignedRealloc(const AllocatorDispatch* self,
+                             void* address,
+                             size_t size,
+                             size_t alignment,
+                             void* context) {
+  CountAllocation();
+  return self->next->aligned_realloc_function(self->next, address, size,
+                                              alignment, context);
+}
+
+void CountingAlignedFree(const AllocatorDispatch* self,
+                         void* address,
+                         void* context) {
+  self->next->aligned_free_function(self->next, address, context);
+}
+
+AllocatorDispatch g_counting_dispatch = {&CountingAlloc,
+                                         &CountingAllocZeroInitialized,
+                                         &CountingAllocAligned,
+                                         &CountingRealloc,
+                                         &CountingFree,
+                                         &CountingGetSizeEstimate,
+                                         &CountingBatchMalloc,
+                                         &CountingBatchFree,
+                                         &CountingFreeDefiniteSize,
+                                         &CountingAlignedMalloc,
+                                         &CountingAlignedRealloc,
+                                         &CountingAlignedFree,
+                                         nullptr};
+
+}  // namespace
+
+ScopedAllocationCounter::ScopedAllocationCounter() {
+  base::allocator::InsertAllocatorDispatch(&g_counting_dispatch);
+  g_counting_thread = base::PlatformThread::CurrentId();
+  g_allocations = 0;
+  g_counting = true;
+}
+
+ScopedAllocationCounter::~ScopedAllocationCounter() {
+  g_counting = false;
+  base::allocator::RemoveAllocatorDispatchForTesting(&g_counting_dispatch);
+}
+
+size_t ScopedAllocationCounter::count() const {
+  return g_allocations;
+}
+
+#endif  // BUILDFLAG(USE_ALLOCATOR_SHIM)
@@ -0,0 +1,31 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_TEST_BASE_SCOPED_ALLOCATION_COUNTER_H_
+#define BRAVE_TEST_BASE_SCOPED_ALLOCATION_COUNTER_H_
+
+#include <stddef.h>
+
+#include "base/allocator/buildflags.h"
+#include "base/macros.h"
+
+#if BUILDFLAG(USE_ALLOCATOR_SHIM)
+
+// Counts the heap allocations made by the current thread while in scope.
+// Only one counter may be alive at a time.
+class ScopedAllocationCounter {
+ public:
+  ScopedAllocationCounter();
+  ~ScopedAllocationCounter();
+
+  size_t count() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ScopedAllocationCounter);
+};
+
+#endif  // BUILDFLAG(USE_ALLOCATOR_SHIM)
+
+#endif  // BRAVE_TEST_BASE_SCOPED_ALLOCATION_COUNTER_H_